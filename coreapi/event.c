@@ -330,17 +330,31 @@ LinphoneStatus linphone_event_deny_subscription(LinphoneEvent *lev, LinphoneReas
 	return err;
 }
 
-LinphoneStatus linphone_event_notify(LinphoneEvent *lev, const LinphoneContent *body){
-	SalBodyHandler *body_handler;
+static bool_t linphone_event_can_notify(const LinphoneEvent *lev){
 	if (lev->subscription_state!=LinphoneSubscriptionActive && lev->subscription_state!=LinphoneSubscriptionIncomingReceived){
 		ms_error("linphone_event_notify(): cannot notify if subscription is not active.");
-		return -1;
+		return FALSE;
 	}
 	if (lev->dir!=LinphoneSubscriptionIncoming){
 		ms_error("linphone_event_notify(): cannot notify if not an incoming subscription.");
+		return FALSE;
+	}
+	return TRUE;
+}
+
+LinphoneStatus linphone_event_notify(LinphoneEvent *lev, const LinphoneContent *body){
+	if (!linphone_event_can_notify(lev)) return -1;
+	SalBodyHandler *body_handler = sal_body_handler_from_content(body, false);
+	auto subscribeOp = dynamic_cast<SalSubscribeOp *>(lev->op);
+	return subscribeOp->notify(body_handler);
+}
+
+LinphoneStatus _linphone_event_notify_with_body_handler(LinphoneEvent *lev, SalBodyHandler *body_handler){
+	if (!linphone_event_can_notify(lev)) {
+		/* The handler is not owned by any message yet. */
+		if (body_handler) sal_body_handler_unref(body_handler);
 		return -1;
 	}
-	body_handler = sal_body_handler_from_content(body, false);
 	auto subscribeOp = dynamic_cast<SalSubscribeOp *>(lev->op);
 	return subscribeOp->notify(body_handler);
 }
@@ -122,6 +122,11 @@ static int friend_compare(const void * a, const void * b) {
 	return ret;
 }
 
+static void linphone_friend_invalidate_search_index(const LinphoneFriend *lf) {
+	if (lf->friend_list)
+		linphone_friend_list_invalidate_friend_search_index(lf->friend_list, lf);
+}
+
 static LinphoneFriendPresence * find_presence_model_for_uri_or_tel(const LinphoneFriend *lf, const char *uri_or_tel) {
 	bctbx_list_t *iterator = NULL;
 	LinphoneAddress *uri_or_tel_addr = NULL;
@@ -388,6 +393,7 @@ LinphoneStatus linphone_friend_set_address(LinphoneFriend *lf, const LinphoneAdd
 		if (lf->uri != NULL) linphone_address_unref(lf->uri);
 		lf->uri = fr;
 	}
+	linphone_friend_invalidate_search_index(lf);
 
 	ms_free(address);
 	return 0;
@@ -415,6 +421,7 @@ void linphone_friend_add_address(LinphoneFriend *lf, const LinphoneAddress *addr
 		if (lf->uri == NULL) lf->uri = fr;
 		else linphone_address_unref(fr);
 	}
+	linphone_friend_invalidate_search_index(lf);
 	ms_free(uri);
 }
 
@@ -442,6 +449,7 @@ void linphone_friend_remove_address(LinphoneFriend *lf, const LinphoneAddress *a
 	if (linphone_core_vcard_supported()) {
 		linphone_vcard_remove_sip_address(lf->vcard, address);
 	}
+	linphone_friend_invalidate_search_index(lf);
 	ms_free(address);
 }
 
@@ -459,6 +467,7 @@ void linphone_friend_add_phone_number(LinphoneFriend *lf, const char *phone) {
 		}
 		linphone_vcard_add_phone_number(lf->vcard, phone);
 	}
+	linphone_friend_invalidate_search_index(lf);
 }
 
 void linphone_friend_add_phone_number_with_label(LinphoneFriend *lf, LinphoneFriendPhoneNumber *phoneNumber) {
@@ -478,6 +487,7 @@ void linphone_friend_add_phone_number_with_label(LinphoneFriend *lf, LinphoneFri
 		}
 		linphone_vcard_add_phone_number_with_label(lf->vcard, phoneNumber);
 	}
+	linphone_friend_invalidate_search_index(lf);
 }
 
 bctbx_list_t* linphone_friend_get_phone_numbers(const LinphoneFriend *lf) {
@@ -551,6 +561,7 @@ void linphone_friend_remove_phone_number(LinphoneFriend *lf, const char *phone)
 	if (linphone_core_vcard_supported()) {
 		linphone_vcard_remove_phone_number(lf->vcard, phone);
 	}
+	linphone_friend_invalidate_search_index(lf);
 }
 
 void linphone_friend_remove_phone_number_with_label(LinphoneFriend *lf, const LinphoneFriendPhoneNumber *phoneNumber) {
@@ -569,6 +580,7 @@ void linphone_friend_remove_phone_number_with_label(LinphoneFriend *lf, const Li
 	if (linphone_core_vcard_supported()) {
 		linphone_vcard_remove_phone_number_with_label(lf->vcard, phoneNumber);
 	}
+	linphone_friend_invalidate_search_index(lf);
 }
 
 LinphoneStatus linphone_friend_set_name(LinphoneFriend *lf, const char *name) {
@@ -582,6 +594,7 @@ LinphoneStatus linphone_friend_set_name(LinphoneFriend *lf, const char *name) {
 		}
 		linphone_address_set_display_name(lf->uri, name);
 	}
+	linphone_friend_invalidate_search_index(lf);
 	return 0;
 }
 
@@ -611,6 +624,17 @@ void linphone_friend_notify(LinphoneFriend *lf, LinphonePresenceModel *presence)
 	}
 }
 
+int linphone_friend_notify_with_payload(LinphoneFriend *lf, LinphonePresenceModel *presence, std::shared_ptr<const LinphonePrivate::NotifyPayload> &payload, bool_t deflate){
+	bctbx_list_t *elem;
+	int count = 0;
+	for(elem=lf->insubs; elem!=NULL; elem=bctbx_list_next(elem)){
+		auto op = static_cast<SalPresenceOp *>(bctbx_list_get_data(elem));
+		if (op->notifyPresence((SalPresenceModel *)presence, payload, !!deflate) == 0)
+			count++;
+	}
+	return count;
+}
+
 void linphone_friend_add_incoming_subscription(LinphoneFriend *lf, SalOp *op){
 	/*ownership of the op is transfered from sal to the LinphoneFriend*/
 	lf->insubs = bctbx_list_append(lf->insubs, op);
@@ -872,6 +896,7 @@ void linphone_friend_set_presence_model_for_uri_or_tel(LinphoneFriend *lf, const
 	} else {
 		add_presence_model_for_uri_or_tel(lf, uri_or_tel, presence);
 	}
+	linphone_friend_invalidate_search_index(lf);
 }
 
 bool_t linphone_friend_is_presence_received(const LinphoneFriend *lf) {
@@ -982,6 +1007,7 @@ void linphone_friend_done(LinphoneFriend *fr) {
 			}
 		}
 	}
+	linphone_friend_invalidate_search_index(fr);
 	linphone_friend_apply(fr, fr->lc);
 	linphone_friend_save(fr, fr->lc);
 }
@@ -1281,6 +1307,7 @@ void linphone_friend_set_vcard(LinphoneFriend *fr, LinphoneVcard *vcard) {
 
 	if (fr->vcard) linphone_vcard_unref(fr->vcard);
 	if (vcard) fr->vcard = linphone_vcard_ref(vcard);
+	linphone_friend_invalidate_search_index(fr);
 	linphone_friend_save(fr, fr->lc);
 }
 
@@ -1469,6 +1496,7 @@ void linphone_core_friends_storage_init(LinphoneCore *lc) {
 		sqlite3_close(db);
 		_linphone_sqlite3_open(lc->friends_db_file, &db);
 	}
+	_linphone_sqlite3_set_options(linphone_core_get_config(lc), db);
 
 	lc->friends_db = db;
 
@@ -1946,6 +1974,7 @@ const char * linphone_friend_sip_uri_to_phone_number(LinphoneFriend *lf, const c
 
 void linphone_friend_clear_presence_models(LinphoneFriend *lf) {
 	lf->presence_models = bctbx_list_free_with_data(lf->presence_models, (bctbx_list_free_func)free_friend_presence);
+	linphone_friend_invalidate_search_index(lf);
 }
 
 int linphone_friend_get_capabilities(const LinphoneFriend *lf) {
@@ -23,6 +23,8 @@
 #include "linphone/core.h"
 
 #include "c-wrapper/c-wrapper.h"
+#include "sal/notify-payload.h"
+#include "search/magic-search-index.h"
 
 // TODO: From coreapi. Remove me later.
 #include "private.h"
@@ -524,6 +526,7 @@ static void linphone_friend_list_destroy(LinphoneFriendList *list) {
 		bctbx_mmap_cchar_delete_with_data(list->friends_map, (void (*)(void *))linphone_friend_unref);
 	if (list->friends_map_uri)
 		bctbx_mmap_cchar_delete_with_data(list->friends_map_uri, (void (*)(void *))linphone_friend_unref);
+	linphone_friend_list_delete_search_index(list);
 }
 
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(LinphoneFriendList);
@@ -566,6 +569,7 @@ void _linphone_friend_list_release(LinphoneFriendList *list) {
 	if (list->friends) {
 		list->friends = bctbx_list_free_with_data(list->friends, (void (*)(void *))_linphone_friend_release);
 	}
+	linphone_friend_list_delete_search_index(list);
 	linphone_friend_list_unref(list);
 }
 
@@ -720,6 +724,24 @@ void linphone_friend_list_invalidate_friends_maps(LinphoneFriendList *list) {
 	}
 }
 
+LinphonePrivate::MagicSearchIndex *linphone_friend_list_get_search_index(LinphoneFriendList *list) {
+	if (!list->search_index)
+		list->search_index = LinphonePrivate::MagicSearchIndex::create(list);
+	return list->search_index;
+}
+
+void linphone_friend_list_invalidate_friend_search_index(LinphoneFriendList *list, const LinphoneFriend *lf) {
+	if (list->search_index)
+		list->search_index->invalidateFriend(lf);
+}
+
+void linphone_friend_list_delete_search_index(LinphoneFriendList *list) {
+	if (list->search_index) {
+		delete list->search_index;
+		list->search_index = NULL;
+	}
+}
+
 LinphoneFriendListStatus linphone_friend_list_import_friend(LinphoneFriendList *list, LinphoneFriend *lf,
 															bool_t synchronize) {
 	if (lf->friend_list) {
@@ -731,6 +753,8 @@ LinphoneFriendListStatus linphone_friend_list_import_friend(LinphoneFriendList *
 	lf->lc = list->lc;
 	list->friends = bctbx_list_prepend(list->friends, linphone_friend_ref(lf));
 	linphone_friend_add_addresses_and_numbers_into_maps(lf, list);
+	if (list->search_index)
+		list->search_index->addFriend(lf);
 
 	if (synchronize) {
 		list->dirty_friends_to_update = bctbx_list_prepend(list->dirty_friends_to_update, linphone_friend_ref(lf));
@@ -777,6 +801,8 @@ static LinphoneFriendListStatus _linphone_friend_list_remove_friend(LinphoneFrie
 		}
 	}
 	list->friends = bctbx_list_erase_link(list->friends, elem);
+	if (list->search_index)
+		list->search_index->removeFriend(lf);
 	if (lf->refkey) {
 		bctbx_iterator_t *it = bctbx_map_cchar_find_key(list->friends_map, lf->refkey);
 		bctbx_iterator_t *end = bctbx_map_cchar_end(list->friends_map);
@@ -897,6 +923,10 @@ static void carddav_updated(LinphoneCardDavContext *cdc, LinphoneFriend *lf_new,
 		bctbx_list_t *elem = bctbx_list_find(list->friends, lf_old);
 		if (elem) {
 			elem->data = linphone_friend_ref(lf_new);
+			if (list->search_index) {
+				list->search_index->removeFriend(lf_old);
+				list->search_index->addFriend(lf_new);
+			}
 		}
 		linphone_core_store_friend_in_db(lf_new->lc, lf_new);
 
@@ -1323,10 +1353,25 @@ void linphone_friend_list_invalidate_subscriptions(LinphoneFriendList *list) {
 
 void linphone_friend_list_notify_presence(LinphoneFriendList *list, LinphonePresenceModel *presence) {
 	const bctbx_list_t *elem;
+	/* The model is serialized once, and the body is shared by the NOTIFYs sent to all the watchers. */
+	std::shared_ptr<const LinphonePrivate::NotifyPayload> payload;
+	bool_t deflate = list->lc
+		&& linphone_config_get_int(list->lc->config, "sip", "presence_notify_deflate", 0)
+		&& linphone_core_content_encoding_supported(list->lc, "deflate");
+	int count = 0;
 	for (elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
 		LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_get_data(elem);
-		linphone_friend_notify(lf, presence);
+		count += linphone_friend_notify_with_payload(lf, presence, payload, deflate);
 	}
+	list->presence_notify_count = count;
+	if (payload) {
+		ms_message("Presence notified to %d watchers of friend list [%p] with a body of %zu bytes, encoded to %zu bytes",
+			count, list, payload->getBodySize(), payload->getEncodedSize());
+	}
+}
+
+int linphone_friend_list_get_presence_notify_count(const LinphoneFriendList *list) {
+	return list->presence_notify_count;
 }
 
 void linphone_friend_list_notify_presence_received(LinphoneFriendList *list, LinphoneEvent *lev,
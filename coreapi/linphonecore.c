@@ -39,6 +39,7 @@
 #include "../src/chat/modifier/file-transfer-chat-message-modifier.h"
 #include "../src/content/file-transfer-content.h"
 
+#include <ctype.h>
 #include <math.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -81,6 +82,7 @@
 
 // For migration purpose.
 #include "address/address.h"
+#include "address/identity-address-parser.h"
 #include "c-wrapper/c-wrapper.h"
 #include "utils/payload-type-handler.h"
 
@@ -650,6 +652,10 @@ void _linphone_core_set_log_handler(OrtpLogFunc logfunc) {
 	}
 }
 
+OrtpLogFunc _linphone_core_get_log_handler(void) {
+	return liblinphone_user_log_func;
+}
+
 void linphone_core_set_log_handler(OrtpLogFunc logfunc){
 	_linphone_core_set_log_handler(logfunc);
 }
@@ -2361,6 +2367,13 @@ static void misc_config_read (LinphoneCore *lc) {
 
 	lc->send_call_stats_periodical_updates = !!linphone_config_get_int(config, "misc", "send_call_stats_periodical_updates", 0);
 
+	_linphone_config_set_sync_policy(config, linphone_config_get_int(config, "misc", "config_sync_delay", 1000),
+		!!linphone_config_get_int(config, "misc", "config_fsync", 0));
+
+	/* The parser is shared by all the cores of the process. */
+	LinphonePrivate::IdentityAddressParser::getInstance()->setCacheCapacity(linphone_config_get_int(config, "misc", "identity_address_cache_size",
+		LinphonePrivate::IdentityAddressParser::DefaultCacheCapacity));
+
 	const char *contacts_vcard_list_uri = linphone_config_get_string(lc->config, "misc", "contacts-vcard-list", NULL);
 	if (contacts_vcard_list_uri) {
 		lc->base_contacts_list_for_synchronization = linphone_core_get_friend_list_by_name(lc, contacts_vcard_list_uri);
@@ -4140,11 +4153,13 @@ void linphone_core_iterate(LinphoneCore *lc){
 		linphone_core_send_initial_subscribes(lc);
 	}
 
+	/* Changes are coalesced and written once the config is left untouched for [misc] config_sync_delay ms. */
+	if (_linphone_config_sync_due(lc->config)) {
+		linphone_core_config_sync(lc);
+	}
+
 	if (one_second_elapsed) {
 		bctbx_list_t *elem = NULL;
-		if (linphone_config_needs_commit(lc->config)) {
-			linphone_core_config_sync(lc);
-		}
 		for (elem = lc->friends_lists; elem != NULL; elem = bctbx_list_next(elem)) {
 			LinphoneFriendList *list = (LinphoneFriendList *)elem->data;
 			if (list->dirty_friends_to_update
@@ -7597,6 +7612,8 @@ void linphone_core_refresh_registers(LinphoneCore* lc) {
 }
 
 void linphone_core_set_network_reachable_internal(LinphoneCore *lc, bool_t is_reachable) {
+	/*the network interfaces may have changed, even if the reachability didn't*/
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->getIfAddrsCache().invalidate();
 	if (lc->auto_net_state_mon) {
 		set_sip_network_reachable(lc, lc->sip_network_state.user_state && is_reachable, ms_time(NULL));
 		set_media_network_reachable(lc, lc->media_network_state.user_state && is_reachable);
@@ -7609,6 +7626,7 @@ void linphone_core_set_network_reachable(LinphoneCore *lc, bool_t is_reachable)
 
 	lc->sip_network_state.user_state = is_reachable;
 	lc->media_network_state.user_state = is_reachable;
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->getIfAddrsCache().invalidate();
 
 	if (lc->auto_net_state_mon) reachable = reachable && getPlatformHelpers(lc)->isNetworkReachable();
 
@@ -7870,6 +7888,62 @@ int _linphone_sqlite3_open(const char *db_file, sqlite3 **db) {
 	return ret;
 }
 
+/*
+ * Values of the [storage] settings are inserted in the PRAGMA requests, only keywords and numbers are accepted.
+ */
+bool_t _linphone_sqlite3_is_pragma_value(const char *value) {
+	const char *c;
+	if (!value || !*value) return FALSE;
+	for (c = value; *c; c++) {
+		if (!isalnum((unsigned char)*c)) return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * Applies the journal_mode, synchronous and cache_size settings of the [storage] section to a database.
+ * Unset settings keep the sqlite3 defaults.
+ * journal_mode must be set outside of any transaction, and wal only works with a VFS supporting shared memory.
+ */
+void _linphone_sqlite3_set_options(LinphoneConfig *config, sqlite3 *db) {
+	const char *journal_mode = linphone_config_get_string(config, "storage", "journal_mode", NULL);
+	const char *synchronous = linphone_config_get_string(config, "storage", "synchronous", NULL);
+	int cache_size = linphone_config_get_int(config, "storage", "cache_size", 0);
+	char *errmsg = NULL;
+	char *request;
+
+	if (journal_mode) {
+		if (_linphone_sqlite3_is_pragma_value(journal_mode)) {
+			request = bctbx_strdup_printf("PRAGMA journal_mode=%s", journal_mode);
+			if (sqlite3_exec(db, request, NULL, NULL, &errmsg) != SQLITE_OK) {
+				ms_error("Cannot set sqlite3 journal mode to %s: %s.", journal_mode, errmsg);
+				sqlite3_free(errmsg);
+				errmsg = NULL;
+			}
+			bctbx_free(request);
+		} else ms_error("Invalid sqlite3 journal mode: %s.", journal_mode);
+	}
+	if (synchronous) {
+		if (_linphone_sqlite3_is_pragma_value(synchronous)) {
+			request = bctbx_strdup_printf("PRAGMA synchronous=%s", synchronous);
+			if (sqlite3_exec(db, request, NULL, NULL, &errmsg) != SQLITE_OK) {
+				ms_error("Cannot set sqlite3 synchronous level to %s: %s.", synchronous, errmsg);
+				sqlite3_free(errmsg);
+				errmsg = NULL;
+			}
+			bctbx_free(request);
+		} else ms_error("Invalid sqlite3 synchronous level: %s.", synchronous);
+	}
+	if (cache_size != 0) {
+		request = bctbx_strdup_printf("PRAGMA cache_size=%d", cache_size);
+		if (sqlite3_exec(db, request, NULL, NULL, &errmsg) != SQLITE_OK) {
+			ms_error("Cannot set sqlite3 cache size to %d: %s.", cache_size, errmsg);
+			sqlite3_free(errmsg);
+		}
+		bctbx_free(request);
+	}
+}
+
 // =============================================================================
 //migration code remove in april 2019, 2 years after switching from xml based zrtp cache to sqlite
 void linphone_core_set_zrtp_secrets_file(LinphoneCore *lc, const char* file){
@@ -27,8 +27,11 @@
 #include "linphone/logging.h"
 
 #include "c-wrapper/c-wrapper.h"
+#include "logger/async-log-sink.h"
 #include "logging-private.h"
 
+using namespace LinphonePrivate;
+
 
 struct _LinphoneLoggingService {
 	belle_sip_object_t base;
@@ -36,6 +39,9 @@ struct _LinphoneLoggingService {
 	bctbx_list_t *callbacks;
 	bctbx_log_handler_t *log_handler;
 	char *domain;
+	AsyncLogSink *async_sink;
+	bctbx_log_handler_t *async_log_handler;
+	OrtpLogFunc replaced_log_func; // Default output replaced by the asynchronous one.
 };
 
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(LinphoneLoggingService);
@@ -181,6 +187,7 @@ void linphone_logging_service_unref(LinphoneLoggingService *service) {
 }
 
 static void _linphone_logging_service_uninit(LinphoneLoggingService *log_service) {
+	linphone_logging_service_disable_async_output(log_service);
 	if (log_service->log_handler)
 		bctbx_remove_log_handler(log_service->log_handler);
 	_linphone_logging_service_clear_callbacks(log_service);
@@ -268,7 +275,76 @@ void linphone_logging_service_set_log_file(const LinphoneLoggingService *service
 	bctbx_add_log_handler(log_handler);
 }
 
+static void _linphone_logging_service_remove_async_output(LinphoneLoggingService *log_service);
+
+static void _async_log_handler_cb(void *info, const char *domain, BctbxLogLevel lev, const char *fmt, va_list args) {
+	static_cast<AsyncLogSink *>(info)->log(domain, lev, fmt, args);
+}
+
+static void _async_log_handler_destroy_cb(bctbx_log_handler_t *handler) {
+	bctbx_free(handler);
+}
+
+int linphone_logging_service_enable_async_output(LinphoneLoggingService *log_service, const char *path, unsigned int capacity, LinphoneLogOverflowPolicy policy) {
+	AsyncLogSink *sink = new AsyncLogSink(
+		path ? path : "",
+		capacity > 0 ? capacity : 1,
+		policy == LinphoneLogOverflowPolicyBlock ? AsyncLogSink::OverflowPolicy::Block : AsyncLogSink::OverflowPolicy::Drop
+	);
+	if (!sink->isValid()) {
+		delete sink;
+		ms_error("%s(): cannot open [%s]", __FUNCTION__, path);
+		return -1;
+	}
+
+	if (log_service->async_sink) {
+		_linphone_logging_service_remove_async_output(log_service);
+	} else {
+		// The default output would still be written by the logging threads.
+		log_service->replaced_log_func = _linphone_core_get_log_handler();
+		_linphone_core_set_log_handler(NULL);
+	}
+	log_service->async_sink = sink;
+	log_service->async_log_handler = bctbx_create_log_handler(_async_log_handler_cb, _async_log_handler_destroy_cb, sink);
+	bctbx_add_log_handler(log_service->async_log_handler);
+	return 0;
+}
+
+static void _linphone_logging_service_remove_async_output(LinphoneLoggingService *log_service) {
+	bctbx_remove_log_handler(log_service->async_log_handler);
+	log_service->async_log_handler = NULL;
+	delete log_service->async_sink;
+	log_service->async_sink = NULL;
+}
+
+void linphone_logging_service_disable_async_output(LinphoneLoggingService *log_service) {
+	if (!log_service->async_sink)
+		return;
+	_linphone_logging_service_remove_async_output(log_service);
+	_linphone_core_set_log_handler(log_service->replaced_log_func);
+	log_service->replaced_log_func = NULL;
+}
+
+bool_t linphone_logging_service_async_output_enabled(const LinphoneLoggingService *log_service) {
+	return log_service->async_sink != NULL;
+}
+
+void linphone_logging_service_flush(LinphoneLoggingService *log_service) {
+	if (log_service->async_sink)
+		log_service->async_sink->flush();
+}
+
+uint64_t linphone_logging_service_get_async_written_count(const LinphoneLoggingService *log_service) {
+	return log_service->async_sink ? log_service->async_sink->getWrittenCount() : 0;
+}
+
+uint64_t linphone_logging_service_get_async_dropped_count(const LinphoneLoggingService *log_service) {
+	return log_service->async_sink ? log_service->async_sink->getDroppedCount() : 0;
+}
+
 void linphone_logging_service_set_domain(LinphoneLoggingService *log_service, const char *domain) {
+	if (log_service->domain)
+		bctbx_free(log_service->domain);
 	log_service->domain = bctbx_strdup(domain);
 }
 
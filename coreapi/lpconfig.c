@@ -35,6 +35,7 @@
 
 #define MAX_LEN 16384
 
+#include "bctoolbox/port.h"
 #include "bctoolbox/vfs.h"
 #include "belle-sip/object.h"
 #include "xml2lpc.h"
@@ -43,6 +44,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <string>
+#include <unordered_map>
 #if !defined(_WIN32_WCE)
 #include <errno.h>
 #include <sys/types.h>
@@ -74,6 +77,22 @@
 #include "c-wrapper/c-wrapper.h"
 #include "core/paths/paths.h"
 
+/* Hash and equality of C strings, so that sections and items are indexed by the names they own, without allocating on lookup. */
+struct LpStringHash {
+	size_t operator()(const char *str) const {
+		size_t hash = 5381;
+		for (; *str != '\0'; str++)
+			hash = (hash * 33) ^ (unsigned char)*str;
+		return hash;
+	}
+};
+
+struct LpStringEqual {
+	bool operator()(const char *a, const char *b) const {
+		return strcmp(a, b) == 0;
+	}
+};
+
 typedef struct _LpItem{
 	char *key;
 	char *value;
@@ -87,26 +106,48 @@ typedef struct _LpSectionParam{
 	char *value;
 } LpSectionParam;
 
+typedef std::unordered_map<const char *, LpItem *, LpStringHash, LpStringEqual> LpItemIndex;
+
 typedef struct _LpSection{
 	char *name;
-	bctbx_list_t *items;
+	bctbx_list_t *items; /* Items and comments, in file order */
+	LpItemIndex *items_index; /* Items by key, the first one in file order for duplicated keys */
 	bctbx_list_t *params;
 	bool_t overwrite; // If set to true, will add overwrite=true to all items of this section when converted to xml
 	bool_t skip; // If set to true, won't be dumped when converted to xml
 } LpSection;
 
+typedef std::unordered_map<const char *, LpSection *, LpStringHash, LpStringEqual> LpSectionIndex;
+
 struct _LpConfig{
 	belle_sip_object_t base;
 	bctbx_vfs_file_t* pFile;
 	char *filename;
 	char *tmpfilename;
 	char *factory_filename;
-	bctbx_list_t *sections;
+	bctbx_list_t *sections; /* Sections in file order */
+	LpSectionIndex *sections_index; /* Sections by name, created with the first section */
+	mutable uint64_t lookup_count; /* Number of section lookups, for benchmarking purpose */
 	bool_t modified;
 	bool_t readonly;
 	bctbx_vfs_t* g_bctbx_vfs;
+	/* Write-behind: a modified config is synced once no change happened during sync_delay_ms,
+	 * or at the latest LP_CONFIG_SYNC_MAX_DELAY_FACTOR * sync_delay_ms after its first unsynced change. */
+	int sync_delay_ms;
+	bool_t fsync_enabled;
+	uint64_t first_change_ms;
+	uint64_t last_change_ms;
+	uint64_t retry_ms; /* No sync is due before this time after a failed write */
+	std::string *synced_content; /* What was written by the last sync, to skip writing it again */
+	uint64_t sync_count;
+	uint64_t bytes_written;
 };
 
+#define LP_CONFIG_DEFAULT_SYNC_DELAY_MS 1000
+/* Shortest delay before a failed write is retried */
+#define LP_CONFIG_SYNC_RETRY_DELAY_MS 1000
+#define LP_CONFIG_SYNC_MAX_DELAY_FACTOR 5
+
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(LinphoneConfig);
 BELLE_SIP_DECLARE_VPTR_NO_EXPORT(LinphoneConfig);
 
@@ -155,6 +196,7 @@ LpSectionParam *lp_section_param_new(const char *key, const char *value){
 LpSection *lp_section_new(const char *name){
 	LpSection *sec=lp_new0(LpSection,1);
 	sec->name=ortp_strdup(name);
+	sec->items_index=new LpItemIndex();
 	return sec;
 }
 
@@ -177,15 +219,21 @@ void lp_section_destroy(LpSection *sec){
 	bctbx_list_for_each(sec->items,lp_item_destroy);
 	bctbx_list_for_each(sec->params,lp_section_param_destroy);
 	bctbx_list_free(sec->items);
+	delete sec->items_index;
 	free(sec);
 }
 
 void lp_section_add_item(LpSection *sec,LpItem *item){
 	sec->items=bctbx_list_append(sec->items,(void *)item);
+	if (!item->is_comment)
+		sec->items_index->emplace(item->key, item);
 }
 
 void linphone_config_add_section(LpConfig *lpconfig, LpSection *section){
 	lpconfig->sections=bctbx_list_append(lpconfig->sections,(void *)section);
+	if (lpconfig->sections_index == NULL)
+		lpconfig->sections_index = new LpSectionIndex();
+	lpconfig->sections_index->emplace(section->name, section);
 }
 
 void linphone_config_add_section_param(LpSection *section, LpSectionParam *param){
@@ -194,11 +242,39 @@ void linphone_config_add_section_param(LpSection *section, LpSectionParam *param
 
 void linphone_config_remove_section(LpConfig *lpconfig, LpSection *section){
 	lpconfig->sections=bctbx_list_remove(lpconfig->sections,(void *)section);
+	auto it = lpconfig->sections_index->find(section->name);
+	if (it != lpconfig->sections_index->end() && it->second == section) {
+		bctbx_list_t *elem;
+		lpconfig->sections_index->erase(it);
+		/* A remaining section with the same name becomes the one found by lookups */
+		for (elem = lpconfig->sections; elem != NULL; elem = bctbx_list_next(elem)){
+			LpSection *other = (LpSection*)elem->data;
+			if (strcmp(other->name, section->name) == 0) {
+				lpconfig->sections_index->emplace(other->name, other);
+				break;
+			}
+		}
+	}
 	lp_section_destroy(section);
 }
 
 void lp_section_remove_item(LpSection *sec, LpItem *item){
 	sec->items=bctbx_list_remove(sec->items,(void *)item);
+	if (!item->is_comment) {
+		auto it = sec->items_index->find(item->key);
+		if (it != sec->items_index->end() && it->second == item) {
+			bctbx_list_t *elem;
+			sec->items_index->erase(it);
+			/* A remaining item with the same key becomes the one found by lookups */
+			for (elem = sec->items; elem != NULL; elem = bctbx_list_next(elem)){
+				LpItem *other = (LpItem*)elem->data;
+				if (!other->is_comment && strcmp(other->key, item->key) == 0) {
+					sec->items_index->emplace(other->key, other);
+					break;
+				}
+			}
+		}
+	}
 	lp_item_destroy(item);
 }
 
@@ -218,18 +294,20 @@ static int is_a_comment(const char *str){
 	return 0;
 }
 
-LpSection *linphone_config_find_section(const LpConfig *lpconfig, const char *name){
-	LpSection *sec;
-	bctbx_list_t *elem = lpconfig->sections;
-	/*printf("Looking for section %s\n",name);*/
-	for (;elem!=NULL;elem=bctbx_list_next(elem)){
-		sec=(LpSection*)elem->data;
-		if (strcmp(sec->name,name)==0){
-			/*printf("Section %s found\n",name);*/
-			return sec;
-		}
+static void linphone_config_set_modified(LpConfig *lpconfig){
+	uint64_t now = bctbx_get_cur_time_ms();
+	if (!lpconfig->modified) {
+		lpconfig->modified = TRUE;
+		lpconfig->first_change_ms = now;
 	}
-	return NULL;
+	lpconfig->last_change_ms = now;
+}
+
+LpSection *linphone_config_find_section(const LpConfig *lpconfig, const char *name){
+	lpconfig->lookup_count++;
+	if (lpconfig->sections_index == NULL) return NULL;
+	auto it = lpconfig->sections_index->find(name);
+	return it != lpconfig->sections_index->end() ? it->second : NULL;
 }
 
 LpSectionParam *lp_section_find_param(const LpSection *sec, const char *key){
@@ -259,17 +337,8 @@ LpItem *lp_section_find_comment(const LpSection *sec, const char *comment){
 }
 
 LpItem *lp_section_find_item(const LpSection *sec, const char *name){
-	bctbx_list_t *elem;
-	LpItem *item;
-	/*printf("Looking for item %s\n",name);*/
-	for (elem=sec->items;elem!=NULL;elem=bctbx_list_next(elem)){
-		item=(LpItem*)elem->data;
-		if (!item->is_comment && strcmp(item->key,name)==0) {
-			/*printf("Item %s found\n",name);*/
-			return item;
-		}
-	}
-	return NULL;
+	auto it = sec->items_index->find(name);
+	return it != sec->items_index->end() ? it->second : NULL;
 }
 
 bctbx_list_t *lp_section_get_items(const LpSection *sec){
@@ -431,6 +500,7 @@ void _linphone_config_apply_factory_config (LpConfig *config) {
 
 LpConfig * linphone_config_new_from_buffer(const char *buffer){
 	LpConfig* conf = belle_sip_object_new(LinphoneConfig);
+	conf->sync_delay_ms = LP_CONFIG_DEFAULT_SYNC_DELAY_MS;
 	_linphone_config_init_from_buffer(conf, buffer);
 	return conf;
 }
@@ -490,6 +560,7 @@ fail:
 
 LpConfig *linphone_config_new_with_factory(const char *config_filename, const char *factory_config_filename) {
 	LpConfig *lpconfig=belle_sip_object_new(LinphoneConfig);
+	lpconfig->sync_delay_ms = LP_CONFIG_DEFAULT_SYNC_DELAY_MS;
 	if (factory_config_filename && strcmp(factory_config_filename, "") != 0)
 		lpconfig->factory_filename = bctbx_strdup(factory_config_filename);
 	if (_linphone_config_init_from_files(lpconfig, config_filename, factory_config_filename) == 0) {
@@ -621,6 +692,8 @@ static void _linphone_config_uninit(LpConfig *lpconfig){
 	if (lpconfig->tmpfilename) ortp_free(lpconfig->tmpfilename);
 	if (lpconfig->factory_filename) bctbx_free(lpconfig->factory_filename);
 	if (lpconfig->sections) bctbx_list_free_with_data(lpconfig->sections, (bctbx_list_free_func)lp_section_destroy);
+	if (lpconfig->sections_index) delete lpconfig->sections_index;
+	if (lpconfig->synced_content) delete lpconfig->synced_content;
 }
 
 LpConfig *linphone_config_ref(LpConfig *lpconfig){
@@ -798,15 +871,15 @@ void linphone_config_set_string(LpConfig *lpconfig,const char *section, const ch
 				lp_section_remove_item(sec, item);
 			}
 		}else{
-			if (value!=NULL && value[0] != '\0')
-				lp_section_add_item(sec,lp_item_new(key,value));
+			if (value==NULL || value[0] == '\0') return;
+			lp_section_add_item(sec,lp_item_new(key,value));
 		}
 	}else if (value!=NULL && value[0] != '\0'){
 		sec=lp_section_new(section);
 		linphone_config_add_section(lpconfig,sec);
 		lp_section_add_item(sec,lp_item_new(key,value));
-	}
-	lpconfig->modified = TRUE;
+	}else return;
+	linphone_config_set_modified(lpconfig);
 }
 
 void linphone_config_set_string_list(LpConfig *lpconfig, const char *section, const char *key, const bctbx_list_t *value) {
@@ -900,50 +973,49 @@ void linphone_config_set_skip_flag_for_section(LpConfig *lpconfig, const char *s
 	}
 }
 
-void lp_item_write(LpItem *item, LpConfig *lpconfig){
-	int ret =-1 ;
+void lp_item_write(LpItem *item, std::string *buffer){
 	if (item->is_comment){
-		ret = (int)bctbx_file_fprintf(lpconfig->pFile, 0, "%s\n",item->value);
-
+		buffer->append(item->value).append("\n");
 	}
 	else if (item->value && item->value[0] != '\0' ){
-		ret = (int)bctbx_file_fprintf(lpconfig->pFile, 0, "%s=%s\n",item->key,item->value);
+		buffer->append(item->key).append("=").append(item->value).append("\n");
 	}
-
 	else {
 		ms_warning("Not writing item %s to file, it is empty", item->key);
 	}
-	if (ret < 0){
-		ms_error("lp_item_write : not writing item to file" );
-	}
 }
 
-void lp_section_param_write(LpSectionParam *param, LpConfig *lpconfig){
+void lp_section_param_write(LpSectionParam *param, std::string *buffer){
 	if( param->value && param->value[0] != '\0') {
-		bctbx_file_fprintf(lpconfig->pFile, 0, " %s=%s", param->key, param->value);
-
+		buffer->append(" ").append(param->key).append("=").append(param->value);
 	} else {
 		ms_warning("Not writing param %s to file, it is empty", param->key);
 	}
 }
 
-void lp_section_write(LpSection *sec,LpConfig *lpconfig){
-
-	if (bctbx_file_fprintf(lpconfig->pFile, 0, "[%s",sec->name) < 0) ms_error("lp_section_write : write error on %s", sec->name);
-	bctbx_list_for_each2(sec->params, (void (*)(void*, void*))lp_section_param_write, (void *)lpconfig);
-
-	if (bctbx_file_fprintf(lpconfig->pFile, 0, "]\n")< 0) ms_error("lp_section_write : write error ");
-	bctbx_list_for_each2(sec->items, (void (*)(void*, void*))lp_item_write, (void *)lpconfig);
-
-	if (bctbx_file_fprintf(lpconfig->pFile, 0, "\n")< 0) ms_error("lp_section_write : write error");
-
+void lp_section_write(LpSection *sec, std::string *buffer){
+	buffer->append("[").append(sec->name);
+	bctbx_list_for_each2(sec->params, (void (*)(void*, void*))lp_section_param_write, (void *)buffer);
+	buffer->append("]\n");
+	bctbx_list_for_each2(sec->items, (void (*)(void*, void*))lp_item_write, (void *)buffer);
+	buffer->append("\n");
 }
 
 LinphoneStatus linphone_config_sync(LpConfig *lpconfig){
 	bctbx_vfs_file_t *pFile = NULL;
+	std::string content;
+	ssize_t written;
 	if (lpconfig->filename==NULL) return -1;
 	if (lpconfig->readonly) return 0;
 
+	/* The whole file is serialized in memory, then written with a single call. */
+	bctbx_list_for_each2(lpconfig->sections,(void (*)(void *,void*))lp_section_write,(void *)&content);
+	if (lpconfig->synced_content && *lpconfig->synced_content == content) {
+		/* Changes cancelled each other since the last sync: the file is already up to date. */
+		lpconfig->modified = FALSE;
+		return 0;
+	}
+
 #ifndef _WIN32
 	/* don't create group/world-accessible files */
 	(void) umask(S_IRWXG | S_IRWXO);
@@ -956,8 +1028,22 @@ LinphoneStatus linphone_config_sync(LpConfig *lpconfig){
 		return -1;
 	}
 
-	bctbx_list_for_each2(lpconfig->sections,(void (*)(void *,void*))lp_section_write,(void *)lpconfig);
+	written = bctbx_file_write(pFile, content.c_str(), content.size(), 0);
+	if (written < 0 || (size_t)written != content.size()) {
+		ms_error("linphone_config_sync : write error on %s", lpconfig->tmpfilename);
+		bctbx_file_close(pFile);
+		lpconfig->pFile = NULL;
+		/* Still modified, but don't retry at each iteration */
+		lpconfig->retry_ms = bctbx_get_cur_time_ms()
+			+ (uint64_t)(lpconfig->sync_delay_ms > LP_CONFIG_SYNC_RETRY_DELAY_MS ? lpconfig->sync_delay_ms : LP_CONFIG_SYNC_RETRY_DELAY_MS);
+		return -1;
+	}
+	/* Make sure the data reached the storage before the temporary file replaces the config file. */
+	if (lpconfig->fsync_enabled && bctbx_file_sync(pFile) < 0) {
+		ms_error("linphone_config_sync : cannot sync %s", lpconfig->tmpfilename);
+	}
 	bctbx_file_close(pFile);
+	lpconfig->pFile = NULL;
 
 #ifdef RENAME_REQUIRES_NONEXISTENT_NEW_PATH
 	/* On windows, rename() does not accept that the newpath is an existing file, while it is accepted on Unix.
@@ -970,13 +1056,43 @@ LinphoneStatus linphone_config_sync(LpConfig *lpconfig){
 		ms_error("Cannot rename %s into %s: %s",lpconfig->tmpfilename,lpconfig->filename,strerror(errno));
 	}
 	lpconfig->modified = FALSE;
+	lpconfig->sync_count++;
+	lpconfig->bytes_written += content.size();
+	if (lpconfig->synced_content == NULL)
+		lpconfig->synced_content = new std::string();
+	lpconfig->synced_content->swap(content);
 	return 0;
 }
 
+void _linphone_config_set_sync_policy(LpConfig *lpconfig, int delay_ms, bool_t fsync_enabled) {
+	lpconfig->sync_delay_ms = delay_ms < 0 ? 0 : delay_ms;
+	lpconfig->fsync_enabled = fsync_enabled;
+}
+
+bool_t _linphone_config_sync_due(const LpConfig *lpconfig) {
+	uint64_t now;
+	if (!lpconfig->modified) return FALSE;
+	now = bctbx_get_cur_time_ms();
+	if (now < lpconfig->retry_ms) return FALSE;
+	return (now - lpconfig->last_change_ms >= (uint64_t)lpconfig->sync_delay_ms)
+		|| (now - lpconfig->first_change_ms >= (uint64_t)lpconfig->sync_delay_ms * LP_CONFIG_SYNC_MAX_DELAY_FACTOR);
+}
+
+uint64_t _linphone_config_get_sync_count(const LpConfig *lpconfig) {
+	return lpconfig->sync_count;
+}
+
+uint64_t _linphone_config_get_bytes_written(const LpConfig *lpconfig) {
+	return lpconfig->bytes_written;
+}
+
 void linphone_config_reload(LinphoneConfig *lpconfig) {
 	bctbx_list_for_each(lpconfig->sections, (void (*)(void*)) lp_section_destroy);
 	bctbx_list_free(lpconfig->sections);
 	lpconfig->sections = NULL;
+	if (lpconfig->sections_index) lpconfig->sections_index->clear();
+	/* The file may have been modified by someone else */
+	if (lpconfig->synced_content) lpconfig->synced_content->clear();
 	linphone_config_read_file(lpconfig, lpconfig->filename);
 }
 
@@ -1011,8 +1127,8 @@ void linphone_config_clean_section(LpConfig *lpconfig, const char *section){
 	LpSection *sec=linphone_config_find_section(lpconfig,section);
 	if (sec!=NULL){
 		linphone_config_remove_section(lpconfig,sec);
+		linphone_config_set_modified(lpconfig);
 	}
-	lpconfig->modified = TRUE;
 }
 
 bool_t linphone_config_needs_commit(const LpConfig *lpconfig){
@@ -1277,8 +1393,10 @@ void linphone_config_clean_entry(LpConfig *lpconfig, const char *section, const
 	sec=linphone_config_find_section(lpconfig,section);
 	if (sec!=NULL){
 		item=lp_section_find_item(sec,key);
-		if (item!=NULL)
+		if (item!=NULL) {
 			lp_section_remove_item(sec,item);
+			linphone_config_set_modified(lpconfig);
+		}
 	}
 	return ;
 }
@@ -1292,6 +1410,10 @@ int linphone_config_has_entry(const LpConfig *lpconfig, const char *section, con
 
 }
 
+uint64_t _linphone_config_get_lookup_count(const LpConfig *lpconfig) {
+	return lpconfig->lookup_count;
+}
+
 BELLE_SIP_INSTANCIATE_VPTR(
 	LinphoneConfig,
 	belle_sip_object_t,
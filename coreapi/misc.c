@@ -313,13 +313,20 @@ int linphone_core_get_local_ip_for(int type, const char *dest, char *result){
 	return bctbx_get_local_ip_for(type, dest, 5060, result, LINPHONE_IPADDR_SIZE);
 }
 
+/*the default local ip (without destination) is only looked up again after a change of the network interfaces*/
+static int get_local_ip_for(LinphoneCore *lc, int type, const char *dest, char *result){
+	if (dest == NULL || dest[0] == '\0')
+		return L_GET_PRIVATE_FROM_C_OBJECT(lc)->getIfAddrsCache().getDefaultLocalIp(type, result);
+	return linphone_core_get_local_ip_for(type, dest, result);
+}
+
 void linphone_core_get_local_ip(LinphoneCore *lc, int af, const char *dest, char *result) {
 	if (af == AF_UNSPEC) {
 		if (linphone_core_ipv6_enabled(lc)) {
-			bool_t has_ipv6 = linphone_core_get_local_ip_for(AF_INET6, dest, result) == 0;
+			bool_t has_ipv6 = get_local_ip_for(lc, AF_INET6, dest, result) == 0;
 			if (strcmp(result, "::1") != 0)
 				return; /*this machine has real ipv6 connectivity*/
-			if ((linphone_core_get_local_ip_for(AF_INET, dest, result) == 0) && (strcmp(result, "127.0.0.1") != 0))
+			if ((get_local_ip_for(lc, AF_INET, dest, result) == 0) && (strcmp(result, "127.0.0.1") != 0))
 				return; /*this machine has only ipv4 connectivity*/
 			if (has_ipv6) {
 				/*this machine has only local loopback for both ipv4 and ipv6, so prefer ipv6*/
@@ -330,7 +337,7 @@ void linphone_core_get_local_ip(LinphoneCore *lc, int af, const char *dest, char
 		/*in all other cases use IPv4*/
 		af = AF_INET;
 	}
-	linphone_core_get_local_ip_for(af, dest, result);
+	get_local_ip_for(lc, af, dest, result);
 }
 
 SalReason linphone_reason_to_sal(LinphoneReason reason){
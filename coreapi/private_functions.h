@@ -32,6 +32,7 @@
 #include "conference/participant-imdn-state.h"
 #include "sal/op.h"
 #include "sal/event-op.h"
+#include "sal/presence-op.h"
 #include "sal/register-op.h"
 
 #include "linphone/core_utils.h"
@@ -180,6 +181,9 @@ void linphone_friend_list_invalidate_subscriptions(LinphoneFriendList *list);
 void linphone_friend_list_notify_presence_received(LinphoneFriendList *list, LinphoneEvent *lev, const LinphoneContent *body);
 void linphone_friend_list_subscription_state_changed(LinphoneCore *lc, LinphoneEvent *lev, LinphoneSubscriptionState state);
 void linphone_friend_list_invalidate_friends_maps(LinphoneFriendList *list);
+LinphonePrivate::MagicSearchIndex *linphone_friend_list_get_search_index(LinphoneFriendList *list);
+void linphone_friend_list_invalidate_friend_search_index(LinphoneFriendList *list, const LinphoneFriend *lf);
+void linphone_friend_list_delete_search_index(LinphoneFriendList *list);
 
 /**
  * Removes all bodyless friend lists.
@@ -195,6 +199,9 @@ void linphone_friend_close_subscriptions(LinphoneFriend *lf);
 void _linphone_friend_release(LinphoneFriend *lf);
 LINPHONE_PUBLIC void linphone_friend_update_subscribes(LinphoneFriend *fr, bool_t only_when_registered);
 void linphone_friend_notify(LinphoneFriend *lf, LinphonePresenceModel *presence);
+/* Notifies the presence to the incoming subscriptions of the friend with a body shared by all of them, created by the first NOTIFY.
+ * Returns the number of NOTIFY requests sent. */
+int linphone_friend_notify_with_payload(LinphoneFriend *lf, LinphonePresenceModel *presence, std::shared_ptr<const LinphonePrivate::NotifyPayload> &payload, bool_t deflate);
 void linphone_friend_apply(LinphoneFriend *fr, LinphoneCore *lc);
 void linphone_friend_add_incoming_subscription(LinphoneFriend *lf, LinphonePrivate::SalOp *op);
 void linphone_friend_remove_incoming_subscription(LinphoneFriend *lf, LinphonePrivate::SalOp *op);
@@ -475,6 +482,8 @@ int linphone_upnp_init(LinphoneCore *lc);
 void linphone_upnp_destroy(LinphoneCore *lc);
 
 int _linphone_sqlite3_open(const char *db_file, sqlite3 **db);
+void _linphone_sqlite3_set_options(LinphoneConfig *config, sqlite3 *db);
+bool_t _linphone_sqlite3_is_pragma_value(const char *value);
 
 LinphoneChatMessageStateChangedCb linphone_chat_message_get_message_state_changed_cb(LinphoneChatMessage* msg);
 void linphone_chat_message_set_message_state_changed_cb(LinphoneChatMessage* msg, LinphoneChatMessageStateChangedCb cb);
@@ -508,6 +517,8 @@ bool_t linphone_event_is_internal(LinphoneEvent *lev);
 void linphone_event_set_state(LinphoneEvent *lev, LinphoneSubscriptionState state);
 void linphone_event_set_publish_state(LinphoneEvent *lev, LinphonePublishState state);
 void _linphone_event_notify_notify_response(LinphoneEvent *lev);
+/* Sends a NOTIFY whose body is read from body_handler, which is not encoded again. */
+LinphoneStatus _linphone_event_notify_with_body_handler(LinphoneEvent *lev, SalBodyHandler *body_handler);
 LinphoneSubscriptionState linphone_subscription_state_from_sal(SalSubscribeStatus ss);
 LinphoneContent *linphone_content_from_sal_body_handler(const SalBodyHandler *ref, bool parseMultipart = true);
 void linphone_core_invalidate_friend_subscriptions(LinphoneCore *lc);
@@ -696,11 +707,17 @@ LinphoneVideoDefinition * linphone_factory_find_supported_video_definition_by_na
 const char* _linphone_config_load_from_xml_string(LpConfig *lpc, const char *buffer);
 LinphoneNatPolicy * linphone_config_create_nat_policy_from_section(const LinphoneConfig *config, const char* section);
 void _linphone_config_apply_factory_config (LpConfig *config);
+uint64_t _linphone_config_get_lookup_count(const LpConfig *config);
+void _linphone_config_set_sync_policy(LpConfig *config, int delay_ms, bool_t fsync_enabled);
+bool_t _linphone_config_sync_due(const LpConfig *config);
+uint64_t _linphone_config_get_sync_count(const LpConfig *config);
+uint64_t _linphone_config_get_bytes_written(const LpConfig *config);
 
 SalCustomHeader *linphone_info_message_get_headers (const LinphoneInfoMessage *im);
 void linphone_info_message_set_headers (LinphoneInfoMessage *im, const SalCustomHeader *headers);
 
 void _linphone_core_set_log_handler(OrtpLogFunc logfunc);
+OrtpLogFunc _linphone_core_get_log_handler(void);
 
 void _linphone_core_set_native_preview_window_id(LinphoneCore *lc, void *id);
 void _linphone_core_set_native_video_window_id(LinphoneCore *lc, void *id);
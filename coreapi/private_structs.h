@@ -108,6 +108,10 @@ struct _LinphoneFriendListCbs {
 
 BELLE_SIP_DECLARE_VPTR_NO_EXPORT(LinphoneFriendListCbs);
 
+namespace LinphonePrivate {
+	class MagicSearchIndex;
+};
+
 struct _LinphoneFriendList {
 	belle_sip_object_t base;
 	void *user_data;
@@ -131,6 +135,8 @@ struct _LinphoneFriendList {
 	bool_t enable_subscriptions;
 	bool_t bodyless_subscription;
 	LinphoneFriendListType type;
+	LinphonePrivate::MagicSearchIndex *search_index; /* created on first MagicSearch use */
+	int presence_notify_count; /* NOTIFY requests sent for the last presence change */
 };
 
 BELLE_SIP_DECLARE_VPTR_NO_EXPORT(LinphoneFriendList);
@@ -235,10 +235,197 @@ static int sqlite3bctbx_Sync(sqlite3_file *p, int flags){
 
 /************************ END OF PLACE HOLDER FUNCTIONS ***********************/
 
+/************************ SHARED MEMORY FUNCTIONS ***********************/
+/** The WAL index of a database opened in journal_mode=WAL lives in shared memory.
+Files are never locked by this VFS, so a database can only be shared between the connections
+of one process: the shared memory is allocated in the heap and shared by the connections
+opening the same file name. */
+
+/**
+ * Shared memory of one database file.
+ */
+struct sqlite3_bctbx_shm_t {
+	sqlite3_bctbx_shm_t *pNext;
+	char *zPath;
+	int nRef;                               /* Number of files mapping this shared memory. */
+	int nRegion;
+	int szRegion;
+	char **apRegion;
+	int sharedCount[SQLITE_SHM_NLOCK];      /* Number of SHARED locks held on each slot. */
+	int exclusive[SQLITE_SHM_NLOCK];        /* Whether an EXCLUSIVE lock is held on each slot. */
+};
+
+static sqlite3_bctbx_shm_t *sqlite3bctbx_shmList = NULL;
+
+static sqlite3_mutex *sqlite3bctbx_shmMutex(void){
+#ifdef SQLITE_MUTEX_STATIC_VFS1
+	return sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_VFS1);
+#else
+	return sqlite3_mutex_alloc(SQLITE_MUTEX_STATIC_MASTER);
+#endif
+}
+
+/**
+ * Releases the locks held by a file. Must be called with the shared memory mutex held.
+ */
+static void sqlite3bctbx_shmReleaseLocks(sqlite3_bctbx_file_t *pFile, unsigned short mask){
+	int i;
+	for (i = 0; i < SQLITE_SHM_NLOCK; i++){
+		if (!(mask & (1 << i))) continue;
+		if (pFile->shmExclMask & (1 << i)) pFile->pShm->exclusive[i] = 0;
+		if (pFile->shmSharedMask & (1 << i)) pFile->pShm->sharedCount[i]--;
+	}
+	pFile->shmExclMask &= (unsigned short)~mask;
+	pFile->shmSharedMask &= (unsigned short)~mask;
+}
+
+/**
+ * Returns the region iRegion of the shared memory of the file, creating the shared memory
+ * and the region if bExtend is set.
+ * @param  p       sqlite3_file file handle pointer.
+ * @param  iRegion region index
+ * @param  szRegion size of each region, the same for all the calls
+ * @param  bExtend whether the region must be allocated if it doesn't exist
+ * @param  pp      set to the region, or NULL if it doesn't exist and bExtend is not set
+ * @return         SQLITE_OK on success, SQLITE_IOERR_NOMEM if an allocation failed.
+ */
+static int sqlite3bctbx_ShmMap(sqlite3_file *p, int iRegion, int szRegion, int bExtend, void volatile **pp){
+	sqlite3_bctbx_file_t *pFile = (sqlite3_bctbx_file_t*)p;
+	sqlite3_mutex *mutex = sqlite3bctbx_shmMutex();
+	sqlite3_bctbx_shm_t *pShm;
+	int rc = SQLITE_OK;
+
+	*pp = NULL;
+	sqlite3_mutex_enter(mutex);
+	pShm = pFile->pShm;
+	if (pShm == NULL){
+		for (pShm = sqlite3bctbx_shmList; pShm; pShm = pShm->pNext){
+			if (strcmp(pShm->zPath, pFile->zPath) == 0) break;
+		}
+		if (pShm == NULL){
+			pShm = (sqlite3_bctbx_shm_t*)bctbx_malloc0(sizeof(*pShm));
+			pShm->zPath = bctbx_strdup(pFile->zPath);
+			pShm->szRegion = szRegion;
+			pShm->pNext = sqlite3bctbx_shmList;
+			sqlite3bctbx_shmList = pShm;
+		}
+		pShm->nRef++;
+		pFile->pShm = pShm;
+	}
+
+	if (iRegion >= pShm->nRegion && bExtend){
+		char **apRegion = (char**)bctbx_realloc(pShm->apRegion, (size_t)(iRegion + 1) * sizeof(char*));
+		if (apRegion == NULL){
+			rc = SQLITE_IOERR_NOMEM;
+		} else {
+			pShm->apRegion = apRegion;
+			while (pShm->nRegion <= iRegion){
+				pShm->apRegion[pShm->nRegion++] = (char*)bctbx_malloc0((size_t)szRegion);
+			}
+		}
+	}
+	if (iRegion < pShm->nRegion) *pp = pShm->apRegion[iRegion];
+	sqlite3_mutex_leave(mutex);
+	return rc;
+}
+
+/**
+ * Takes or releases the locks on n slots of the shared memory, starting at offset.
+ * @param  p      sqlite3_file file handle pointer.
+ * @param  offset first slot
+ * @param  n      number of slots, 1 for a SHARED lock
+ * @param  flags  SQLITE_SHM_LOCK or SQLITE_SHM_UNLOCK, with SQLITE_SHM_SHARED or SQLITE_SHM_EXCLUSIVE
+ * @return        SQLITE_OK on success, SQLITE_BUSY if the lock is held by another file.
+ */
+static int sqlite3bctbx_ShmLock(sqlite3_file *p, int offset, int n, int flags){
+	sqlite3_bctbx_file_t *pFile = (sqlite3_bctbx_file_t*)p;
+	sqlite3_mutex *mutex = sqlite3bctbx_shmMutex();
+	sqlite3_bctbx_shm_t *pShm = pFile->pShm;
+	unsigned short mask = (unsigned short)((1 << (offset + n)) - (1 << offset));
+	int rc = SQLITE_OK;
+	int i;
+
+	if (pShm == NULL) return SQLITE_IOERR_SHMLOCK;
+
+	sqlite3_mutex_enter(mutex);
+	if (flags & SQLITE_SHM_UNLOCK){
+		sqlite3bctbx_shmReleaseLocks(pFile, mask);
+	} else if (flags & SQLITE_SHM_SHARED){
+		if (!(pFile->shmSharedMask & mask)){
+			for (i = offset; i < offset + n; i++){
+				if (pShm->exclusive[i]){
+					rc = SQLITE_BUSY;
+					break;
+				}
+			}
+			if (rc == SQLITE_OK){
+				for (i = offset; i < offset + n; i++) pShm->sharedCount[i]++;
+				pFile->shmSharedMask |= mask;
+			}
+		}
+	} else {
+		for (i = offset; i < offset + n; i++){
+			int ownShared = (pFile->shmSharedMask & (1 << i)) ? 1 : 0;
+			if ((pShm->exclusive[i] && !(pFile->shmExclMask & (1 << i))) || pShm->sharedCount[i] > ownShared){
+				rc = SQLITE_BUSY;
+				break;
+			}
+		}
+		if (rc == SQLITE_OK){
+			for (i = offset; i < offset + n; i++) pShm->exclusive[i] = 1;
+			pFile->shmExclMask |= mask;
+		}
+	}
+	sqlite3_mutex_leave(mutex);
+	return rc;
+}
+
+/**
+ * Memory barrier between the connections sharing the memory: taking a mutex is enough.
+ * @param  p sqlite3_file file handle pointer.
+ */
+static void sqlite3bctbx_ShmBarrier(sqlite3_file *p){
+	sqlite3_mutex *mutex = sqlite3bctbx_shmMutex();
+	sqlite3_mutex_enter(mutex);
+	sqlite3_mutex_leave(mutex);
+}
+
+/**
+ * Unmaps the shared memory of the file, it is freed once no file maps it anymore.
+ * @param  p          sqlite3_file file handle pointer.
+ * @param  deleteFlag unused, the shared memory is never persisted
+ * @return            SQLITE_OK
+ */
+static int sqlite3bctbx_ShmUnmap(sqlite3_file *p, int deleteFlag){
+	sqlite3_bctbx_file_t *pFile = (sqlite3_bctbx_file_t*)p;
+	sqlite3_mutex *mutex = sqlite3bctbx_shmMutex();
+	sqlite3_bctbx_shm_t *pShm = pFile->pShm;
+
+	if (pShm == NULL) return SQLITE_OK;
+
+	sqlite3_mutex_enter(mutex);
+	sqlite3bctbx_shmReleaseLocks(pFile, (unsigned short)((1 << SQLITE_SHM_NLOCK) - 1));
+	pFile->pShm = NULL;
+	if (--pShm->nRef == 0){
+		sqlite3_bctbx_shm_t **ppShm = &sqlite3bctbx_shmList;
+		int i;
+		while (*ppShm != pShm) ppShm = &(*ppShm)->pNext;
+		*ppShm = pShm->pNext;
+		for (i = 0; i < pShm->nRegion; i++) bctbx_free(pShm->apRegion[i]);
+		bctbx_free(pShm->apRegion);
+		bctbx_free(pShm->zPath);
+		bctbx_free(pShm);
+	}
+	sqlite3_mutex_leave(mutex);
+	return SQLITE_OK;
+}
+
+/************************ END OF SHARED MEMORY FUNCTIONS ***********************/
+
 /**
  * Opens the file fName and populates the structure pointed by p
  * with the necessary io_methods
- * Methods not implemented for version 1 : xTruncate, xSectorSize.
+ * Methods not implemented for version 2 : xSectorSize.
  * Initializes some fields in the p structure, some of which where already
  * initialized by SQLite.
  * @param  pVfs      sqlite3_vfs VFS pointer.
@@ -250,7 +437,7 @@ static int sqlite3bctbx_Sync(sqlite3_file *p, int flags){
  */
 static  int sqlite3bctbx_Open(sqlite3_vfs *pVfs, const char *fName, sqlite3_file *p, int flags, int *pOutFlags ){
 	static const sqlite3_io_methods sqlite3_bctbx_io = {
-		1,										/* iVersion         Structure version number */
+		2,										/* iVersion         Structure version number */
 		sqlite3bctbx_Close,                 	/* xClose */
 		sqlite3bctbx_Read,                  	/* xRead */
 		sqlite3bctbx_Write,                 	/* xWrite */
@@ -262,8 +449,12 @@ static  int sqlite3bctbx_Open(sqlite3_vfs *pVfs, const char *fName, sqlite3_file
 		sqlite3bctbx_nolockCheckReservedLock,
 		sqlite3bctbx_FileControl,
 		NULL,									/* xSectorSize */
-		sqlite3bctbx_DeviceCharacteristics
-		/*other function points follows, all NULL but not present in all sqlite3 versions.*/
+		sqlite3bctbx_DeviceCharacteristics,
+		sqlite3bctbx_ShmMap,					/* xShmMap */
+		sqlite3bctbx_ShmLock,					/* xShmLock */
+		sqlite3bctbx_ShmBarrier,				/* xShmBarrier */
+		sqlite3bctbx_ShmUnmap					/* xShmUnmap */
+		/*xFetch and xUnfetch of version 3 are not provided: the file may be encrypted, it can't be memory mapped.*/
 	};
 
 	sqlite3_bctbx_file_t * pFile = (sqlite3_bctbx_file_t*)p; /*File handle sqlite3_bctbx_file_t*/
@@ -299,6 +490,10 @@ static  int sqlite3bctbx_Open(sqlite3_vfs *pVfs, const char *fName, sqlite3_file
 	if( pOutFlags ){
     	*pOutFlags = flags;
   	}
+	pFile->zPath = fName;
+	pFile->pShm = NULL;
+	pFile->shmSharedMask = 0;
+	pFile->shmExclMask = 0;
 	pFile->base.pMethods = &sqlite3_bctbx_io;
 
 	return SQLITE_OK;
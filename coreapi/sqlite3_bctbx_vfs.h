@@ -41,9 +41,14 @@
  * sqlite3_bctbx_file_t VFS file structure.
  */
 typedef struct sqlite3_bctbx_file_t sqlite3_bctbx_file_t;
+typedef struct sqlite3_bctbx_shm_t sqlite3_bctbx_shm_t;
 struct sqlite3_bctbx_file_t {
 	sqlite3_file base;              /* Base class. Must be first. */
 	bctbx_vfs_file_t* pbctbx_file;
+	const char *zPath;              /* Name given to xOpen, valid until xClose. Key of the shared memory. */
+	sqlite3_bctbx_shm_t *pShm;      /* Shared memory used by the WAL index, NULL if not mapped. */
+	unsigned short shmSharedMask;   /* Shared memory locks held in SHARED mode by this file. */
+	unsigned short shmExclMask;     /* Shared memory locks held in EXCLUSIVE mode by this file. */
 };
 
 
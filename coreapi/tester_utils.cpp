@@ -27,6 +27,7 @@
 #include "call/call.h"
 #include "chat/chat-room/chat-room-p.h"
 #include "chat/chat-room/client-group-chat-room-p.h"
+#include "chat/notification/imdn-state-queue.h"
 #include "core/core-p.h"
 #include "c-wrapper/c-wrapper.h"
 #include "conference/session/media-session-p.h"
@@ -64,6 +65,18 @@ bctbx_list_t **linphone_core_get_call_logs_attribute(LinphoneCore *lc) {
 	return &lc->call_logs;
 }
 
+uint64_t linphone_config_get_lookup_count(const LinphoneConfig *config) {
+	return _linphone_config_get_lookup_count(config);
+}
+
+uint64_t linphone_config_get_sync_count(const LinphoneConfig *config) {
+	return _linphone_config_get_sync_count(config);
+}
+
+uint64_t linphone_config_get_bytes_written(const LinphoneConfig *config) {
+	return _linphone_config_get_bytes_written(config);
+}
+
 void linphone_core_cbs_set_auth_info_requested(LinphoneCoreCbs *cbs, LinphoneCoreAuthInfoRequestedCb cb) {
 	cbs->vtable->auth_info_requested = cb;
 }
@@ -214,6 +227,18 @@ const char *linphone_core_get_tone_file(LinphoneCore *lc, LinphoneToneID id){
 	return tone ? tone->audiofile : NULL;
 }
 
+void linphone_core_get_imdn_state_queue_stats(LinphoneCore *lc, LinphoneCoreImdnStateQueueStats *stats) {
+	*stats = LinphoneCoreImdnStateQueueStats();
+	const auto &imdnStateQueue = L_GET_PRIVATE_FROM_C_OBJECT(lc)->imdnStateQueue;
+	if (!imdnStateQueue)
+		return;
+	const auto &queueStats = imdnStateQueue->getStats();
+	stats->number_of_received_states = (int)queueStats.receivedStates;
+	stats->number_of_applied_states = (int)queueStats.appliedStates;
+	stats->number_of_batches = (int)queueStats.batches;
+	stats->largest_batch = (int)queueStats.largestBatch;
+}
+
 void linphone_core_reset_shared_core_state(LinphoneCore *lc) {
 	static_cast<PlatformHelpers *>(lc->platform_helper)->getSharedCoreHelpers()->resetSharedCoreState();
 }
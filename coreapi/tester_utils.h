@@ -58,6 +58,13 @@ typedef struct _LinphoneCoreToneManagerStats {
 	int number_of_stopTone;
 } LinphoneCoreToneManagerStats;
 
+typedef struct _LinphoneCoreImdnStateQueueStats {
+	int number_of_received_states;
+	int number_of_applied_states;
+	int number_of_batches;
+	int largest_batch;
+} LinphoneCoreImdnStateQueueStats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -90,6 +97,12 @@ LINPHONE_PUBLIC bctbx_list_t * linphone_core_read_call_logs_from_config_file(Lin
 LINPHONE_PUBLIC bctbx_list_t **linphone_core_get_call_logs_attribute(LinphoneCore *lc);
 LINPHONE_PUBLIC void linphone_core_delete_call_log(LinphoneCore *lc, LinphoneCallLog *log);
 
+/* Number of section lookups done in the config since its creation. */
+LINPHONE_PUBLIC uint64_t linphone_config_get_lookup_count(const LinphoneConfig *config);
+/* Number of times the config file was written, and total number of bytes written. */
+LINPHONE_PUBLIC uint64_t linphone_config_get_sync_count(const LinphoneConfig *config);
+LINPHONE_PUBLIC uint64_t linphone_config_get_bytes_written(const LinphoneConfig *config);
+
 LINPHONE_PUBLIC const MSList *linphone_core_get_call_history(LinphoneCore *lc);
 LINPHONE_PUBLIC void linphone_core_delete_call_history(LinphoneCore *lc);
 LINPHONE_PUBLIC int linphone_core_get_call_history_size(LinphoneCore *lc);
@@ -142,6 +155,7 @@ LINPHONE_PUBLIC void linphone_friend_invalidate_subscription(LinphoneFriend *lf)
 LINPHONE_PUBLIC void linphone_friend_update_subscribes(LinphoneFriend *fr, bool_t only_when_registered);
 LINPHONE_PUBLIC const bctbx_list_t *linphone_friend_get_insubs(const LinphoneFriend *fr);
 LINPHONE_PUBLIC int linphone_friend_list_get_expected_notification_version(const LinphoneFriendList *list);
+LINPHONE_PUBLIC int linphone_friend_list_get_presence_notify_count(const LinphoneFriendList *list);
 LINPHONE_PUBLIC unsigned int linphone_friend_list_get_storage_id(const LinphoneFriendList *list);
 LINPHONE_PUBLIC unsigned int linphone_friend_get_storage_id(const LinphoneFriend *lf);
 LINPHONE_PUBLIC void linphone_friend_set_core(LinphoneFriend *lf, LinphoneCore *lc);
@@ -157,6 +171,7 @@ LINPHONE_PUBLIC char *linphone_core_get_device_identity(LinphoneCore *lc);
 LINPHONE_PUBLIC const LinphoneCoreToneManagerStats *linphone_core_get_tone_manager_stats(LinphoneCore *lc);
 LINPHONE_PUBLIC void linphone_core_reset_tone_manager_stats(LinphoneCore *lc);
 LINPHONE_PUBLIC const char *linphone_core_get_tone_file(LinphoneCore *lc, LinphoneToneID id);
+LINPHONE_PUBLIC void linphone_core_get_imdn_state_queue_stats(LinphoneCore *lc, LinphoneCoreImdnStateQueueStats *stats);
 
 /**
  * Send a request to delete an account on server.
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2010-2019 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "push-events.h"
+
+using namespace std;
+
+class PushEventsResponse : public Response {
+public:
+	PushEventsResponse(bool enabled);
+};
+
+PushEventsResponse::PushEventsResponse(bool enabled) : Response() {
+	ostringstream ost;
+	ost << "State: " << (enabled ? "enabled" : "disabled") << "\n";
+	setBody(ost.str());
+}
+
+PushEventsCommand::PushEventsCommand() :
+		DaemonCommand("push-events", "push-events [enable|disable]",
+				"Enable or disable respectively with the 'enable' and 'disable' parameters the sending of the events to the client as soon as "
+				"they occur, return the status of the sending without parameter.\n"
+				"Only available to the clients of the socket given with --pipe. A pushed event is preceded by a 'Length: <size>' line, "
+				"as well as the responses sent to this client once the sending is enabled.\n"
+				"The events still remain available to the 'pop-event' command.") {
+	addExample(make_unique<DaemonCommandExample>("push-events enable",
+						"Status: Ok\n\n"
+						"State: enabled"));
+	addExample(make_unique<DaemonCommandExample>("push-events",
+						"Status: Ok\n\n"
+						"State: enabled"));
+	addExample(make_unique<DaemonCommandExample>("push-events disable",
+						"Status: Error\n"
+						"Reason: No client connected to the socket of the daemon."));
+}
+
+void PushEventsCommand::exec(Daemon *app, const string& args) {
+	string status;
+	istringstream ist(args);
+	ist >> status;
+	if (ist.fail()) {
+		bool enabled;
+		if (!app->pushEventsEnabled(enabled)) {
+			app->sendResponse(Response("No client connected to the socket of the daemon.", Response::Error));
+			return;
+		}
+		app->sendResponse(PushEventsResponse(enabled));
+		return;
+	}
+
+	bool enabled;
+	if (status.compare("enable") == 0) {
+		enabled = true;
+	} else if (status.compare("disable") == 0) {
+		enabled = false;
+	} else {
+		app->sendResponse(Response("Incorrect parameter.", Response::Error));
+		return;
+	}
+	if (!app->enablePushEvents(enabled)) {
+		app->sendResponse(Response("No client connected to the socket of the daemon.", Response::Error));
+		return;
+	}
+	app->sendResponse(PushEventsResponse(enabled));
+}
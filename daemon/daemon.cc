@@ -37,7 +37,7 @@
 #endif
 
 #ifndef _WIN32
-#include <poll.h>
+#include <sys/socket.h>
 #endif
 
 #include "daemon.h"
@@ -71,6 +71,7 @@
 #include "commands/msfilter-add-fmtp.h"
 #include "commands/play-wav.h"
 #include "commands/pop-event.h"
+#include "commands/push-events.h"
 #include "commands/port.h"
 #include "commands/ptime.h"
 #include "commands/register.h"
@@ -101,6 +102,17 @@ void usleep(int waitTime) {
 }
 #endif
 
+#ifndef _WIN32
+/*Longest sleep of the core when it has nothing to do, in milliseconds. It is shorter when the media streams need
+to be iterated.*/
+static const int IdleIterateInterval = 200;
+static const int ActiveIterateInterval = 20;
+
+/*Longest command accepted from a client, and most data waiting to be sent to a client that does not read it.*/
+static const size_t MaxCommandSize = 1024 * 1024;
+static const size_t MaxPendingOutputSize = 16 * 1024 * 1024;
+#endif
+
 #ifdef HAVE_READLINE
 #define LICENCE_GPL
 #else
@@ -303,6 +315,13 @@ bool DaemonCommand::matches(const string& name) const {
 Daemon::Daemon(const char *config_path, const char *factory_config_path, const char *log_file, const char *pipe_path, bool display_video, bool capture_video) :
 		mLSD(0), mLogFile(NULL), mAutoVideo(0), mCallIds(0), mProxyIds(0), mAudioStreamIds(0) {
 	ms_mutex_init(&mMutex, NULL);
+	ms_mutex_init(&mEventQueueMutex, NULL);
+#ifndef _WIN32
+	mMainLoop = NULL;
+	mServerSource = NULL;
+	mCurrentClient = NULL;
+	mPendingCommands = false;
+#endif
 	mServerFd = (bctbx_pipe_t)-1;
 	mChildFd = (bctbx_pipe_t)-1;
 	if (pipe_path == NULL) {
@@ -318,7 +337,8 @@ Daemon::Daemon(const char *config_path, const char *factory_config_path, const c
 	} else {
 		mServerFd = bctbx_server_pipe_create_by_path(pipe_path);
 #ifndef _WIN32
-		listen(mServerFd, 2);
+		listen(mServerFd, SOMAXCONN);
+		set_non_blocking_socket(mServerFd);
 		fprintf(stdout, "Server unix socket created, path=%s fd=%i\n", pipe_path, (int)mServerFd);
 #else
 		fprintf(stdout, "Named pipe  created, path=%s fd=%p\n", pipe_path, mServerFd);
@@ -462,6 +482,7 @@ void Daemon::initCommands() {
 	mCommands.push_back(new DtmfCommand());
 	mCommands.push_back(new PlayWavCommand());
 	mCommands.push_back(new PopEventCommand());
+	mCommands.push_back(new PushEventsCommand());
 	mCommands.push_back(new AnswerCommand());
 	mCommands.push_back(new CallStatusCommand());
 	mCommands.push_back(new CallStatsCommand());
@@ -523,6 +544,7 @@ void Daemon::uninitCommands() {
 bool Daemon::pullEvent() {
 	bool status = false;
 	ostringstream ostr;
+	ms_mutex_lock(&mEventQueueMutex);
 	size_t size = mEventQueue.size();
 
 	if (size != 0) size--;
@@ -536,6 +558,7 @@ bool Daemon::pullEvent() {
 		delete e;
 		status = true;
 	}
+	ms_mutex_unlock(&mEventQueueMutex);
 
 	sendResponse(Response(ostr.str().c_str(), Response::Ok));
 	return status;
@@ -595,7 +618,7 @@ void Daemon::iterateStreamStats() {
 			OrtpEventType evt=ortp_event_get_type(ev);
 			if (evt == ORTP_EVENT_RTCP_PACKET_RECEIVED || evt == ORTP_EVENT_RTCP_PACKET_EMITTED) {
 				linphone_call_stats_fill(it->second->stats, &it->second->stream->ms, ev);
-				if (mUseStatsEvents) mEventQueue.push(new AudioStreamStatsEvent(this,
+				if (mUseStatsEvents) queueEvent(new AudioStreamStatsEvent(this,
 					it->second->stream, it->second->stats));
 			}
 			ortp_event_destroy(ev);
@@ -606,10 +629,18 @@ void Daemon::iterateStreamStats() {
 void Daemon::iterate() {
 	linphone_core_iterate(mLc);
 	iterateStreamStats();
+#ifndef _WIN32
+	if (!mClients.empty()) return;
+#endif
 	if (mChildFd == (bctbx_pipe_t)-1) {
+		Event *r = NULL;
+		ms_mutex_lock(&mEventQueueMutex);
 		if (!mEventQueue.empty()) {
-			Event *r = mEventQueue.front();
+			r = mEventQueue.front();
 			mEventQueue.pop();
+		}
+		ms_mutex_unlock(&mEventQueueMutex);
+		if (r) {
 			fprintf(stdout, "\n%s\n", r->toBuf().c_str());
 			fflush(stdout);
 			delete r;
@@ -622,9 +653,11 @@ void Daemon::execCommand(const string &command) {
 	string name;
 	ist >> name;
 	stringbuf argsbuf;
-	ist.get(argsbuf);
+	/*the arguments of a command framed by its length may span several lines*/
+	ist.get(argsbuf, '\0');
 	string args = argsbuf.str();
 	if (!args.empty() && (args[0] == ' ')) args.erase(0, 1);
+	while (!args.empty() && (args[args.size() - 1] == '\n' || args[args.size() - 1] == '\r')) args.erase(args.size() - 1);
 	list<DaemonCommand*>::iterator it = find_if(mCommands.begin(), mCommands.end(), bind2nd(mem_fun(&DaemonCommand::matches), name));
 	if (it != mCommands.end()) {
 		ms_mutex_lock(&mMutex);
@@ -637,6 +670,12 @@ void Daemon::execCommand(const string &command) {
 
 void Daemon::sendResponse(const Response &resp) {
 	string buf = resp.toBuf();
+#ifndef _WIN32
+	if (mCurrentClient) {
+		mCurrentClient->sendResponse(mCurrentRequestId, buf);
+		return;
+	}
+#endif
 	if (mChildFd != (bctbx_pipe_t)-1) {
 		if (bctbx_pipe_write(mChildFd, (uint8_t *)buf.c_str(), (int)buf.size()) == -1) {
 			ms_error("Fail to write to pipe: %s", strerror(errno));
@@ -647,7 +686,32 @@ void Daemon::sendResponse(const Response &resp) {
 }
 
 void Daemon::queueEvent(Event *ev){
+	ms_mutex_lock(&mEventQueueMutex);
+#ifndef _WIN32
+	if (mServerSource) mEventsToPush.push_back(ev->toBuf());
+#endif
 	mEventQueue.push(ev);
+	ms_mutex_unlock(&mEventQueueMutex);
+}
+
+bool Daemon::enablePushEvents(bool enabled) {
+#ifndef _WIN32
+	if (mCurrentClient) {
+		mCurrentClient->enablePushEvents(enabled);
+		return true;
+	}
+#endif
+	return false;
+}
+
+bool Daemon::pushEventsEnabled(bool &enabled) const {
+#ifndef _WIN32
+	if (mCurrentClient) {
+		enabled = mCurrentClient->pushEventsEnabled();
+		return true;
+	}
+#endif
+	return false;
 }
 
 string Daemon::readPipe() {
@@ -673,55 +737,238 @@ string Daemon::readPipe() {
 			return buffer;
 		}
 	}
-#else
-	struct pollfd pfd[2];
-	int nfds = 1;
-	memset(&pfd[0], 0, sizeof(pfd));
-	if (mServerFd != (bctbx_pipe_t)-1) {
-		pfd[0].events = POLLIN;
-		pfd[0].fd = mServerFd;
+#endif
+	return "";
+}
+
+#ifndef _WIN32
+DaemonClient::DaemonClient(Daemon *daemon, bctbx_pipe_t fd) :
+		mDaemon(daemon), mFd(fd), mInputPos(0), mLineFramed(false), mPushEvents(false), mClosed(false) {
+	set_non_blocking_socket(mFd);
+	mSource = belle_sip_socket_source_new(onSocketEvent, this, (belle_sip_socket_t)mFd, BELLE_SIP_EVENT_READ, (unsigned int)-1);
+	belle_sip_main_loop_add_source(mDaemon->mMainLoop, mSource);
+}
+
+DaemonClient::~DaemonClient() {
+	close();
+}
+
+void DaemonClient::close() {
+	if (mClosed) return;
+	mClosed = true;
+	belle_sip_main_loop_remove_source(mDaemon->mMainLoop, mSource);
+	belle_sip_object_unref(mSource);
+	mSource = NULL;
+	bctbx_server_pipe_close_client(mFd);
+}
+
+int DaemonClient::onSocketEvent(void *data, unsigned int events) {
+	DaemonClient *client = (DaemonClient *)data;
+	if (events & BELLE_SIP_EVENT_WRITE) client->onWritable();
+	if (!client->mClosed && (events & (BELLE_SIP_EVENT_READ | BELLE_SIP_EVENT_ERROR))) client->onReadable();
+	return BELLE_SIP_CONTINUE;
+}
+
+void DaemonClient::onReadable() {
+	char buffer[32768];
+	int ret = bctbx_pipe_read(mFd, (uint8_t *)buffer, sizeof(buffer));
+	if (ret == -1) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+		ms_error("Fail to read from pipe: %s", strerror(errno));
+		close();
+		return;
 	}
-	if (mChildFd != (bctbx_pipe_t)-1) {
-		pfd[1].events = POLLIN;
-		pfd[1].fd = mChildFd;
-		nfds++;
-	}
-	int err = poll(pfd, (nfds_t)nfds, 50);
-	if (err > 0) {
-		if (mServerFd != (bctbx_pipe_t)-1 && (pfd[0].revents & POLLIN)) {
-			struct sockaddr_storage addr;
-			socklen_t addrlen = sizeof(addr);
-			int childfd = accept(mServerFd, (struct sockaddr*) &addr, &addrlen);
-			if (childfd != -1) {
-				if (mChildFd != (bctbx_pipe_t)-1) {
-					ms_error("Cannot accept two client at the same time");
-					close(childfd);
-				} else {
-					mChildFd = (bctbx_pipe_t)childfd;
-					return "";
-				}
+	if (ret == 0) {
+		ms_message("Client disconnected");
+		close();
+		return;
+	}
+	if (!mLineFramed && memchr(buffer, '\n', (size_t)ret) != NULL) mLineFramed = true;
+	mInput.append(buffer, (size_t)ret);
+	/*A client that never sent a line feed writes one command at a time.*/
+	if (!mLineFramed) mInput += '\n';
+	mDaemon->wakeUp();
+}
+
+void DaemonClient::onWritable() {
+	int ret = bctbx_pipe_write(mFd, (uint8_t *)mOutput.c_str(), (int)mOutput.size());
+	if (ret == -1) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+		ms_error("Fail to write to pipe: %s", strerror(errno));
+		close();
+		return;
+	}
+	mOutput.erase(0, (size_t)ret);
+	if (mOutput.empty()) belle_sip_source_set_events(mSource, BELLE_SIP_EVENT_READ);
+}
+
+bool DaemonClient::nextCommand(string &command, string &requestId) {
+	static const string lengthHeader("Length: ");
+	while (!mClosed) {
+		size_t end = mInput.find('\n', mInputPos);
+		if (end == string::npos) break;
+		if (mInput.compare(mInputPos, lengthHeader.size(), lengthHeader) == 0) {
+			char *lengthEnd = NULL;
+			unsigned long length = strtoul(mInput.c_str() + mInputPos + lengthHeader.size(), &lengthEnd, 10);
+			if (lengthEnd != mInput.c_str() + end || length > MaxCommandSize) {
+				ms_error("Invalid command length from client, disconnecting it.");
+				close();
+				return false;
 			}
+			if (mInput.size() - (end + 1) < length) break;
+			command.assign(mInput, end + 1, length);
+			mInputPos = end + 1 + length;
+		} else {
+			command.assign(mInput, mInputPos, end - mInputPos);
+			mInputPos = end + 1;
+			if (!command.empty() && command[command.size() - 1] == '\r') command.erase(command.size() - 1);
+			if (command.empty()) continue;
 		}
-		if (mChildFd != (bctbx_pipe_t)-1 && (pfd[1].revents & POLLIN)) {
-			int ret;
-			if ((ret = bctbx_pipe_read(mChildFd, (uint8_t *)buffer, sizeof(buffer))) == -1) {
-				ms_error("Fail to read from pipe: %s", strerror(errno));
-			} else {
-				if (ret == 0) {
-					ms_message("Client disconnected");
-					bctbx_server_pipe_close_client(mChildFd);
-					mChildFd = (bctbx_pipe_t)-1;
-					return "";
-				}
-				buffer[ret] = '\0';
-				return buffer;
-			}
+
+		requestId.clear();
+		if (command[0] == '#') {
+			size_t space = command.find(' ');
+			requestId = command.substr(1, space == string::npos ? string::npos : space - 1);
+			command.erase(0, space == string::npos ? command.size() : space + 1);
+		}
+		return true;
+	}
+
+	/*Only keep the incomplete command.*/
+	mInput.erase(0, mInputPos);
+	mInputPos = 0;
+	if (mInput.size() > MaxCommandSize + lengthHeader.size() + 32) {
+		ms_error("Too long command from client, disconnecting it.");
+		close();
+	}
+	return false;
+}
+
+void DaemonClient::sendResponse(const string &requestId, const string &buf) {
+	/*Once the events are pushed, the responses need to be delimited as well.*/
+	if (requestId.empty() && !mPushEvents) {
+		send(buf);
+		return;
+	}
+	ostringstream ostr;
+	if (!requestId.empty()) ostr << "Request-Id: " << requestId << "\n";
+	ostr << "Length: " << buf.size() << "\n" << buf;
+	send(ostr.str());
+}
+
+void DaemonClient::sendEvent(const string &buf) {
+	ostringstream ostr;
+	ostr << "Length: " << buf.size() << "\n" << buf;
+	send(ostr.str());
+}
+
+void DaemonClient::send(const string &buf) {
+	if (mClosed) return;
+	if (!mOutput.empty()) {
+		if (mOutput.size() + buf.size() > MaxPendingOutputSize) {
+			ms_error("Client does not read what is sent to it, disconnecting it.");
+			close();
+			return;
+		}
+		mOutput += buf;
+		return;
+	}
+	int ret = bctbx_pipe_write(mFd, (uint8_t *)buf.c_str(), (int)buf.size());
+	if (ret == -1) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			ms_error("Fail to write to pipe: %s", strerror(errno));
+			close();
+			return;
+		}
+		ret = 0;
+	}
+	if ((size_t)ret < buf.size()) {
+		mOutput.assign(buf, (size_t)ret, string::npos);
+		belle_sip_source_set_events(mSource, BELLE_SIP_EVENT_READ | BELLE_SIP_EVENT_WRITE);
+	}
+}
+
+int Daemon::onServerSocketEvent(void *data, unsigned int events) {
+	Daemon *app = (Daemon *)data;
+	app->acceptClient();
+	return BELLE_SIP_CONTINUE;
+}
+
+void Daemon::acceptClient() {
+	struct sockaddr_storage addr;
+	socklen_t addrlen = sizeof(addr);
+	int childfd = accept(mServerFd, (struct sockaddr*) &addr, &addrlen);
+	if (childfd == -1) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) ms_error("Fail to accept client: %s", strerror(errno));
+		return;
+	}
+	mClients.emplace_back(new DaemonClient(this, (bctbx_pipe_t)childfd));
+	ms_message("Client accepted, %u client(s) connected", (unsigned int)mClients.size());
+}
+
+void Daemon::wakeUp() {
+	mPendingCommands = true;
+	belle_sip_main_loop_quit(mMainLoop);
+}
+
+void Daemon::execClientCommands() {
+	mPendingCommands = false;
+	for (list<unique_ptr<DaemonClient>>::iterator it = mClients.begin(); it != mClients.end();) {
+		DaemonClient *client = it->get();
+		string command;
+		string requestId;
+		while (mRunning && client->nextCommand(command, requestId)) {
+			mCurrentClient = client;
+			mCurrentRequestId = requestId;
+			execCommand(command);
+			mCurrentClient = NULL;
+			mCurrentRequestId.clear();
+		}
+		if (client->isClosed()) {
+			it = mClients.erase(it);
+		} else {
+			++it;
 		}
 	}
-#endif
-	return "";
 }
 
+void Daemon::pushEvents() {
+	list<string> events;
+	ms_mutex_lock(&mEventQueueMutex);
+	events.swap(mEventsToPush);
+	ms_mutex_unlock(&mEventQueueMutex);
+	for (const auto &client : mClients) {
+		if (!client->pushEventsEnabled()) continue;
+		for (const auto &event : events) {
+			client->sendEvent(event);
+		}
+	}
+}
+
+/*Everything runs in the thread of the core: the sockets of the clients are sources of the main loop of the core, that
+is left as soon as a command is received.*/
+int Daemon::runServer() {
+	mMainLoop = belle_sip_stack_get_main_loop((belle_sip_stack_t *)mLc->sal->getStackImpl());
+	mServerSource = belle_sip_socket_source_new(onServerSocketEvent, this, (belle_sip_socket_t)mServerFd, BELLE_SIP_EVENT_READ, (unsigned int)-1);
+	belle_sip_main_loop_add_source(mMainLoop, mServerSource);
+
+	while (mRunning) {
+		execClientCommands();
+		iterate();
+		pushEvents();
+		if (!mRunning || mPendingCommands) continue;
+		belle_sip_main_loop_sleep(mMainLoop,
+			(linphone_core_get_calls_nb(mLc) > 0 || !mAudioStreams.empty()) ? ActiveIterateInterval : IdleIterateInterval);
+	}
+
+	mClients.clear();
+	belle_sip_main_loop_remove_source(mMainLoop, mServerSource);
+	belle_sip_object_unref(mServerSource);
+	mServerSource = NULL;
+	return 0;
+}
+#endif
+
 void Daemon::dumpCommandsHelp() {
 	int cols = 80;
 #ifdef TIOCGSIZE
@@ -812,7 +1059,7 @@ static void printHelp() {
 		"\t--help                     Print this notice." << endl <<
 		"\t--dump-commands-help       Dump the help of every available commands." << endl <<
 		"\t--dump-commands-html-help  Dump the help of every available commands." << endl <<
-		"\t--pipe <pipepath>          Create an unix server socket in the specified path to receive commands from. For Windows just use a name instead of a path." << endl <<
+		"\t--pipe <pipepath>          Create an unix server socket in the specified path to receive commands from, several clients can be connected at the same time. For Windows just use a name instead of a path." << endl <<
 		"\t--log <path>               Supply a file where the log will be saved." << endl <<
 		"\t--factory-config <path>    Supply a readonly linphonerc style config file to start with." << endl <<
 		"\t--config <path>            Supply a linphonerc style config file to start with." << endl <<
@@ -852,6 +1099,9 @@ string Daemon::readLine(const string& prompt, bool *eof) {
 int Daemon::run() {
 	const string prompt("daemon-linphone>");
 	mRunning = true;
+#ifndef _WIN32
+	if (mServerFd != (bctbx_pipe_t)-1) return runServer();
+#endif
 	startThread();
 	while (mRunning) {
 		string line;
@@ -924,6 +1174,13 @@ Daemon::~Daemon() {
 		fclose(mLogFile);
 	}
 
+	ms_mutex_lock(&mEventQueueMutex);
+	while (!mEventQueue.empty()) {
+		delete mEventQueue.front();
+		mEventQueue.pop();
+	}
+	ms_mutex_unlock(&mEventQueueMutex);
+	ms_mutex_destroy(&mEventQueueMutex);
 	ms_mutex_destroy(&mMutex);
 
 #ifdef HAVE_READLINE
@@ -1015,6 +1272,10 @@ int main(int argc, char *argv[]) {
 
 	the_app = &app;
 	signal(SIGINT, sighandler);
+#ifndef _WIN32
+	/*a client may disconnect before reading its responses*/
+	signal(SIGPIPE, SIG_IGN);
+#endif
 	app.enableStatsEvents(stats_enabled);
 	app.enableLSD(lsd_enabled);
 	app.enableAutoAnswer(auto_answer);
@@ -25,11 +25,13 @@
 #include <mediastreamer2/mediastream.h>
 #include <mediastreamer2/mscommon.h>
 #include <bctoolbox/list.h>
+#include <belle-sip/belle-sip.h>
 
 #include <string>
 #include <list>
 #include <queue>
 #include <map>
+#include <memory>
 #include <sstream>
 
 #ifdef HAVE_CONFIG_H
@@ -238,8 +240,52 @@ struct AudioStreamAndOther {
 	}
 };
 
+#ifndef _WIN32
+/*A client connected to the unix socket of the daemon (--pipe), several of them can be connected at the same time.
+Its commands are either terminated by a line feed, or preceded by a "Length: <size>" line, so that several of them can be
+sent without waiting for the responses. A command prefixed by "#<request id> " gets a response starting with a
+"Request-Id: <request id>" line and a "Length: <size>" line. For compatibility, a client that never sent a line feed
+sends exactly one command per write.*/
+class DaemonClient {
+public:
+	DaemonClient(Daemon *daemon, bctbx_pipe_t fd);
+	~DaemonClient();
+	bool isClosed() const {
+		return mClosed;
+	}
+	bool pushEventsEnabled() const {
+		return mPushEvents;
+	}
+	void enablePushEvents(bool enabled) {
+		mPushEvents = enabled;
+	}
+	/*Extract the next complete command, return false if there is none.*/
+	bool nextCommand(std::string &command, std::string &requestId);
+	void sendResponse(const std::string &requestId, const std::string &buf);
+	void sendEvent(const std::string &buf);
+	void close();
+
+private:
+	static int onSocketEvent(void *data, unsigned int events);
+	void onReadable();
+	void onWritable();
+	void send(const std::string &buf);
+
+	Daemon *mDaemon;
+	bctbx_pipe_t mFd;
+	belle_sip_source_t *mSource;
+	std::string mInput;
+	size_t mInputPos; /*beginning of the commands not extracted yet in mInput*/
+	std::string mOutput; /*what could not be written yet because the socket was full*/
+	bool mLineFramed;
+	bool mPushEvents;
+	bool mClosed;
+};
+#endif
+
 class Daemon {
 	friend class DaemonCommand;
+	friend class DaemonClient;
 public:
 	typedef Response::Status Status;
 	Daemon(const char *config_path, const char *factory_config_path, const char *log_file, const char *pipe_path, bool display_video, bool capture_video);
@@ -271,6 +317,9 @@ public:
 	void callPlayingComplete(int id);
 	void setAutoVideo( bool enabled ){ mAutoVideo = enabled; }
 	inline bool autoVideo(){ return mAutoVideo; }
+	/*Apply to the client whose command is being executed, return false if there is none.*/
+	bool enablePushEvents(bool enabled);
+	bool pushEventsEnabled(bool &enabled) const;
 
 private:
 	static void* iterateThread(void *arg);
@@ -286,6 +335,14 @@ private:
 	void execCommand(const std::string &command);
 	std::string readLine(const std::string&, bool*);
 	std::string readPipe();
+#ifndef _WIN32
+	int runServer();
+	static int onServerSocketEvent(void *data, unsigned int events);
+	void acceptClient();
+	void execClientCommands();
+	void pushEvents();
+	void wakeUp();
+#endif
 	void iterate();
 	void iterateStreamStats();
 	void startThread();
@@ -296,8 +353,18 @@ private:
 	LinphoneSoundDaemon *mLSD;
 	std::list<DaemonCommand*> mCommands;
 	std::queue<Event*> mEventQueue;
+	std::list<std::string> mEventsToPush;
+	ms_mutex_t mEventQueueMutex; /*events can be queued from other threads than the one of the core*/
 	ortp_pipe_t mServerFd;
 	ortp_pipe_t mChildFd;
+#ifndef _WIN32
+	belle_sip_main_loop_t *mMainLoop;
+	belle_sip_source_t *mServerSource;
+	std::list<std::unique_ptr<DaemonClient>> mClients;
+	DaemonClient *mCurrentClient; /*client whose command is being executed*/
+	std::string mCurrentRequestId;
+	bool mPendingCommands;
+#endif
 	std::string mHistfile;
 	bool mRunning;
 	bool mUseStatsEvents;
@@ -272,6 +272,16 @@ LINPHONE_PUBLIC bctbx_list_t *linphone_chat_room_get_history_message_events (Lin
  */
 LINPHONE_PUBLIC bctbx_list_t *linphone_chat_room_get_history_range_message_events (LinphoneChatRoom *chat_room, int begin, int end);
 
+/**
+ * Gets the chat message events older than the given one, sorted from oldest to most recent.
+ * Unlike #linphone_chat_room_get_history_range_message_events(), the time needed to get a page doesn't depend on its position in the history.
+ * @param chat_room The #LinphoneChatRoom object corresponding to the conversation for which events should be retrieved @notnil
+ * @param event_log The oldest event already retrieved, NULL to get the most recent events. @maybenil
+ * @param nb_events Number of events to retrieve. 0 means everything.
+ * @return The list of chat message events. \bctbx_list{LinphoneEventLog} @tobefreed
+ */
+LINPHONE_PUBLIC bctbx_list_t *linphone_chat_room_get_history_message_events_before (LinphoneChatRoom *chat_room, const LinphoneEventLog *event_log, int nb_events);
+
 /**
  * Gets nb_events most recent events from chat_room chat room, sorted from oldest to most recent.
  * @param chat_room The #LinphoneChatRoom object corresponding to the conversation for which events should be retrieved @notnil
@@ -289,6 +299,16 @@ LINPHONE_PUBLIC bctbx_list_t *linphone_chat_room_get_history_events (LinphoneCha
  */
 LINPHONE_PUBLIC bctbx_list_t *linphone_chat_room_get_history_range_events (LinphoneChatRoom *chat_room, int begin, int end);
 
+/**
+ * Gets the events older than the given one, sorted from oldest to most recent.
+ * Unlike #linphone_chat_room_get_history_range_events(), the time needed to get a page doesn't depend on its position in the history.
+ * @param chat_room The #LinphoneChatRoom object corresponding to the conversation for which events should be retrieved @notnil
+ * @param event_log The oldest event already retrieved, NULL to get the most recent events. @maybenil
+ * @param nb_events Number of events to retrieve. 0 means everything.
+ * @return The list of the found events. \bctbx_list{LinphoneEventLog} @tobefreed
+ */
+LINPHONE_PUBLIC bctbx_list_t *linphone_chat_room_get_history_events_before (LinphoneChatRoom *chat_room, const LinphoneEventLog *event_log, int nb_events);
+
 /**
  * Gets the number of events in a chat room.
  * @param chat_room The #LinphoneChatRoom object corresponding to the conversation for which size has to be computed @notnil
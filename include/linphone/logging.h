@@ -59,6 +59,14 @@ typedef enum _LinphoneLogLevel {
 	LinphoneLogLevelFatal   = 1<<5  /**< @brief Level for fatal error messages. */
 } LinphoneLogLevel;
 
+/**
+ * @brief What happens to a log message written while the buffer of the asynchronous output is full.
+ */
+typedef enum _LinphoneLogOverflowPolicy {
+	LinphoneLogOverflowPolicyDrop  = 0, /**< @brief The message is lost and counted, the logging thread never waits. */
+	LinphoneLogOverflowPolicyBlock = 1  /**< @brief The logging thread waits for the output to catch up. */
+} LinphoneLogOverflowPolicy;
+
 /**
  * @brief Type of callbacks called each time liblinphone write a log message.
  * 
@@ -152,6 +160,56 @@ LINPHONE_PUBLIC unsigned int linphone_logging_service_get_log_level_mask(const L
  */
 LINPHONE_PUBLIC void linphone_logging_service_set_log_file(const LinphoneLoggingService *log_service, const char *dir, const char *filename, size_t max_size);
 
+/**
+ * @brief Enables an output where log messages are written by a dedicated thread.
+ * 
+ * Logging threads only format their messages into a bounded buffer, the output thread writes them
+ * in batches. A fatal message is written and flushed before returning to the logging thread.
+ * It replaces a previously enabled asynchronous output, as well as the default output on stdout or the handler set with
+ * linphone_core_set_log_handler(), which is restored by linphone_logging_service_disable_async_output().
+ * The callbacks of the #LinphoneLoggingServiceCbs are still called by the logging thread.
+ * 
+ * @param log_service the #LinphoneLoggingService object @notnil
+ * @param path Path of the file where the messages are appended, stdout is used if NULL. @maybenil
+ * @param capacity Maximum number of messages waiting to be written.
+ * @param policy The #LinphoneLogOverflowPolicy applied when capacity messages are already waiting.
+ * @return 0 if successful, -1 if the file can't be opened.
+ */
+LINPHONE_PUBLIC int linphone_logging_service_enable_async_output(LinphoneLoggingService *log_service, const char *path, unsigned int capacity, LinphoneLogOverflowPolicy policy);
+
+/**
+ * @brief Writes the pending messages and disables the asynchronous output, restoring the output it replaced.
+ * @param log_service the #LinphoneLoggingService object @notnil
+ */
+LINPHONE_PUBLIC void linphone_logging_service_disable_async_output(LinphoneLoggingService *log_service);
+
+/**
+ * @brief Tells whether the asynchronous output is enabled.
+ * @param log_service the #LinphoneLoggingService object @notnil
+ * @return TRUE if linphone_logging_service_enable_async_output() succeeded, FALSE otherwise.
+ */
+LINPHONE_PUBLIC bool_t linphone_logging_service_async_output_enabled(const LinphoneLoggingService *log_service);
+
+/**
+ * @brief Waits until the messages written before the call are flushed by the asynchronous output, if enabled.
+ * @param log_service the #LinphoneLoggingService object @notnil
+ */
+LINPHONE_PUBLIC void linphone_logging_service_flush(LinphoneLoggingService *log_service);
+
+/**
+ * @brief Gets the number of messages written by the asynchronous output since it was enabled.
+ * @param log_service the #LinphoneLoggingService object @notnil
+ * @return The number of written messages.
+ */
+LINPHONE_PUBLIC uint64_t linphone_logging_service_get_async_written_count(const LinphoneLoggingService *log_service);
+
+/**
+ * @brief Gets the number of messages lost by the asynchronous output because its buffer was full.
+ * @param log_service the #LinphoneLoggingService object @notnil
+ * @return The number of dropped messages, always 0 with #LinphoneLogOverflowPolicyBlock.
+ */
+LINPHONE_PUBLIC uint64_t linphone_logging_service_get_async_dropped_count(const LinphoneLoggingService *log_service);
+
 /**
  * @brief Set the domain where application logs are written (for example with #linphone_logging_service_message()).
  * @param log_service the #LinphoneLoggingService object @notnil
@@ -17,14 +17,14 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <set>
-#include <unordered_map>
+#include <mutex>
 
 #include <belr/abnf.h>
 #include <belr/grammarbuilder.h>
 
 #include "linphone/utils/utils.h"
 
+#include "containers/lru-cache.h"
 #include "logger/logger.h"
 #include "object/object-p.h"
 
@@ -38,6 +38,94 @@ LINPHONE_BEGIN_NAMESPACE
 
 namespace {
 	string IdentityGrammar("identity_grammar");
+
+	bool isAlphaNum (char c) {
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+	}
+
+	bool isUserChar (char c) {
+		return isAlphaNum(c) || c == '-' || c == '_' || c == '.' || c == '!' || c == '~' || c == '*' || c == '\''
+			|| c == '(' || c == ')' || c == '+';
+	}
+
+	bool isGruuChar (char c) {
+		return isAlphaNum(c) || c == '-' || c == ':' || c == '.' || c == '_';
+	}
+
+	// Hostname made of alphanumeric labels which may contain hyphens, the top label starting with a letter.
+	bool isHostname (const string &input, size_t begin, size_t end) {
+		if (begin == end)
+			return false;
+		size_t labelBegin = begin;
+		for (size_t i = begin; i <= end; ++i) {
+			if (i != end && input[i] != '.') {
+				if (!isAlphaNum(input[i]) && input[i] != '-')
+					return false;
+				continue;
+			}
+			if (i == labelBegin || !isAlphaNum(input[labelBegin]) || !isAlphaNum(input[i - 1]))
+				return false;
+			if (i == end && input[labelBegin] >= '0' && input[labelBegin] <= '9')
+				return false;
+			labelBegin = i + 1;
+		}
+		return true;
+	}
+
+	// Parses the usual "sip:user@host;gr=urn:uuid:..." addresses without the grammar.
+	// Returns nullptr for anything else (escaped characters, ports, IP addresses...), which is left to the grammar.
+	shared_ptr<IdentityAddress> parseCommonAddress (const string &input) {
+		size_t pos;
+		string scheme;
+		if (input.compare(0, 4, "sip:") == 0) {
+			scheme = "sip";
+			pos = 4;
+		} else if (input.compare(0, 5, "sips:") == 0) {
+			scheme = "sips";
+			pos = 5;
+		} else
+			return nullptr;
+
+		size_t hostBegin = pos;
+		size_t at = input.find('@', pos);
+		if (at != string::npos) {
+			if (at == pos)
+				return nullptr;
+			for (size_t i = pos; i < at; ++i) {
+				if (!isUserChar(input[i]))
+					return nullptr;
+			}
+			hostBegin = at + 1;
+		}
+
+		static const string GruuParameter(";gr=");
+		size_t hostEnd = input.find(';', hostBegin);
+		size_t gruuBegin = string::npos;
+		if (hostEnd == string::npos)
+			hostEnd = input.size();
+		else {
+			if (input.compare(hostEnd, GruuParameter.size(), GruuParameter) != 0)
+				return nullptr;
+			gruuBegin = hostEnd + GruuParameter.size();
+			if (gruuBegin == input.size())
+				return nullptr;
+			for (size_t i = gruuBegin; i < input.size(); ++i) {
+				if (!isGruuChar(input[i]))
+					return nullptr;
+			}
+		}
+		if (!isHostname(input, hostBegin, hostEnd))
+			return nullptr;
+
+		shared_ptr<IdentityAddress> identityAddress = make_shared<IdentityAddress>();
+		identityAddress->setScheme(scheme);
+		if (at != string::npos)
+			identityAddress->setUsername(input.substr(pos, at - pos));
+		identityAddress->setDomain(input.substr(hostBegin, hostEnd - hostBegin));
+		if (gruuBegin != string::npos)
+			identityAddress->setGruu(input.substr(gruuBegin));
+		return identityAddress;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -45,7 +133,10 @@ namespace {
 class IdentityAddressParserPrivate : public ObjectPrivate {
 public:
 	shared_ptr<belr::Parser<shared_ptr<IdentityAddress> >> parser;
-    unordered_map<string, shared_ptr<IdentityAddress >> cache;
+
+	mutable mutex cacheMutex;
+	LruCache<string, shared_ptr<IdentityAddress>> cache = LruCache<string, shared_ptr<IdentityAddress>>(IdentityAddressParser::DefaultCacheCapacity);
+	IdentityAddressParser::CacheStats stats;
 };
 
 IdentityAddressParser::IdentityAddressParser () : Singleton(*new IdentityAddressParserPrivate) {
@@ -68,21 +159,51 @@ IdentityAddressParser::IdentityAddressParser () : Singleton(*new IdentityAddress
 shared_ptr<IdentityAddress> IdentityAddressParser::parseAddress (const string &input) {
 	L_D();
 
-    auto it = d->cache.find(input);
-    if (it == d->cache.end()) {
-        size_t parsedSize;
-        shared_ptr<IdentityAddress> identityAddress = d->parser->parseInput("Address", input, &parsedSize);
-        if (!identityAddress) {
-            lDebug() << "Unable to parse identity address from " << input;
-            return nullptr;
-        }
-        // Remove identity address from leak detector as the IdentityAddressParser is a used as static variable
-        identityAddress->removeFromLeakDetector();
-        d->cache[input] = identityAddress;
-        return identityAddress;
-    } else {
-        return it->second;
-    }
+	lock_guard<mutex> lock(d->cacheMutex);
+	shared_ptr<IdentityAddress> *cached = d->cache.use(input);
+	if (cached) {
+		d->stats.hits++;
+		return *cached;
+	}
+
+	d->stats.misses++;
+	shared_ptr<IdentityAddress> identityAddress = parseCommonAddress(input);
+	if (identityAddress)
+		d->stats.fastParses++;
+	else {
+		size_t parsedSize;
+		identityAddress = d->parser->parseInput("Address", input, &parsedSize);
+		if (!identityAddress) {
+			lDebug() << "Unable to parse identity address from " << input;
+			return nullptr;
+		}
+	}
+	// Remove identity address from leak detector as the IdentityAddressParser is a used as static variable
+	identityAddress->removeFromLeakDetector();
+	d->cache.insert(input, identityAddress);
+	return identityAddress;
+}
+
+void IdentityAddressParser::setCacheCapacity (int capacity) {
+	L_D();
+	lock_guard<mutex> lock(d->cacheMutex);
+	d->cache.setCapacity(capacity);
+}
+
+IdentityAddressParser::CacheStats IdentityAddressParser::getCacheStats () const {
+	L_D();
+	lock_guard<mutex> lock(d->cacheMutex);
+	CacheStats stats = d->stats;
+	stats.size = d->cache.getSize();
+	stats.capacity = d->cache.getCapacity();
+	return stats;
+}
+
+void IdentityAddressParser::clearCache () {
+	L_D();
+	lock_guard<mutex> lock(d->cacheMutex);
+	d->cache.clear();
+	d->stats = CacheStats();
 }
 
 LINPHONE_END_NAMESPACE
@@ -33,8 +33,23 @@ class IdentityAddressParser : public Singleton<IdentityAddressParser> {
 	friend class Singleton<IdentityAddressParser>;
 
 public:
+	struct CacheStats {
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t fastParses = 0; // Misses parsed without the grammar.
+		int size = 0;
+		int capacity = 0;
+	};
+
+	// Parsed addresses are kept in a LRU cache, can be called from any thread.
 	std::shared_ptr<IdentityAddress> parseAddress (const std::string &input);
 
+	void setCacheCapacity (int capacity);
+	CacheStats getCacheStats () const;
+	void clearCache ();
+
+	static constexpr int DefaultCacheCapacity = 10000;
+
 private:
 	IdentityAddressParser ();
 
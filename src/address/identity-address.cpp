@@ -17,6 +17,9 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cctype>
+#include <cstring>
+
 #include <belle-sip/utils.h>
 #include "linphone/utils/utils.h"
 
@@ -32,6 +35,42 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+namespace {
+	// FNV-1a, over the fields of the SalAddress: no string is built to hash or to compare an address.
+	constexpr size_t FnvOffsetBasis = size_t(sizeof(size_t) == 8 ? 14695981039346656037ULL : 2166136261ULL);
+	constexpr size_t FnvPrime = size_t(sizeof(size_t) == 8 ? 1099511628211ULL : 16777619ULL);
+
+	inline size_t hashField (size_t hash, const char *value, bool ignoreCase = false) {
+		if (value) {
+			for (; *value; ++value) {
+				const unsigned char c = static_cast<unsigned char>(*value);
+				hash ^= ignoreCase ? static_cast<unsigned char>(tolower(c)) : c;
+				hash *= FnvPrime;
+			}
+		}
+		// Field separator, so that ("ab", "c") and ("a", "bc") do not collide.
+		hash ^= 0xff;
+		hash *= FnvPrime;
+		return hash;
+	}
+
+	inline bool equalFields (const char *value1, const char *value2) {
+		return strcmp(value1 ? value1 : "", value2 ? value2 : "") == 0;
+	}
+
+	inline const char *getSalUsername (const SalAddress *address) {
+		return address ? sal_address_get_username(address) : nullptr;
+	}
+
+	inline const char *getSalDomain (const SalAddress *address) {
+		return address ? sal_address_get_domain(address) : nullptr;
+	}
+
+	inline const char *getSalGruu (const SalAddress *address) {
+		return address ? sal_address_get_uri_param(address, "gr") : nullptr;
+	}
+}
+
 // -----------------------------------------------------------------------------
 
 IdentityAddress::IdentityAddress (const string &address) {
@@ -66,7 +105,8 @@ void IdentityAddress::fillFromAddress(const Address &address) {
 	}
 }
 
-IdentityAddress::IdentityAddress (const IdentityAddress &other) : Address(other) {
+IdentityAddress::IdentityAddress (const IdentityAddress &other) : Address(other),
+	mHash(other.mHash), mHashComputed(other.mHashComputed) {
 
 }
 
@@ -77,13 +117,22 @@ IdentityAddress::IdentityAddress () {
 IdentityAddress &IdentityAddress::operator= (const IdentityAddress &other) {
 	if (this != &other) {
 		Address::operator= (other);
+		mHash = other.mHash;
+		mHashComputed = other.mHashComputed;
 	}
 	return *this;
 }
 
 bool IdentityAddress::operator== (const IdentityAddress &other) const {
+	if (mHashComputed && other.mHashComputed && mHash != other.mHash)
+		return false;
+
 	/* Scheme is not used for comparison. sip:toto@sip.linphone.org and sips:toto@sip.linphone.org refer to the same person. */
-	return getUsername() == other.getUsername() && getDomain() == other.getDomain() && getGruu() == other.getGruu();
+	const SalAddress *address = internalAddress;
+	const SalAddress *otherAddress = other.internalAddress;
+	return equalFields(getSalUsername(address), getSalUsername(otherAddress))
+		&& equalFields(getSalDomain(address), getSalDomain(otherAddress))
+		&& equalFields(getSalGruu(address), getSalGruu(otherAddress));
 }
 
 bool IdentityAddress::operator!= (const IdentityAddress &other) const {
@@ -119,6 +168,7 @@ const string &IdentityAddress::getUsername () const {
 
 void IdentityAddress::setUsername (const string &username) {
 	Address::setUsername(username);
+	resetHash();
 }
 
 const string &IdentityAddress::getDomain () const {
@@ -127,6 +177,7 @@ const string &IdentityAddress::getDomain () const {
 
 void IdentityAddress::setDomain (const string &domain) {
 	Address::setDomain(domain);
+	resetHash();
 }
 
 bool IdentityAddress::hasGruu () const {
@@ -143,6 +194,7 @@ void IdentityAddress::setGruu (const string &gruu) {
 	} else {
 		setUriParam("gr",gruu);
 	}
+	resetHash();
 }
 
 IdentityAddress IdentityAddress::getAddressWithoutGruu () const {
@@ -176,6 +228,24 @@ const Address & IdentityAddress::asAddress() const {
 	return *this;
 }
 
+size_t IdentityAddress::getHash () const {
+	if (!mHashComputed) {
+		const SalAddress *address = internalAddress;
+		size_t hash = FnvOffsetBasis;
+		hash = hashField(hash, getSalUsername(address));
+		// The domain is not case sensitive for ConferenceAddress::operator==, which compares the uris.
+		hash = hashField(hash, getSalDomain(address), true);
+		hash = hashField(hash, getSalGruu(address));
+		mHash = hash;
+		mHashComputed = true;
+	}
+	return mHash;
+}
+
+void IdentityAddress::resetHash () {
+	mHashComputed = false;
+}
+
 void IdentityAddress::removeFromLeakDetector() const {
 	Address::removeFromLeakDetector();
 }
@@ -186,7 +256,7 @@ ConferenceAddress::ConferenceAddress (const Address &address) :IdentityAddress(a
 ConferenceAddress::ConferenceAddress (const std::string &address) : ConferenceAddress(Address(address)) {
 }
 ConferenceAddress::ConferenceAddress (const ConferenceAddress &other) :IdentityAddress(other) {
-	fillUriParams(other);
+	// The uri parameters are copied with the SalAddress.
 }
 
 ConferenceAddress::ConferenceAddress (const IdentityAddress &other) :IdentityAddress(other) {
@@ -194,13 +264,16 @@ ConferenceAddress::ConferenceAddress (const IdentityAddress &other) :IdentityAdd
 }
 ConferenceAddress &ConferenceAddress::operator= (const ConferenceAddress &other) {
 	if (this != &other) {
+		// The uri parameters are copied with the SalAddress.
 		IdentityAddress::operator=(other);
-		fillUriParams(other);
 	}
 	return *this;
 }
 
 bool ConferenceAddress::operator== (const ConferenceAddress &other) const {
+	// Addresses which are not equal as identity addresses can't be equal as conference addresses.
+	if (mHashComputed && other.mHashComputed && mHash != other.mHash)
+		return false;
 	return Address::operator==(other);
 }
 
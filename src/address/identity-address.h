@@ -70,11 +70,19 @@ public:
 
 	const Address & asAddress() const;
 
+	// Hash of the fields compared by operator==, computed on first use and kept until the address is modified.
+	std::size_t getHash () const;
+
 	// This method is necessary when creating static variables of type address as they canot be freed before the leak detector runs
 	void removeFromLeakDetector() const;
 
+protected:
+	mutable std::size_t mHash = 0;
+	mutable bool mHashComputed = false;
+
 private:
 	void fillFromAddress(const Address &address);
+	void resetHash ();
 };
 
 inline std::ostream &operator<< (std::ostream &os, const IdentityAddress &identityAddress) {
@@ -127,8 +135,7 @@ namespace std {
 	template<>
 	struct hash<LinphonePrivate::IdentityAddress> {
 		std::size_t operator() (const LinphonePrivate::IdentityAddress &identityAddress) const {
-			if (!identityAddress.isValid()) return std::size_t(-1);
-			return hash<string>()(identityAddress.asString());
+			return identityAddress.getHash();
 		}
 	};
 }
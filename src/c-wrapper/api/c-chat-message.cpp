@@ -369,7 +369,7 @@ void linphone_chat_message_add_file_content (LinphoneChatMessage *msg, LinphoneC
 
 	fileContent->setFileSize(linphone_content_get_size(c_content));
 	fileContent->setFileDuration(linphone_content_get_file_duration(c_content));
-	fileContent->setBody(content->getBody());
+	fileContent->setBody(content->getSharedBody());
 	fileContent->setUserData(content->getUserData());
 
 	L_GET_CPP_PTR_FROM_C_OBJECT(msg)->addContent(fileContent);
@@ -401,7 +401,7 @@ void linphone_chat_message_add_content (LinphoneChatMessage *msg, LinphoneConten
 		LinphonePrivate::Content *content = L_GET_CPP_PTR_FROM_C_OBJECT(c_content);
 		LinphonePrivate::Content *cppContent = new LinphonePrivate::Content();
 		cppContent->setContentType(content->getContentType());
-		cppContent->setBody(content->getBody());
+		cppContent->setBody(content->getSharedBody());
 		cppContent->setUserData(content->getUserData());
 		L_GET_CPP_PTR_FROM_C_OBJECT(msg)->addContent(cppContent);
 	}
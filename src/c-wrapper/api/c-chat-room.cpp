@@ -301,6 +301,11 @@ bctbx_list_t *linphone_chat_room_get_history_range_message_events (LinphoneChatR
 	return L_GET_RESOLVED_C_LIST_FROM_CPP_LIST(L_GET_CPP_PTR_FROM_C_OBJECT(cr)->getMessageHistoryRange(startm, endm));
 }
 
+bctbx_list_t *linphone_chat_room_get_history_message_events_before (LinphoneChatRoom *cr, const LinphoneEventLog *event_log, int nb_events) {
+	shared_ptr<const LinphonePrivate::EventLog> lastEventLog = event_log ? L_GET_CPP_PTR_FROM_C_OBJECT(event_log) : nullptr;
+	return L_GET_RESOLVED_C_LIST_FROM_CPP_LIST(L_GET_CPP_PTR_FROM_C_OBJECT(cr)->getMessageHistoryBefore(lastEventLog, nb_events));
+}
+
 bctbx_list_t *linphone_chat_room_get_history_message_events (LinphoneChatRoom *cr, int nb_events) {
 	return L_GET_RESOLVED_C_LIST_FROM_CPP_LIST(L_GET_CPP_PTR_FROM_C_OBJECT(cr)->getMessageHistory(nb_events));
 }
@@ -313,6 +318,11 @@ bctbx_list_t *linphone_chat_room_get_history_range_events (LinphoneChatRoom *cr,
 	return L_GET_RESOLVED_C_LIST_FROM_CPP_LIST(L_GET_CPP_PTR_FROM_C_OBJECT(cr)->getHistoryRange(begin, end));
 }
 
+bctbx_list_t *linphone_chat_room_get_history_events_before (LinphoneChatRoom *cr, const LinphoneEventLog *event_log, int nb_events) {
+	shared_ptr<const LinphonePrivate::EventLog> lastEventLog = event_log ? L_GET_CPP_PTR_FROM_C_OBJECT(event_log) : nullptr;
+	return L_GET_RESOLVED_C_LIST_FROM_CPP_LIST(L_GET_CPP_PTR_FROM_C_OBJECT(cr)->getHistoryBefore(lastEventLog, nb_events));
+}
+
 int linphone_chat_room_get_history_events_size(LinphoneChatRoom *cr) {
 	return L_GET_CPP_PTR_FROM_C_OBJECT(cr)->getHistorySize();
 }
@@ -50,6 +50,7 @@ L_DECLARE_C_CLONABLE_OBJECT_IMPL_WITH_XTORS(Content,
 		string type;
 		string subtype;
 		string buffer;
+		LinphonePrivate::Content::Body bufferBody; // Body copied in buffer.
 		string file_path;
 		string header_value;
 	} mutable cache;
@@ -122,6 +123,17 @@ void linphone_content_add_content_type_parameter (LinphoneContent *content, cons
 	L_GET_CPP_PTR_FROM_C_OBJECT(content)->setContentType(contentType);
 }
 
+// The body is copied again only if it has changed since the last call.
+static const char *_linphone_content_get_cached_buffer (const LinphoneContent *content) {
+	const LinphonePrivate::Content *cppContent = L_GET_CPP_PTR_FROM_C_OBJECT(content);
+	const LinphonePrivate::Content::Body &body = cppContent->getSharedBody();
+	if (!body || body != content->cache.bufferBody) {
+		content->cache.buffer = cppContent->getBodyAsUtf8String();
+		content->cache.bufferBody = body;
+	}
+	return content->cache.buffer.c_str();
+}
+
 const uint8_t *linphone_content_get_buffer (const LinphoneContent *content) {
 	return reinterpret_cast<const uint8_t *>(linphone_content_get_utf8_text(content));
 }
@@ -132,13 +144,11 @@ void linphone_content_set_buffer (LinphoneContent *content, const uint8_t *buffe
 }
 
 const char *linphone_content_get_string_buffer (const LinphoneContent *content) {
-	content->cache.buffer = L_GET_CPP_PTR_FROM_C_OBJECT(content)->getBodyAsUtf8String();
-	return content->cache.buffer.c_str();
+	return _linphone_content_get_cached_buffer(content);
 }
 
 const char *linphone_content_get_utf8_text (const LinphoneContent *content) {
-	content->cache.buffer = L_GET_CPP_PTR_FROM_C_OBJECT(content)->getBodyAsUtf8String();
-	return content->cache.buffer.c_str();
+	return _linphone_content_get_cached_buffer(content);
 }
 
 void linphone_content_set_utf8_text (LinphoneContent *content, const char *buffer) {
@@ -68,6 +68,8 @@ public:
 	void setDirection (ChatMessage::Direction dir);
 
 	void setParticipantState (const IdentityAddress &participantAddress, ChatMessage::State newState, time_t stateChangeTime);
+	void notifyParticipantStateChanged (const IdentityAddress &participantAddress, ChatMessage::State newState, time_t stateChangeTime);
+	void updateStateFromParticipantStates (ChatMessage::State lastParticipantState, const MainDb::ParticipantStateCounts &counts);
 
 	virtual void setState (ChatMessage::State newState);
 	void forceState (ChatMessage::State newState) {
@@ -114,7 +116,13 @@ public:
 		contentsNotLoadedFromDatabase = true;
 	}
 
+	bool areContentsLoaded () const {
+		return !contentsNotLoadedFromDatabase;
+	}
+
 	void loadContentsFromDatabase () const;
+	// Called by the MainDb with the contents read from the database, the message takes their ownership.
+	void setContentsLoadedFromDatabase (const std::list<Content *> &loadedContents);
 
 	std::list<Content* > &getContents () {
 		loadContentsFromDatabase();
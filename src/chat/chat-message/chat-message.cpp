@@ -137,8 +137,15 @@ void ChatMessagePrivate::setParticipantState (const IdentityAddress &participant
 	if (!isValidStateTransition(currentState, newState))
 		return;
 
-	lInfo() << "Chat message " << q->getSharedFromThis() << ": moving participant '" << participantAddress.asString() << "' state to " << Utils::toString(newState);
 	mainDb->setChatMessageParticipantState(eventLog, participantAddress, newState, stateChangeTime);
+	notifyParticipantStateChanged(participantAddress, newState, stateChangeTime);
+	updateStateFromParticipantStates(newState, mainDb->getChatMessageParticipantStateCounts(eventLog));
+}
+
+void ChatMessagePrivate::notifyParticipantStateChanged (const IdentityAddress &participantAddress, ChatMessage::State newState, time_t stateChangeTime) {
+	L_Q();
+
+	lInfo() << "Chat message " << q->getSharedFromThis() << ": moving participant '" << participantAddress.asString() << "' state to " << Utils::toString(newState);
 
 	LinphoneChatMessage *msg = L_GET_C_BACK_PTR(q);
 	LinphoneChatRoom *cr = L_GET_C_BACK_PTR(q->getChatRoom());
@@ -156,46 +163,30 @@ void ChatMessagePrivate::setParticipantState (const IdentityAddress &participant
 
 	_linphone_chat_message_notify_participant_imdn_state_changed(msg, c_state);
 	_linphone_chat_room_notify_chat_message_participant_imdn_state_changed(cr, msg, c_state);
+}
+
+void ChatMessagePrivate::updateStateFromParticipantStates (ChatMessage::State lastParticipantState, const MainDb::ParticipantStateCounts &counts) {
+	L_Q();
 
 	if (linphone_config_get_bool(linphone_core_get_config(q->getChatRoom()->getCore()->getCCore()),
 			"misc", "enable_simple_group_chat_message_state", FALSE
 		)
 	) {
-		setState(newState);
+		setState(lastParticipantState);
 		return;
 	}
 
-	list<ChatMessage::State> states = mainDb->getChatMessageParticipantStates(eventLog);
-	size_t nbDisplayedStates = 0;
-	size_t nbDeliveredToUserStates = 0;
-	size_t nbNotDeliveredStates = 0;
-	for (const auto &state : states) {
-		switch (state) {
-			case ChatMessage::State::Displayed:
-				nbDisplayedStates++;
-				break;
-			case ChatMessage::State::DeliveredToUser:
-				nbDeliveredToUserStates++;
-				break;
-			case ChatMessage::State::NotDelivered:
-				nbNotDeliveredStates++;
-				break;
-			default:
-				break;
-		}
-	}
-
-	if (nbNotDeliveredStates > 0)
+	if (counts.notDelivered > 0)
 		setState(ChatMessage::State::NotDelivered);
-	else if (nbDisplayedStates == states.size()) {
+	else if (counts.displayed == counts.total) {
 		setState(ChatMessage::State::Displayed);
 	}
-	else if ((nbDisplayedStates + nbDeliveredToUserStates) == states.size())
+	else if ((counts.displayed + counts.deliveredToUser) == counts.total)
 		setState(ChatMessage::State::DeliveredToUser);
 
 	// When we already marked an incoming message as displayed, start ephemeral countdown when all other recipients have displayed it as well
 	if (isEphemeral && state == ChatMessage::State::Displayed) {
-		if (direction == ChatMessage::Direction::Incoming && nbDisplayedStates == states.size() - 1) { // -1 is for ourselves, our own display state isn't stored in db
+		if (direction == ChatMessage::Direction::Incoming && counts.displayed == counts.total - 1) { // -1 is for ourselves, our own display state isn't stored in db
 			startEphemeralCountDown();
 		}
 	}
@@ -520,7 +511,7 @@ const ContentType &ChatMessagePrivate::getContentType () const {
 void ChatMessagePrivate::setContentType (const ContentType &contentType) {
 	loadContentsFromDatabase();
 	if (!contents.empty() && internalContent.getContentType().isEmpty() && internalContent.isEmpty()) {
-		internalContent.setBody(contents.front()->getBody());
+		internalContent.setBody(contents.front()->getSharedBody());
 	}
 	internalContent.setContentType(contentType);
 
@@ -1446,16 +1437,36 @@ void ChatMessagePrivate::loadContentsFromDatabase () const {
 	L_Q();
 
 	if (contentsNotLoadedFromDatabase) {
-		isReadOnly = false;
-		contentsNotLoadedFromDatabase = false;
 		q->getChatRoom()->getCore()->getPrivate()->mainDb->loadChatMessageContents(
 			const_pointer_cast<ChatMessage>(q->getSharedFromThis())
 		);
 
+		// Not retried if the contents can't be read.
+		contentsNotLoadedFromDatabase = false;
 		isReadOnly = true;
 	}
 }
 
+void ChatMessagePrivate::setContentsLoadedFromDatabase (const list<Content *> &loadedContents) {
+	L_Q();
+
+	isReadOnly = false;
+	contentsNotLoadedFromDatabase = false;
+
+	bool hasFileTransferContent = false;
+	for (Content *content : loadedContents) {
+		if (content->getContentType() == ContentType::FileTransfer)
+			hasFileTransferContent = true;
+		q->addContent(content);
+	}
+
+	// Load external body url from body into FileTransferContent if needed.
+	if (hasFileTransferContent)
+		loadFileTransferUrlFromBodyToContent();
+
+	isReadOnly = true;
+}
+
 bool ChatMessage::isRead () const {
 	L_D();
 	return d->markedAsRead || d->state == State::Displayed;
@@ -55,6 +55,7 @@ class LINPHONE_PUBLIC ChatMessage : public Object, public CoreAccessor {
 	friend class FileTransferChatMessageModifier;
 	friend class Imdn;
 	friend class ImdnMessagePrivate;
+	friend class ImdnStateQueue;
 	friend class MainDb;
 	friend class MainDbPrivate;
 	friend class ClientGroupChatRoomPrivate;
@@ -106,10 +106,12 @@ public:
 
 	virtual std::list<std::shared_ptr<EventLog>> getMessageHistory (int nLast) const = 0;
 	virtual std::list<std::shared_ptr<EventLog>> getMessageHistoryRange (int begin, int end) const = 0;
+	virtual std::list<std::shared_ptr<EventLog>> getMessageHistoryBefore (const std::shared_ptr<const EventLog> &lastEventLog, int nLast) const = 0;
 	virtual std::list<std::shared_ptr<ChatMessage>> getUnreadChatMessages () const = 0;
 	virtual int getMessageHistorySize () const = 0;
 	virtual std::list<std::shared_ptr<EventLog>> getHistory (int nLast) const = 0;
 	virtual std::list<std::shared_ptr<EventLog>> getHistoryRange (int begin, int end) const = 0;
+	virtual std::list<std::shared_ptr<EventLog>> getHistoryBefore (const std::shared_ptr<const EventLog> &lastEventLog, int nLast) const = 0;
 	virtual int getHistorySize () const = 0;
 
 	virtual void deleteFromDb () = 0;
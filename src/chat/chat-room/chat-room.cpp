@@ -512,6 +512,10 @@ list<shared_ptr<EventLog>> ChatRoom::getMessageHistoryRange (int begin, int end)
 	return getCore()->getPrivate()->mainDb->getHistoryRange(getConferenceId(), begin, end, MainDb::Filter::ConferenceChatMessageFilter);
 }
 
+list<shared_ptr<EventLog>> ChatRoom::getMessageHistoryBefore (const shared_ptr<const EventLog> &lastEventLog, int nLast) const {
+	return getCore()->getPrivate()->mainDb->getHistoryBefore(getConferenceId(), lastEventLog, nLast, MainDb::Filter::ConferenceChatMessageFilter);
+}
+
 list<shared_ptr<ChatMessage>> ChatRoom::getUnreadChatMessages() const {
 	return getCore()->getPrivate()->mainDb->getUnreadChatMessages(getConferenceId());
 }
@@ -537,6 +541,15 @@ list<shared_ptr<EventLog>> ChatRoom::getHistoryRange (int begin, int end) const
 	);
 }
 
+list<shared_ptr<EventLog>> ChatRoom::getHistoryBefore (const shared_ptr<const EventLog> &lastEventLog, int nLast) const {
+	return getCore()->getPrivate()->mainDb->getHistoryBefore(
+		getConferenceId(),
+		lastEventLog,
+		nLast,
+		MainDb::FilterMask({ MainDb::Filter::ConferenceChatMessageFilter, MainDb::Filter::ConferenceInfoNoDeviceFilter })
+	);
+}
+
 int ChatRoom::getHistorySize () const {
 	return getCore()->getPrivate()->mainDb->getHistorySize(getConferenceId());
 }
@@ -126,7 +126,12 @@ void ClientGroupChatRoomPrivate::setCallSessionListener (CallSessionListener *li
 }
 
 void ClientGroupChatRoomPrivate::addOneToOneCapability () {
+	L_Q();
+	if (capabilities & ClientGroupChatRoom::Capabilities::OneToOne)
+		return;
+
 	capabilities |= ClientGroupChatRoom::Capabilities::OneToOne;
+	q->getCore()->getPrivate()->updateChatRoomIndexes(proxyChatRoom ? proxyChatRoom->getSharedFromThis() : q->getSharedFromThis());
 }
 
 unsigned int ClientGroupChatRoomPrivate::getLastNotifyId () const {
@@ -602,6 +607,18 @@ list<shared_ptr<EventLog>> ClientGroupChatRoom::getHistoryRange (int begin, int
 	);
 }
 
+list<shared_ptr<EventLog>> ClientGroupChatRoom::getHistoryBefore (const shared_ptr<const EventLog> &lastEventLog, int nLast) const {
+	L_D();
+	return getCore()->getPrivate()->mainDb->getHistoryBefore(
+		getConferenceId(),
+		lastEventLog,
+		nLast,
+		(d->capabilities & Capabilities::OneToOne) ?
+			MainDb::Filter::ConferenceChatMessageSecurityFilter :
+			MainDb::FilterMask({MainDb::Filter::ConferenceChatMessageFilter, MainDb::Filter::ConferenceInfoNoDeviceFilter})
+	);
+}
+
 int ClientGroupChatRoom::getHistorySize () const {
 	L_D();
 	return getCore()->getPrivate()->mainDb->getHistorySize(
@@ -953,7 +970,7 @@ void ClientGroupChatRoom::onConferenceCreated (const ConferenceAddress &addr) {
 void ClientGroupChatRoom::onConferenceKeywordsChanged (const vector<string> &keywords) {
 	L_D();
 	if (find(keywords.cbegin(), keywords.cend(), "one-to-one") != keywords.cend())
-		d->capabilities |= ClientGroupChatRoom::Capabilities::OneToOne;
+		d->addOneToOneCapability();
 	if (find(keywords.cbegin(), keywords.cend(), "ephemeral") != keywords.cend())
 		d->capabilities |= ClientGroupChatRoom::Capabilities::Ephemeral;
 }
@@ -120,6 +120,11 @@ list<shared_ptr<EventLog>> ProxyChatRoom::getMessageHistoryRange (int begin, int
 	return d->chatRoom->getMessageHistoryRange(begin, end);
 }
 
+list<shared_ptr<EventLog>> ProxyChatRoom::getMessageHistoryBefore (const shared_ptr<const EventLog> &lastEventLog, int nLast) const {
+	L_D();
+	return d->chatRoom->getMessageHistoryBefore(lastEventLog, nLast);
+}
+
 list<shared_ptr<ChatMessage>> ProxyChatRoom::getUnreadChatMessages() const {
 	L_D();
 	return d->chatRoom->getUnreadChatMessages();
@@ -140,6 +145,11 @@ list<shared_ptr<EventLog>> ProxyChatRoom::getHistoryRange (int begin, int end) c
 	return d->chatRoom->getHistoryRange(begin, end);
 }
 
+list<shared_ptr<EventLog>> ProxyChatRoom::getHistoryBefore (const shared_ptr<const EventLog> &lastEventLog, int nLast) const {
+	L_D();
+	return d->chatRoom->getHistoryBefore(lastEventLog, nLast);
+}
+
 int ProxyChatRoom::getHistorySize () const {
 	L_D();
 	return d->chatRoom->getHistorySize();
@@ -1025,6 +1025,23 @@ ChatMessageModifier::Result LimeX3dhEncryptionServerEngine::processOutgoingMessa
 		return ChatMessageModifier::Result::Error;
 	}
 
+	string body;
+	switch (slicedMessages.assembleForRecipient(*internalContent, toDeviceId, body)) {
+		case MultipartSlicesCache::Result::Done: {
+			Content finalContent;
+			finalContent.setContentType(internalContent->getContentType());
+			finalContent.setBodyFromUtf8(body);
+			message->setInternalContent(finalContent);
+			return ChatMessageModifier::Result::Done;
+		}
+		case MultipartSlicesCache::Result::MissingRecipient:
+			lError() << "[LIME][server] this message doesn't contain the cipher key for participant " << toDeviceId;
+			return ChatMessageModifier::Result::Error;
+		case MultipartSlicesCache::Result::NotSplit:
+			lWarning() << "[LIME][server] cannot split cipher message, parse it for each device";
+			break;
+	}
+
 	list<Content> contentsList = ContentManager::multipartToContentList(*internalContent);
 	list<Content *> contents;
 	bool hasKey = FALSE;
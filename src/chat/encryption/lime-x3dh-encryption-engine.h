@@ -23,6 +23,7 @@
 #include "belle-sip/belle-sip.h"
 #include "belle-sip/http-listener.h"
 #include "carddav.h"
+#include "content/multipart-slices.h"
 #include "core/core-listener.h"
 #include "encryption-engine.h"
 #include "lime/lime.hpp"
@@ -184,6 +185,12 @@ public:
 		int &errorCode
 	) override;
 	EncryptionEngine::EngineType getEngineType () override;
+
+private:
+	static constexpr size_t MaxSlicedMessages = 8;
+
+	// Cipher messages sent by the participants, split once for all the devices they are sent to.
+	MultipartSlicesCache slicedMessages{ContentType::LimeKey, MaxSlicedMessages};
 };
 
 LINPHONE_END_NAMESPACE
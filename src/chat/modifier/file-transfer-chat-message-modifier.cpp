@@ -572,7 +572,7 @@ ChatMessageModifier::Result FileTransferChatMessageModifier::decode (const share
 	if (internalContent.getContentType() == ContentType::FileTransfer) {
 		FileTransferContent *fileTransferContent = new FileTransferContent();
 		fileTransferContent->setContentType(internalContent.getContentType());
-		fileTransferContent->setBody(internalContent.getBody());
+		fileTransferContent->setBody(internalContent.getSharedBody());
 		string xml_body = fileTransferContent->getBodyAsUtf8String();
 		parseFileTransferXmlIntoContent(xml_body.c_str(), fileTransferContent);
 		message->addContent(fileTransferContent);
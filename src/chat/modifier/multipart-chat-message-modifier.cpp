@@ -59,7 +59,7 @@ ChatMessageModifier::Result MultipartChatMessageModifier::decode (const shared_p
 				for (const Header &header : c.getHeaders()) {
 					content->addHeader(header);
 				}
-				content->setBody(c.getBody());
+				content->setBody(c.getSharedBody());
 			} else {
 				content = new Content(c);
 			}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "chat/chat-message/chat-message-p.h"
+#include "chat/chat-room/abstract-chat-room.h"
+#include "core/core-p.h"
+#include "logger/logger.h"
+
+#include "imdn-state-queue.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+ImdnStateQueue::ImdnStateQueue (const shared_ptr<Core> &core) : CoreAccessor(core) {
+	LinphoneConfig *config = linphone_core_get_config(core->getCCore());
+	mEnabled = !!linphone_config_get_bool(config, "misc", "batch_imdn_processing", TRUE);
+	mWindow = (unsigned int)max(0, linphone_config_get_int(config, "misc", "imdn_processing_window_ms", 0));
+}
+
+ImdnStateQueue::~ImdnStateQueue () {
+	try {
+		cancelFlush();
+	} catch (const bad_weak_ptr &) {}
+}
+
+// -----------------------------------------------------------------------------
+
+void ImdnStateQueue::push (
+	const shared_ptr<ChatMessage> &chatMessage,
+	const IdentityAddress &participantAddress,
+	ChatMessage::State state,
+	time_t stateChangeTime
+) {
+	mStats.receivedStates++;
+	if (!mEnabled) {
+		mStats.batches++;
+		chatMessage->getPrivate()->setParticipantState(participantAddress, state, stateChangeTime);
+		return;
+	}
+
+	mPendingUpdates.emplace_back(chatMessage, participantAddress, state, stateChangeTime);
+	scheduleFlush();
+}
+
+void ImdnStateQueue::flush () {
+	cancelFlush();
+	if (mPendingUpdates.empty())
+		return;
+
+	list<MainDb::ParticipantStateUpdate> updates;
+	updates.swap(mPendingUpdates);
+	mStats.batches++;
+	mStats.largestBatch = max(mStats.largestBatch, updates.size());
+
+	for (auto it = updates.begin(); it != updates.end(); ) {
+		const shared_ptr<ChatMessage> &chatMessage = it->chatMessage;
+		if (!chatMessage->isValid()) {
+			it = updates.erase(it);
+		} else if (chatMessage->getChatRoom()->getCapabilities().isSet(ChatRoom::Capabilities::Basic)) {
+			// Basic Chat Room doesn't support participant state
+			chatMessage->getPrivate()->setState(it->state);
+			it = updates.erase(it);
+		} else
+			++it;
+	}
+	if (updates.empty())
+		return;
+
+	const unordered_map<long long, MainDb::ParticipantStateCounts> counts =
+		getCore()->getPrivate()->mainDb->setChatMessageParticipantStates(updates);
+
+	// Notify the participant states in their reception order, then the state of each chat message.
+	vector<pair<shared_ptr<ChatMessage>, ChatMessage::State>> updatedMessages;
+	for (const auto &update : updates) {
+		if (!update.applied)
+			continue;
+		mStats.appliedStates++;
+		update.chatMessage->getPrivate()->notifyParticipantStateChanged(update.address, update.state, update.timestamp);
+
+		auto it = find_if(updatedMessages.begin(), updatedMessages.end(), [&update](const pair<shared_ptr<ChatMessage>, ChatMessage::State> &message) {
+			return message.first == update.chatMessage;
+		});
+		if (it == updatedMessages.end())
+			updatedMessages.emplace_back(update.chatMessage, update.state);
+		else
+			it->second = update.state;
+	}
+
+	for (const auto &message : updatedMessages) {
+		auto it = counts.find(message.first->getStorageId());
+		if (it != counts.end())
+			message.first->getPrivate()->updateStateFromParticipantStates(message.second, it->second);
+	}
+
+	lDebug() << "IMDN states batch: " << updates.size() << " states stored in one transaction, "
+		<< mStats.getSavedTransactions() << " transactions saved so far";
+}
+
+const ImdnStateQueue::Stats &ImdnStateQueue::getStats () const {
+	return mStats;
+}
+
+// -----------------------------------------------------------------------------
+
+void ImdnStateQueue::scheduleFlush () {
+	if (mTimer)
+		return;
+
+	mTimer = getCore()->createTimer([this]() {
+		flush();
+		return false;
+	}, mWindow, "IMDN states batch");
+}
+
+void ImdnStateQueue::cancelFlush () {
+	if (!mTimer)
+		return;
+
+	getCore()->destroyTimer(mTimer);
+	mTimer = nullptr;
+}
+
+LINPHONE_END_NAMESPACE
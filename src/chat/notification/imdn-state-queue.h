@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_IMDN_STATE_QUEUE_H_
+#define _L_IMDN_STATE_QUEUE_H_
+
+#include <list>
+
+#include <belle-sip/types.h>
+
+#include "address/identity-address.h"
+#include "chat/chat-message/chat-message.h"
+#include "core/core-accessor.h"
+#include "db/main-db.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Participant states received in IMDNs, queued until the next main loop iteration (or the end of the
+ * configured window) and then stored in one database transaction. The callbacks are notified once
+ * everything is stored, and the state of each chat message is computed once per batch.
+ */
+class ImdnStateQueue : public CoreAccessor {
+public:
+	struct Stats {
+		unsigned long long receivedStates = 0;
+		unsigned long long appliedStates = 0;
+		unsigned long long batches = 0;
+		size_t largestBatch = 0;
+
+		// Number of transactions a one by one processing would have used.
+		unsigned long long getSavedTransactions () const {
+			return receivedStates - batches;
+		}
+	};
+
+	ImdnStateQueue (const std::shared_ptr<Core> &core);
+	~ImdnStateQueue ();
+
+	// Applies the state immediately if batching is disabled.
+	void push (
+		const std::shared_ptr<ChatMessage> &chatMessage,
+		const IdentityAddress &participantAddress,
+		ChatMessage::State state,
+		time_t stateChangeTime
+	);
+	void flush ();
+
+	const Stats &getStats () const;
+
+private:
+	void scheduleFlush ();
+	void cancelFlush ();
+
+	std::list<MainDb::ParticipantStateUpdate> mPendingUpdates;
+	belle_sip_source_t *mTimer = nullptr;
+	bool mEnabled;
+	unsigned int mWindow;
+	Stats mStats;
+
+	L_DISABLE_COPY(ImdnStateQueue);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_IMDN_STATE_QUEUE_H_
@@ -30,6 +30,7 @@
 #include "chat/encryption/encryption-engine.h"
 #endif
 
+#include "imdn-state-queue.h"
 #include "imdn.h"
 
 // =============================================================================
@@ -199,6 +200,14 @@ string Imdn::createXml (const string &id, time_t timestamp, Imdn::Type imdnType,
 void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 #ifdef HAVE_ADVANCED_IM
 	shared_ptr<AbstractChatRoom> cr = chatMessage->getChatRoom();
+	// The states received in a burst of IMDNs are stored together.
+	const unique_ptr<ImdnStateQueue> &imdnStateQueue = cr->getCore()->getPrivate()->imdnStateQueue;
+	auto setParticipantState = [&imdnStateQueue](const shared_ptr<ChatMessage> &cm, const IdentityAddress &participantAddress, ChatMessage::State state, time_t imdnTime) {
+		if (imdnStateQueue)
+			imdnStateQueue->push(cm, participantAddress, state, imdnTime);
+		else
+			cm->getPrivate()->setParticipantState(participantAddress, state, imdnTime);
+	};
 	list<string> messagesIds;
 	list<unique_ptr<Xsd::Imdn::Imdn>> imdns;
 
@@ -242,9 +251,9 @@ void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 			if (deliveryNotification.present()) {
 				auto &status = deliveryNotification.get().getStatus();
 				if (status.getDelivered().present() && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
-					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::DeliveredToUser, imdnTime);
+					setParticipantState(cm, participantAddress, ChatMessage::State::DeliveredToUser, imdnTime);
 				} else if ((status.getFailed().present() || status.getError().present()) && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
-					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::NotDelivered, imdnTime);
+					setParticipantState(cm, participantAddress, ChatMessage::State::NotDelivered, imdnTime);
 					// When the IMDN status is failed for reason code 488 (Not acceptable here) and the chatroom is encrypted,
 					// something is wrong with our encryption session with this peer, stale the active session the next
 					// message (which can be a resend of this one) will be encrypted with a new session
@@ -266,7 +275,7 @@ void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 			} else if (displayNotification.present()) {
 				auto &status = displayNotification.get().getStatus();
 				if (status.getDisplayed().present() && linphone_im_notif_policy_get_recv_imdn_displayed(policy)) {
-					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::Displayed, imdnTime);
+					setParticipantState(cm, participantAddress, ChatMessage::State::Displayed, imdnTime);
 					if (cr->getLocalAddress().getAddressWithoutGruu() == chatMessage->getFromAddress().getAddressWithoutGruu()) {
 						auto lastMsg = cr->getLastChatMessageInHistory();
 						if (lastMsg == cm) {
@@ -71,4 +71,8 @@ bool ConferenceId::isValid () const {
 	return peerAddress.isValid() && localAddress.isValid();
 }
 
+size_t ConferenceId::getHash () const {
+	return peerAddress.getHash() ^ (localAddress.getHash() << 1);
+}
+
 LINPHONE_END_NAMESPACE
@@ -50,6 +50,9 @@ public:
 
 	bool isValid () const;
 
+	// Combines the hashes cached by the addresses: hashing a ConferenceId doesn't build any string.
+	std::size_t getHash () const;
+
 private:
 
 	ConferenceAddress peerAddress;
@@ -69,8 +72,7 @@ namespace std {
 	template<>
 	struct hash<LinphonePrivate::ConferenceId> {
 		std::size_t operator() (const LinphonePrivate::ConferenceId &conferenceId) const {
-			return hash<string>()(conferenceId.getPeerAddress().asString()) ^
-				(hash<string>()(conferenceId.getLocalAddress().asString()) << 1);
+			return conferenceId.getHash();
 		}
 	};
 }
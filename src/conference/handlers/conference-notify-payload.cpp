@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "content/content-manager.h"
+
+#include "conference-notify-payload.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	ContentType getNotifyContentType (const string &body) {
+		if (body.find(MultipartBoundary) == string::npos)
+			return ContentType::ConferenceInfo;
+		ContentType contentType(ContentType::Multipart);
+		contentType.addParameter("boundary", MultipartBoundary);
+		return contentType;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+ConferenceNotifyPayload::ConferenceNotifyPayload (const string &body, bool deflate) :
+	NotifyPayload(body, getNotifyContentType(body), deflate) {}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_CONFERENCE_NOTIFY_PAYLOAD_H_
+#define _L_CONFERENCE_NOTIFY_PAYLOAD_H_
+
+#include "sal/notify-payload.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Body of a conference event NOTIFY: a conference-info body, or a multipart body grouping several of them.
+ */
+class ConferenceNotifyPayload : public NotifyPayload {
+public:
+	/**
+	 * @param[in] body the conference-info or multipart body
+	 * @param[in] deflate whether the body is compressed with the deflate content encoding
+	 **/
+	ConferenceNotifyPayload (const std::string &body, bool deflate);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_CONFERENCE_NOTIFY_PAYLOAD_H_
@@ -23,6 +23,7 @@
 #include "linphone/utils/utils.h"
 
 #include "c-wrapper/c-wrapper.h"
+#include "conference-notify-payload.h"
 #include "conference/conference.h"
 #include "conference/participant-device.h"
 #include "conference/participant.h"
@@ -58,17 +59,23 @@ LocalConferenceEventHandler::LocalConferenceEventHandler (Conference *conference
 // -----------------------------------------------------------------------------
 
 void LocalConferenceEventHandler::notifyFullState (const string &notify, const shared_ptr<ParticipantDevice> &device) {
-	notifyParticipantDevice(notify, device, (notify.find(MultipartBoundary) != std::string::npos));
+	notifyParticipantDevice(notify, device);
 }
 
 void LocalConferenceEventHandler::notifyAllExceptDevice (const string &notify, const shared_ptr<ParticipantDevice> &exceptDevice) {
+	if (notify.empty())
+		return;
+
+	shared_ptr<const ConferenceNotifyPayload> payload;
 	for (const auto &participant : conf->getParticipants()) {
 		for (const auto &device : participant->getDevices()){
 			if (device != exceptDevice) {
 				const auto & deviceState = device->getState();
 				/* Only notify to device that are present in the conference. */
 				if ((deviceState == ParticipantDevice::State::Present) || (deviceState == ParticipantDevice::State::OnHold)) {
-					notifyParticipantDevice(notify, device, (notify.find(MultipartBoundary) != std::string::npos));
+					if (!payload)
+						payload = createNotifyPayload(notify);
+					notifyParticipantDevice(payload, device);
 				}
 			}
 		}
@@ -76,15 +83,23 @@ void LocalConferenceEventHandler::notifyAllExceptDevice (const string &notify, c
 }
 
 void LocalConferenceEventHandler::notifyAllExcept (const string &notify, const shared_ptr<Participant> &exceptParticipant) {
+	if (notify.empty())
+		return;
+
+	auto payload = createNotifyPayload(notify);
 	for (const auto &participant : conf->getParticipants()) {
 		if (participant != exceptParticipant)
-			notifyParticipant(notify, participant);
+			notifyParticipant(payload, participant);
 	}
 }
 
 void LocalConferenceEventHandler::notifyAll (const string &notify) {
+	if (notify.empty())
+		return;
+
+	auto payload = createNotifyPayload(notify);
 	for (const auto &participant : conf->getParticipants())
-		notifyParticipant(notify, participant);
+		notifyParticipant(payload, participant);
 }
 
 string LocalConferenceEventHandler::createNotifyFullState (LinphoneEvent * lev) {
@@ -813,7 +828,21 @@ string LocalConferenceEventHandler::createNotifyAvailableMediaChanged (const std
 }
 
 
-void LocalConferenceEventHandler::notifyParticipant (const string &notify, const shared_ptr<Participant> &participant) {
+shared_ptr<const ConferenceNotifyPayload> LocalConferenceEventHandler::createNotifyPayload (const string &notify) {
+	auto payload = make_shared<const ConferenceNotifyPayload>(
+		notify,
+		!!linphone_core_content_encoding_supported(conf->getCore()->getCCore(), "deflate")
+	);
+	notifyStats.encodedBodies++;
+	notifyStats.bodyBytes += payload->getBodySize();
+	notifyStats.encodedBytes += payload->getEncodedSize();
+	lInfo() << "Conference [" << conf->getConferenceAddress() << "] NOTIFY body of " << payload->getBodySize()
+		<< " bytes encoded to " << payload->getEncodedSize() << " bytes"
+		<< (payload->getContentEncoding().empty() ? "" : " (" + payload->getContentEncoding() + ")");
+	return payload;
+}
+
+void LocalConferenceEventHandler::notifyParticipant (const shared_ptr<const ConferenceNotifyPayload> &payload, const shared_ptr<Participant> &participant) {
 	for (const auto &device : participant->getDevices()){
 		/* Only notify to device that are present in the conference. */
 		switch(device->getState()){
@@ -821,7 +850,7 @@ void LocalConferenceEventHandler::notifyParticipant (const string &notify, const
 			case ParticipantDevice::State::OnHold:
 			case ParticipantDevice::State::Joining:
 			case ParticipantDevice::State::ScheduledForJoining:
-				notifyParticipantDevice(notify, device, (notify.find(MultipartBoundary) != std::string::npos));
+				notifyParticipantDevice(payload, device);
 				break;
 			case ParticipantDevice::State::Leaving:
 			case ParticipantDevice::State::Left:
@@ -831,30 +860,28 @@ void LocalConferenceEventHandler::notifyParticipant (const string &notify, const
 	}
 }
 
-void LocalConferenceEventHandler::notifyParticipantDevice (const string &notify, const shared_ptr<ParticipantDevice> &device, bool multipart) {
-
+void LocalConferenceEventHandler::notifyParticipantDevice (const string &notify, const shared_ptr<ParticipantDevice> &device) {
 	if (!device->isSubscribedToConferenceEventPackage() || notify.empty())
 		return;
 
+	notifyParticipantDevice(createNotifyPayload(notify), device);
+}
+
+void LocalConferenceEventHandler::notifyParticipantDevice (const shared_ptr<const ConferenceNotifyPayload> &payload, const shared_ptr<ParticipantDevice> &device) {
+	if (!device->isSubscribedToConferenceEventPackage())
+		return;
+
 	LinphoneEvent *ev = device->getConferenceSubscribeEvent();
 	LinphoneEventCbs *cbs = linphone_event_get_callbacks(ev);
 	linphone_event_cbs_set_user_data(cbs, this);
 	linphone_event_cbs_set_notify_response(cbs, notifyResponseCb);
 
-	Content content;
-	content.setBodyFromUtf8(notify);
-	ContentType contentType;
-	if (multipart) {
-		contentType = ContentType(ContentType::Multipart);
-		contentType.addParameter("boundary", MultipartBoundary);
-	} else
-		contentType = ContentType(ContentType::ConferenceInfo);
-
-	content.setContentType(contentType);
-	if (linphone_core_content_encoding_supported(conf->getCore()->getCCore(), "deflate"))
-		content.setContentEncoding("deflate");
-	LinphoneContent *cContent = L_GET_C_BACK_PTR(&content);
-	linphone_event_notify(ev, cContent);
+	if (_linphone_event_notify_with_body_handler(ev, payload->createBodyHandler()) == 0)
+		notifyStats.sentNotifies++;
+}
+
+const LocalConferenceEventHandler::NotifyStats &LocalConferenceEventHandler::getNotifyStats () const {
+	return notifyStats;
 }
 
 // -----------------------------------------------------------------------------
@@ -900,7 +927,7 @@ void LocalConferenceEventHandler::subscribeReceived (LinphoneEvent *lev) {
 		} else if (evLastNotify < lastNotify) {
 			lInfo() << "Sending all missed notify [" << evLastNotify << "-" << lastNotify <<
 				"] for conference [" << conf->getConferenceAddress() << "] to: " << participant->getAddress();
-			notifyParticipantDevice(createNotifyMultipart(static_cast<int>(evLastNotify)), device, true);
+			notifyParticipantDevice(createNotifyMultipart(static_cast<int>(evLastNotify)), device);
 		} else if (evLastNotify > lastNotify) {
 			lError() << "Last notify received by client [" << evLastNotify << "] for conference [" <<
 				conf->getConferenceAddress() <<
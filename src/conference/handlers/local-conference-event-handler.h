@@ -39,6 +39,7 @@
 LINPHONE_BEGIN_NAMESPACE
 
 class ConferenceId;
+class ConferenceNotifyPayload;
 class ConferenceParticipantDeviceEvent;
 class ConferenceParticipantEvent;
 class ConferenceSubjectEvent;
@@ -51,6 +52,14 @@ friend class LocalConferenceListEventHandler;
 	friend class Tester;
 #endif
 public:
+	// Cumulated sizes of the NOTIFY bodies sent by this handler, each body is encoded once for all the devices.
+	struct NotifyStats {
+		unsigned int encodedBodies = 0;
+		unsigned int sentNotifies = 0;
+		size_t bodyBytes = 0;
+		size_t encodedBytes = 0;
+	};
+
 	static Xsd::ConferenceInfo::MediaStatusType mediaDirectionToMediaStatus (LinphoneMediaDirection direction);
 	LocalConferenceEventHandler (Conference *conference, ConferenceListener* listener = nullptr);
 
@@ -59,6 +68,8 @@ public:
 
 	std::string getNotifyForId (int notifyId, LinphoneEvent *lev);
 
+	const NotifyStats &getNotifyStats () const;
+
 //protected:
 	void notifyFullState (const std::string &notify, const std::shared_ptr<ParticipantDevice> &device);
 	void notifyAllExcept (const std::string &notify, const std::shared_ptr<Participant> &exceptParticipant);
@@ -194,8 +205,10 @@ private:
 	std::string createNotifySubjectChanged (const std::string &subject);
 	std::string createNotifyEphemeralLifetime (const long & lifetime);
 	std::string createNotifyEphemeralMode (const EventLog::Type & type);
-	void notifyParticipant (const std::string &notify, const std::shared_ptr<Participant> &participant);
-	void notifyParticipantDevice (const std::string &notify, const std::shared_ptr<ParticipantDevice> &device, bool multipart = false);
+	std::shared_ptr<const ConferenceNotifyPayload> createNotifyPayload (const std::string &notify);
+	void notifyParticipant (const std::shared_ptr<const ConferenceNotifyPayload> &payload, const std::shared_ptr<Participant> &participant);
+	void notifyParticipantDevice (const std::string &notify, const std::shared_ptr<ParticipantDevice> &device);
+	void notifyParticipantDevice (const std::shared_ptr<const ConferenceNotifyPayload> &payload, const std::shared_ptr<ParticipantDevice> &device);
 
 	std::shared_ptr<Participant> getConferenceParticipant (const Address & address) const;
 
@@ -203,6 +216,8 @@ private:
 	void addEndpointStatus(const std::shared_ptr<ParticipantDevice> & device, Xsd::ConferenceInfo::EndpointType & endpoint);
 	void addAvailableMediaCapabilities(const LinphoneMediaDirection audioDirection, const LinphoneMediaDirection videoDirection, const LinphoneMediaDirection textDirection, Xsd::ConferenceInfo::ConferenceDescriptionType & confDescr);
 
+	NotifyStats notifyStats;
+
 	L_DISABLE_COPY(LocalConferenceEventHandler);
 };
 
@@ -192,6 +192,7 @@ private:
 	void discoverMtu (const Address &remoteAddr);
 	void getLocalIp (const Address &remoteAddr);
 	void runStunTestsIfNeeded ();
+	bool isStunDiscoveryRunning () const;
 	void selectIncomingIpVersion ();
 	void selectOutgoingIpVersion ();
 
@@ -231,6 +232,7 @@ private:
 
 	void abort (const std::string &errorMsg) override;
 	void handleIncomingReceivedStateInIncomingNotification () override;
+	bool isReadyForInvite () const override;
 	LinphoneStatus pause ();
 	int restartInvite () override;
 	void setTerminated () override;
@@ -1137,12 +1137,26 @@ void MediaSessionPrivate::runStunTestsIfNeeded () {
 		int videoPort = portFromStreamIndex(videoStreamIndex);
 		const auto textStreamIndex = md->findIdxBestStream(SalText);
 		int textPort = portFromStreamIndex(textStreamIndex);
-		int ret = stunClient->run(audioPort, videoPort, textPort);
-		if (ret >= 0)
-			pingTime = ret;
+		// The STUN sockets are bound to the RTP ports: the tasks using the streams are deferred until the end of the tests.
+		stunClient->runAsync(audioPort, videoPort, textPort, [this](int ret) {
+			if (ret >= 0)
+				pingTime = ret;
+			runIceGatheringTasks();
+		});
 	}
 }
 
+/*
+ * The STUN discovery is only done when ICE is disabled, the tasks waiting for its end are queued as ICE gathering tasks.
+ */
+bool MediaSessionPrivate::isStunDiscoveryRunning () const {
+	return stunClient && stunClient->isRunning();
+}
+
+bool MediaSessionPrivate::isReadyForInvite () const {
+	return CallSessionPrivate::isReadyForInvite() && !isStunDiscoveryRunning();
+}
+
 /*
  * Select IP version to use for advertising local addresses of RTP streams, for an incoming call.
  * If the call is received through a know proxy that is IPv6, use IPv6.
@@ -3541,7 +3555,15 @@ void MediaSession::initiateIncoming () {
 	L_D();
 	CallSession::initiateIncoming();
 
-	if (d->natPolicy) {
+	if (d->isStunDiscoveryRunning()) {
+		d->deferIncomingNotification = true;
+		d->queueIceGatheringTask([d]() {
+			if (d->state != State::Idle && d->state != State::PushIncomingReceived) return 0;
+			d->deferIncomingNotification = false;
+			d->startIncomingNotification();
+			return 0;
+		});
+	} else if (d->natPolicy) {
 		if (linphone_nat_policy_ice_enabled(d->natPolicy)){
 			d->deferIncomingNotification = d->getStreamsGroup().prepare();
 			/*
@@ -3595,6 +3617,15 @@ bool MediaSession::initiateOutgoing (const string &subject, const Content *conte
 			}
 			defer |= ice_needs_defer;
 		}
+	} else if (d->isStunDiscoveryRunning()) {
+		lInfo() << "Deferring the INVITE until the end of the STUN tests";
+		d->queueIceGatheringTask([this, subject, content]() {
+			L_D();
+			if (d->state == CallSession::State::OutgoingInit && d->isReadyForInvite())
+				startInvite(nullptr, subject, content);
+			return 0;
+		});
+		defer = true;
 	}
 	return defer;
 }
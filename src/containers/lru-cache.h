@@ -32,15 +32,19 @@ LINPHONE_BEGIN_NAMESPACE
 template<typename Key, typename Value>
 class LruCache {
 public:
-	LruCache (int capacity = DefaultCapacity) : mCapacity(capacity) {
-		if (capacity < MinCapacity)
-			capacity = MinCapacity;
-	}
+	LruCache (int capacity = DefaultCapacity) : mCapacity(capacity < MinCapacity ? int(MinCapacity) : capacity) {}
 
 	int getCapacity () const {
 		return mCapacity;
 	}
 
+	// Evicts the least recently used entries exceeding the new capacity.
+	void setCapacity (int capacity) {
+		mCapacity = capacity < MinCapacity ? int(MinCapacity) : capacity;
+		while (int(mKeyToPair.size()) > mCapacity)
+			evict();
+	}
+
 	int getSize () const {
 		return int(mKeyToPair.size());
 	}
@@ -55,16 +59,22 @@ public:
 		return it == mKeyToPair.cend() ? nullptr : &it->second.second;
 	}
 
+	// Same as operator[], but the entry becomes the most recently used one.
+	Value *use (const Key &key) {
+		auto it = mKeyToPair.find(key);
+		if (it == mKeyToPair.end())
+			return nullptr;
+		mKeys.splice(mKeys.begin(), mKeys, it->second.first);
+		return &it->second.second;
+	}
+
 	void insert (const Key &key, const Value &value) {
 		auto it = mKeyToPair.find(key);
 		if (it != mKeyToPair.end()) {
 			mKeys.erase(it->second.first);
 			mKeyToPair.erase(it);
-		} else if (int(mKeyToPair.size()) == mCapacity) {
-			Key lastKey = mKeys.back();
-			mKeys.pop_back();
-			mKeyToPair.erase(lastKey);
-		}
+		} else if (int(mKeyToPair.size()) >= mCapacity)
+			evict();
 
 		mKeys.push_front(key);
 		mKeyToPair.insert({ key, { mKeys.begin(), value } });
@@ -75,11 +85,8 @@ public:
 		if (it != mKeyToPair.end()) {
 			mKeys.erase(it->second.first);
 			mKeyToPair.erase(it);
-		} else if (int(mKeyToPair.size()) == mCapacity) {
-			Key lastKey = mKeys.back();
-			mKeys.pop_back();
-			mKeyToPair.erase(lastKey);
-		}
+		} else if (int(mKeyToPair.size()) >= mCapacity)
+			evict();
 
 		mKeys.push_front(key);
 		mKeyToPair.insert({ key, std::make_pair(mKeys.begin(), std::move(value)) });
@@ -96,7 +103,12 @@ public:
 private:
 	using Pair = std::pair<typename std::list<Key>::iterator, Value>;
 
-	const int mCapacity;
+	void evict () {
+		mKeyToPair.erase(mKeys.back());
+		mKeys.pop_back();
+	}
+
+	int mCapacity;
 
 	// See: https://stackoverflow.com/questions/16781886/can-we-store-unordered-maptiterator
 	// Do not store iterator key.
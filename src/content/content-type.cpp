@@ -49,6 +49,7 @@ const ContentType ContentType::ImIsComposing("application/im-iscomposing+xml");
 const ContentType ContentType::LimeKey("application/lime");
 const ContentType ContentType::Multipart("multipart/mixed");
 const ContentType ContentType::OctetStream("application/octet-stream");
+const ContentType ContentType::Pidf("application/pidf+xml");
 const ContentType ContentType::PlainText("text/plain");
 const ContentType ContentType::ResourceLists("application/resource-lists+xml");
 const ContentType ContentType::Rlmi("application/rlmi+xml");
@@ -78,6 +78,7 @@ public:
 	static const ContentType LimeKey;
 	static const ContentType Multipart;
 	static const ContentType OctetStream;
+	static const ContentType Pidf;
 	static const ContentType PlainText;
 	static const ContentType ResourceLists;
 	static const ContentType Rlmi;
@@ -17,6 +17,11 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#ifdef DEBUG
+	#include <atomic>
+#endif
+
 // TODO: Remove me later.
 #include "linphone/core.h"
 
@@ -38,6 +43,34 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+namespace {
+#ifdef DEBUG
+	atomic<unsigned long> bodyCopyCount(0);
+
+	inline void countBodyCopy () {
+		bodyCopyCount.fetch_add(1, memory_order_relaxed);
+	}
+#else
+	inline void countBodyCopy () {}
+#endif
+
+	/*
+	 * Fills the body with zeros before releasing it since it may contain
+	 * private data like cipher keys or decoded messages.
+	 */
+	void deleteBody (const vector<char> *body) {
+		vector<char> *data = const_cast<vector<char> *>(body);
+		fill(data->begin(), data->end(), 0);
+		delete data;
+	}
+
+	Content::Body makeBody (vector<char> &&body) {
+		if (body.empty())
+			return nullptr;
+		return Content::Body(new vector<char>(move(body)), deleteBody);
+	}
+}
+
 // =============================================================================
 
 Content::Content () : ClonableObject(*new ContentPrivate) {}
@@ -58,14 +91,7 @@ Content::Content (Content &&other) : ClonableObject(*new ContentPrivate), AppDat
 
 Content::Content (ContentPrivate &p) : ClonableObject(p) {}
 
-Content::~Content () {
-	L_D();
-	/*
-	 * Fills the body with zeros before releasing since it may contain
-	 * private data like cipher keys or decoded messages.
-	 */
-	d->body.assign(d->body.size(), 0);
-}
+Content::~Content () {}
 
 Content &Content::operator= (const Content &other) {
 	if (this != &other) {
@@ -90,7 +116,7 @@ Content &Content::operator= (Content &&other) {
 bool Content::operator== (const Content &other) const {
 	L_D();
 	return d->contentType == other.getContentType() &&
-		d->body == other.getBody() &&
+		(d->body == other.getSharedBody() || getBody() == other.getBody()) &&
 		d->contentDisposition == other.getContentDisposition() &&
 		d->contentEncoding == other.getContentEncoding() &&
 		d->headers == other.getHeaders();
@@ -98,7 +124,7 @@ bool Content::operator== (const Content &other) const {
 
 void Content::copy(const Content &other) {
 	L_D();
-	d->body = other.getBody();
+	d->body = other.getSharedBody();
 	d->contentType = other.getContentType();
 	d->contentDisposition = other.getContentDisposition();
 	d->contentEncoding = other.getContentEncoding();
@@ -136,53 +162,80 @@ void Content::setContentEncoding (const string &contentEncoding) {
 }
 
 const vector<char> &Content::getBody () const {
+	L_D();
+	if (!d->body)
+		return Utils::getEmptyConstRefObject<vector<char>>();
+	return *d->body;
+}
+
+const Content::Body &Content::getSharedBody () const {
 	L_D();
 	return d->body;
 }
 
+const char *Content::getBodyData () const {
+	L_D();
+	return d->body ? d->body->data() : nullptr;
+}
+
 string Content::getBodyAsString () const {
 	L_D();
-	return Utils::utf8ToLocale(string(d->body.begin(), d->body.end()));
+	if (!d->body)
+		return string();
+	countBodyCopy();
+	return Utils::utf8ToLocale(string(d->body->cbegin(), d->body->cend()));
 }
 
 string Content::getBodyAsUtf8String () const {
 	L_D();
-	return string(d->body.begin(), d->body.end());
+	if (!d->body)
+		return string();
+	countBodyCopy();
+	return string(d->body->cbegin(), d->body->cend());
 }
 
 void Content::setBody (const vector<char> &body) {
 	L_D();
-	d->body = body;
+	countBodyCopy();
+	d->body = makeBody(vector<char>(body));
 }
 
 void Content::setBody (vector<char> &&body) {
 	L_D();
-	d->body = move(body);
+	d->body = makeBody(move(body));
+}
+
+void Content::setBody (const Body &body) {
+	L_D();
+	d->body = body && !body->empty() ? body : nullptr;
 }
 
 void Content::setBodyFromLocale (const string &body) {
 	L_D();
+	countBodyCopy();
 	string toUtf8 = Utils::localeToUtf8(body);
-	d->body = vector<char>(toUtf8.cbegin(), toUtf8.cend());
+	d->body = makeBody(vector<char>(toUtf8.cbegin(), toUtf8.cend()));
 }
 
 void Content::setBody (const void *buffer, size_t size) {
 	L_D();
 	const char *start = static_cast<const char *>(buffer);
-	if(start != nullptr)
-		d->body = vector<char>(start, start + size);
-	else
-		d->body.clear();
+	if (start != nullptr) {
+		countBodyCopy();
+		d->body = makeBody(vector<char>(start, start + size));
+	} else
+		d->body = nullptr;
 }
 
 void Content::setBodyFromUtf8 (const string &body) {
 	L_D();
-	d->body = vector<char>(body.cbegin(), body.cend());
+	countBodyCopy();
+	d->body = makeBody(vector<char>(body.cbegin(), body.cend()));
 }
 
 size_t Content::getSize () const {
 	L_D();
-	return d->body.size();
+	return d->body ? d->body->size() : 0;
 }
 
 bool Content::isEmpty () const {
@@ -196,7 +249,7 @@ bool Content::isMultipart () const {
 
 bool Content::isValid () const {
 	L_D();
-	return d->contentType.isValid() || (d->contentType.isEmpty() && d->body.empty());
+	return d->contentType.isValid() || (d->contentType.isEmpty() && !d->body);
 }
 
 bool Content::isFile () const {
@@ -256,6 +309,12 @@ Variant Content::getUserData() const {
 	return getProperty("LinphonePrivate::Content::userData");
 }
 
+#ifdef DEBUG
+	unsigned long Content::getBodyCopyCount () {
+		return bodyCopyCount.load(memory_order_relaxed);
+	}
+#endif
+
 bool Content::isFileEncrypted (const string& filePath) const {
 	if (filePath.empty()) {
 		return false;
@@ -21,6 +21,7 @@
 #define _L_CONTENT_H_
 
 #include <list>
+#include <memory>
 #include <vector>
 
 #include "object/app-data-container.h"
@@ -39,6 +40,9 @@ class Header;
 
 class LINPHONE_PUBLIC Content : public ClonableObject, public AppDataContainer {
 public:
+	// Immutable body, shared by the copies of a content until one of them sets another body.
+	typedef std::shared_ptr<const std::vector<char>> Body;
+
 	Content ();
 	Content (const Content &other);
 	Content (Content &&other);
@@ -65,11 +69,15 @@ public:
 	void setContentEncoding (const std::string &contentEncoding);
 
 	const std::vector<char> &getBody () const;
+	const Body &getSharedBody () const;
+	// Valid as long as the body is not changed, nullptr if empty.
+	const char *getBodyData () const;
 	std::string getBodyAsString () const;
 	std::string getBodyAsUtf8String () const;
 
 	void setBody (const std::vector<char> &body);
 	void setBody (std::vector<char> &&body);
+	void setBody (const Body &body);
 	void setBodyFromLocale (const std::string &body);
 	void setBody (const void *buffer, size_t size);
 	void setBodyFromUtf8 (const std::string &body);
@@ -93,6 +101,11 @@ public:
 	void setUserData(const Variant &userData);
 	Variant getUserData() const;
 
+#ifdef DEBUG
+	// Number of times a body has been copied, by all the contents.
+	static unsigned long getBodyCopyCount ();
+#endif
+
 protected:
 	explicit Content (ContentPrivate &p);
 
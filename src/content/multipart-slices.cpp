@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "content/content-type.h"
+#include "content/header/header-param.h"
+
+#include "multipart-slices.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	const char Crlf[] = "\r\n";
+
+	string trim (const string &value) {
+		const size_t begin = value.find_first_not_of(" \t");
+		if (begin == string::npos)
+			return string();
+		return value.substr(begin, value.find_last_not_of(" \t") - begin + 1);
+	}
+
+	bool isHeader (const string &line, size_t nameSize, const char *name) {
+		return line.size() > nameSize && line[nameSize] == ':' && strncasecmp(line.c_str(), name, nameSize) == 0;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+MultipartSlices::MultipartSlices (const Content &content) {
+	if (!content.getContentType().isMultipart())
+		return;
+
+	mBoundary = content.getContentType().getParameter("boundary").getValue();
+	if (mBoundary.empty())
+		return;
+
+	const vector<char> &body = content.getBody();
+	mSharedBody = content.getSharedBody();
+	mBody.assign(body.cbegin(), body.cend());
+	mValid = split();
+}
+
+bool MultipartSlices::isValid () const {
+	return mValid;
+}
+
+bool MultipartSlices::hasSameBody (const Content &content) const {
+	// The copies of a content share its body.
+	if (mSharedBody && content.getSharedBody() == mSharedBody)
+		return true;
+
+	const vector<char> &body = content.getBody();
+	return body.size() == mBody.size() && (body.empty() || memcmp(body.data(), mBody.data(), body.size()) == 0);
+}
+
+const vector<MultipartSlices::Part> &MultipartSlices::getParts () const {
+	return mParts;
+}
+
+string MultipartSlices::assemble (const vector<const Part *> &parts) const {
+	size_t size = mBoundary.size() + 6;
+	for (const Part *part : parts)
+		size += part->size;
+
+	string body;
+	body.reserve(size);
+	for (const Part *part : parts)
+		body.append(mBody, part->offset, part->size);
+	body += "--";
+	body += mBoundary;
+	body += "--";
+	body += Crlf;
+	return body;
+}
+
+// -----------------------------------------------------------------------------
+
+// A delimiter is "--" followed by the boundary, at the beginning of the body or of a line.
+// A part goes from its delimiter to the next one, the CRLF preceding the next delimiter included.
+bool MultipartSlices::split () {
+	const string delimiter = "--" + mBoundary;
+
+	size_t position = 0;
+	for (;;) {
+		position = mBody.find(delimiter, position);
+		if (position == string::npos)
+			return false;
+		if (position == 0 || (position >= 2 && mBody.compare(position - 2, 2, Crlf) == 0))
+			break;
+		position += delimiter.size();
+	}
+
+	for (;;) {
+		const size_t afterDelimiter = position + delimiter.size();
+		if (mBody.compare(afterDelimiter, 2, "--") == 0)
+			return !mParts.empty(); // Close delimiter.
+
+		const size_t headersBegin = mBody.find(Crlf, afterDelimiter);
+		if (headersBegin == string::npos)
+			return false;
+		size_t next = mBody.find(Crlf + delimiter, headersBegin);
+		if (next == string::npos)
+			return false;
+		next += 2;
+
+		Part part;
+		part.offset = position;
+		part.size = next - position;
+
+		// Headers, until the empty line preceding the part body.
+		size_t lineBegin = headersBegin + 2;
+		while (lineBegin < next) {
+			size_t lineEnd = mBody.find(Crlf, lineBegin);
+			if (lineEnd == string::npos || lineEnd == lineBegin || lineEnd > next)
+				break;
+			const string line = mBody.substr(lineBegin, lineEnd - lineBegin);
+			if (isHeader(line, 12, "Content-Type"))
+				part.contentType = trim(line.substr(13));
+			else if (isHeader(line, 10, "Content-Id"))
+				part.contentId = trim(line.substr(11));
+			lineBegin = lineEnd + 2;
+		}
+
+		mParts.push_back(move(part));
+		position = next;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+MultipartSlicesCache::MultipartSlicesCache (const ContentType &recipientPartType, size_t capacity) :
+	mRecipientPartType(recipientPartType), mCapacity(capacity) {}
+
+MultipartSlicesCache::Result MultipartSlicesCache::assembleForRecipient (
+	const Content &content,
+	const string &recipientId,
+	string &body
+) {
+	const Entry *entry = find(content);
+	if (!entry)
+		return Result::NotSplit;
+
+	auto it = entry->recipientParts.find(recipientId);
+	if (it == entry->recipientParts.end())
+		return Result::MissingRecipient;
+
+	vector<const MultipartSlices::Part *> parts;
+	parts.reserve(entry->commonParts.size() + 1);
+	parts.insert(parts.end(), entry->commonParts.cbegin(), entry->commonParts.cbegin() + ptrdiff_t(it->second.second));
+	parts.push_back(it->second.first);
+	parts.insert(parts.end(), entry->commonParts.cbegin() + ptrdiff_t(it->second.second), entry->commonParts.cend());
+	body = entry->slices->assemble(parts);
+	return Result::Done;
+}
+
+size_t MultipartSlicesCache::getSplitCount () const {
+	return mSplitCount;
+}
+
+// The most recently used bodies come first, several bodies may be sent at the same time.
+const MultipartSlicesCache::Entry *MultipartSlicesCache::find (const Content &content) {
+	for (auto it = mEntries.begin(); it != mEntries.end(); ++it) {
+		if (it->slices->hasSameBody(content)) {
+			mEntries.splice(mEntries.begin(), mEntries, it);
+			return &mEntries.front();
+		}
+	}
+
+	Entry entry;
+	entry.slices.reset(new MultipartSlices(content));
+	if (!entry.slices->isValid())
+		return nullptr;
+	mSplitCount++;
+
+	for (const auto &part : entry.slices->getParts()) {
+		if (ContentType(part.contentType) == mRecipientPartType)
+			entry.recipientParts.emplace(part.contentId, make_pair(&part, entry.commonParts.size()));
+		else
+			entry.commonParts.push_back(&part);
+	}
+
+	mEntries.push_front(move(entry));
+	if (mEntries.size() > mCapacity)
+		mEntries.pop_back();
+	return &mEntries.front();
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_MULTIPART_SLICES_H_
+#define _L_MULTIPART_SLICES_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "content/content-type.h"
+#include "content/content.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Multipart body split once into the slices of its parts, without copying them.
+ * New multipart bodies made of some of the parts are assembled from the slices,
+ * with the boundary of the original body and without parsing it again.
+ */
+class LINPHONE_PUBLIC MultipartSlices {
+public:
+	struct Part {
+		size_t offset; // Of the delimiter line of the part in the body.
+		size_t size; // From the delimiter line to the end of the part body, CRLF included.
+		std::string contentType;
+		std::string contentId;
+	};
+
+	explicit MultipartSlices (const Content &content);
+
+	/**
+	 * @return false if the content is not a multipart or if its body can't be split
+	 **/
+	bool isValid () const;
+
+	/**
+	 * @return whether the body of the content is the one that was split
+	 **/
+	bool hasSameBody (const Content &content) const;
+
+	const std::vector<Part> &getParts () const;
+
+	/**
+	 * @param[in] parts parts of this body, in the order they are written
+	 * @return a multipart body made of the given parts
+	 **/
+	std::string assemble (const std::vector<const Part *> &parts) const;
+
+private:
+	bool split ();
+
+	Content::Body mSharedBody;
+	std::string mBody;
+	std::string mBoundary;
+	std::vector<Part> mParts;
+	bool mValid = false;
+};
+
+/**
+ * Last multipart bodies split, with their recipient parts indexed by Content-Id. The same body is usually
+ * sent to many recipients: each one gets the parts common to all of them and its own recipient part.
+ */
+class LINPHONE_PUBLIC MultipartSlicesCache {
+public:
+	enum class Result {
+		Done,
+		MissingRecipient,
+		NotSplit
+	};
+
+	MultipartSlicesCache (const ContentType &recipientPartType, size_t capacity);
+
+	/**
+	 * @param[in] content multipart content sent to all the recipients
+	 * @param[in] recipientId Content-Id of the part of the recipient
+	 * @param[out] body the common parts, and the part of the recipient at its position among them
+	 * @return MissingRecipient if the content has no part for the recipient, NotSplit if it can't be split
+	 **/
+	Result assembleForRecipient (const Content &content, const std::string &recipientId, std::string &body);
+
+	// Number of bodies split so far, the other requests reused them.
+	size_t getSplitCount () const;
+
+private:
+	struct Entry {
+		std::unique_ptr<MultipartSlices> slices;
+		std::vector<const MultipartSlices::Part *> commonParts;
+		// Part of each recipient, and its position among the common parts.
+		std::unordered_map<std::string, std::pair<const MultipartSlices::Part *, size_t>> recipientParts;
+	};
+
+	const Entry *find (const Content &content);
+
+	ContentType mRecipientPartType;
+	size_t mCapacity;
+	size_t mSplitCount = 0;
+	std::list<Entry> mEntries;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_MULTIPART_SLICES_H_
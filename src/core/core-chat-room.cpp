@@ -17,6 +17,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iterator>
 
 #include "linphone/utils/algorithm.h"
@@ -51,6 +52,74 @@ LINPHONE_BEGIN_NAMESPACE
 // Helpers.
 // -----------------------------------------------------------------------------
 
+namespace {
+	// Keys of the chat room indexes: built from the address fields compared by IdentityAddress::operator==,
+	// without parsing the address again as getAddressWithoutGruu() does.
+	inline void appendAddressKey (string &key, const IdentityAddress &address, bool withGruu) {
+		key += address.getUsername();
+		key += '@';
+		key += address.getDomain();
+		if (withGruu && address.hasGruu()) {
+			key += ";gr=";
+			key += address.getGruu();
+		}
+	}
+
+	string getPeerAddressKey (const IdentityAddress &peerAddress) {
+		string key;
+		appendAddressKey(key, peerAddress, true);
+		return key;
+	}
+
+	string getOneToOneKey (const IdentityAddress &localAddress, const IdentityAddress &participantAddress) {
+		string key;
+		appendAddressKey(key, localAddress, false);
+		key += '\n';
+		appendAddressKey(key, participantAddress, false);
+		return key;
+	}
+
+	inline bool equalWithoutGruu (const IdentityAddress &address1, const IdentityAddress &address2) {
+		return address1.getUsername() == address2.getUsername() && address1.getDomain() == address2.getDomain();
+	}
+
+	bool isMatchingOneToOneChatRoom (
+		const shared_ptr<AbstractChatRoom> &chatRoom,
+		const IdentityAddress &localAddress,
+		const IdentityAddress &participantAddress,
+		bool basicOnly,
+		bool conferenceOnly,
+		bool encrypted
+	) {
+		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
+
+		// We are looking for a one to one chatroom
+		// Do not return a group chat room that everyone except one person has left
+		if (!(capabilities & ChatRoom::Capabilities::OneToOne))
+			return false;
+
+		if (encrypted != bool(capabilities & ChatRoom::Capabilities::Encrypted))
+			return false;
+
+		if (!equalWithoutGruu(localAddress, chatRoom->getLocalAddress()))
+			return false;
+
+		// One to one client group chat room
+		// The only participant's address must match the participantAddress argument
+		if (!basicOnly && (capabilities & ChatRoom::Capabilities::Conference) && !chatRoom->getParticipants().empty()) {
+			const IdentityAddress &curParticipantAddress = chatRoom->getParticipants().front()->getAddress();
+			if (!curParticipantAddress.hasGruu() && equalWithoutGruu(participantAddress, curParticipantAddress))
+				return true;
+		}
+
+		// One to one basic chat room (addresses without gruu)
+		// The peer address must match the participantAddress argument
+		return !conferenceOnly &&
+			(capabilities & ChatRoom::Capabilities::Basic) &&
+			equalWithoutGruu(participantAddress, chatRoom->getPeerAddress());
+	}
+}
+
 /*
  * Returns the best local address to talk with peer address.
  * If peerAddress is not defined, returns the local address of the default proxy config.
@@ -423,6 +492,7 @@ void CorePrivate::insertChatRoom (const shared_ptr<AbstractChatRoom> &chatRoom)
 		noCreatedClientGroupChatRooms.erase(chatRoom.get());
 		lInfo() << "Insert chat room " << conferenceId << " to core map";
 		chatRoomsById[conferenceId] = chatRoom;
+		addChatRoomToIndexes(chatRoom);
 	}
 }
 
@@ -431,8 +501,96 @@ void CorePrivate::insertChatRoomWithDb (const shared_ptr<AbstractChatRoom> &chat
 	if (mainDb->isInitialized()) mainDb->insertChatRoom(chatRoom, notifyId);
 }
 
-void CorePrivate::loadChatRooms () {
+// The one-to-one chat rooms are indexed by their local address and their peer address (basic chat rooms)
+// or their participant address (conference chat rooms), all without gruu.
+// Only the chat rooms ids are known to be constant: a chat room whose ConferenceId changes is indexed again.
+void CorePrivate::addChatRoomToIndexes (const shared_ptr<AbstractChatRoom> &chatRoom) {
+	chatRoomsByPeerAddress.emplace(getPeerAddressKey(chatRoom->getPeerAddress()), chatRoom);
+	addChatRoomToOneToOneIndex(chatRoom);
+}
+
+void CorePrivate::addChatRoomToOneToOneIndex (const shared_ptr<AbstractChatRoom> &chatRoom) const {
+	const ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
+	if (!(capabilities & ChatRoom::Capabilities::OneToOne))
+		return;
+
+	if (capabilities & ChatRoom::Capabilities::Conference) {
+		if (chatRoom->getParticipants().empty()) {
+			unindexedOneToOneChatRooms.push_back(chatRoom);
+			return;
+		}
+		oneToOneChatRoomsByAddresses.emplace(
+			getOneToOneKey(chatRoom->getLocalAddress(), chatRoom->getParticipants().front()->getAddress()),
+			chatRoom
+		);
+	} else
+		oneToOneChatRoomsByAddresses.emplace(getOneToOneKey(chatRoom->getLocalAddress(), chatRoom->getPeerAddress()), chatRoom);
+}
+
+// The participant of a one-to-one conference chat room may be added after the chat room itself.
+void CorePrivate::indexOneToOneChatRoomsWithParticipant () const {
+	if (unindexedOneToOneChatRooms.empty())
+		return;
+
+	list<shared_ptr<AbstractChatRoom>> chatRooms;
+	chatRooms.swap(unindexedOneToOneChatRooms);
+	for (const auto &chatRoom : chatRooms)
+		addChatRoomToOneToOneIndex(chatRoom);
+}
+
+void CorePrivate::removeChatRoomFromIndexes (const shared_ptr<const AbstractChatRoom> &chatRoom) {
+	auto removeFrom = [&chatRoom](unordered_multimap<string, shared_ptr<AbstractChatRoom>> &index, const string &key) {
+		auto range = index.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == chatRoom) {
+				index.erase(it);
+				return;
+			}
+		}
+		// The key is computed from the current addresses of the chat room, which may have changed since it was indexed.
+		for (auto it = index.begin(); it != index.end(); ++it) {
+			if (it->second == chatRoom) {
+				index.erase(it);
+				return;
+			}
+		}
+	};
+
+	removeFrom(chatRoomsByPeerAddress, getPeerAddressKey(chatRoom->getPeerAddress()));
+	if (!(chatRoom->getCapabilities() & ChatRoom::Capabilities::OneToOne))
+		return;
+
+	unindexedOneToOneChatRooms.remove_if([&chatRoom](const shared_ptr<AbstractChatRoom> &unindexedChatRoom) {
+		return unindexedChatRoom == chatRoom;
+	});
+	const IdentityAddress &participantAddress = (chatRoom->getCapabilities() & ChatRoom::Capabilities::Conference) && !chatRoom->getParticipants().empty()
+		? chatRoom->getParticipants().front()->getAddress()
+		: chatRoom->getPeerAddress();
+	removeFrom(oneToOneChatRoomsByAddresses, getOneToOneKey(chatRoom->getLocalAddress(), participantAddress));
+}
+
+// The capabilities of a chat room, such as OneToOne, may be known only after it was indexed.
+void CorePrivate::updateChatRoomIndexes (const shared_ptr<AbstractChatRoom> &chatRoom) {
+	auto range = chatRoomsByPeerAddress.equal_range(getPeerAddressKey(chatRoom->getPeerAddress()));
+	auto it = find_if(range.first, range.second, [&chatRoom](const pair<const string, shared_ptr<AbstractChatRoom>> &item) {
+		return item.second == chatRoom;
+	});
+	if (it == range.second)
+		return; // Not indexed yet, it will be with its current capabilities.
+
+	removeChatRoomFromIndexes(chatRoom);
+	addChatRoomToIndexes(chatRoom);
+}
+
+void CorePrivate::clearChatRooms () {
 	chatRoomsById.clear();
+	chatRoomsByPeerAddress.clear();
+	oneToOneChatRoomsByAddresses.clear();
+	unindexedOneToOneChatRooms.clear();
+}
+
+void CorePrivate::loadChatRooms () {
+	clearChatRooms();
 #ifdef HAVE_ADVANCED_IM
 	if (remoteListEventHandler)
 		remoteListEventHandler->clearHandlers();
@@ -539,12 +697,15 @@ void CorePrivate::replaceChatRoom (const shared_ptr<AbstractChatRoom> &replacedC
 	const ConferenceId &replacedConferenceId = replacedChatRoom->getConferenceId();
 	const ConferenceId &newConferenceId = newChatRoom->getConferenceId();
 
+	removeChatRoomFromIndexes(replacedChatRoom);
 	if (replacedChatRoom->getCapabilities() & ChatRoom::Capabilities::Proxy) {
 		chatRoomsById.erase(replacedConferenceId);
 		chatRoomsById[newConferenceId] = replacedChatRoom;
+		addChatRoomToIndexes(replacedChatRoom);
 	} else {
 		chatRoomsById.erase(replacedConferenceId);
 		chatRoomsById[newConferenceId] = newChatRoom;
+		addChatRoomToIndexes(newChatRoom);
 	}
 }
 
@@ -555,21 +716,22 @@ shared_ptr<AbstractChatRoom> CorePrivate::findExhumableOneToOneChatRoom (
 #ifdef HAVE_ADVANCED_IM
 	lInfo() << "Looking for exhumable 1-1 chat room with local address [" << localAddress.asString() << "] and participant [" << participantAddress.asString() << "]";
 	
-	for (auto it = chatRoomsById.begin(); it != chatRoomsById.end(); it++) {
-		const auto &chatRoom = it->second;
-		const IdentityAddress &curLocalAddress = chatRoom->getLocalAddress();
+	auto isExhumable = [&](const shared_ptr<AbstractChatRoom> &chatRoom) {
 		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
 		// Don't check if terminated, it can be exhumed before the BYE has been received
-		if (/*chatRoom->getState() == ChatRoom::State::Terminated
+		return /*chatRoom->getState() == ChatRoom::State::Terminated
 				&& */capabilities & ChatRoom::Capabilities::Conference
 				&& capabilities & ChatRoom::Capabilities::OneToOne
-				&& encrypted == bool(capabilities & ChatRoom::Capabilities::Encrypted)) {
-			if (chatRoom->getParticipants().size() > 0 
-					&& localAddress.getAddressWithoutGruu() == curLocalAddress.getAddressWithoutGruu()
-					&& participantAddress.getAddressWithoutGruu() == chatRoom->getParticipants().front()->getAddress().getAddressWithoutGruu()) {
-				return chatRoom;
-			}
-		}
+				&& encrypted == bool(capabilities & ChatRoom::Capabilities::Encrypted)
+				&& chatRoom->getParticipants().size() > 0
+				&& equalWithoutGruu(localAddress, chatRoom->getLocalAddress())
+				&& equalWithoutGruu(participantAddress, chatRoom->getParticipants().front()->getAddress());
+	};
+	indexOneToOneChatRoomsWithParticipant();
+	auto range = oneToOneChatRoomsByAddresses.equal_range(getOneToOneKey(localAddress, participantAddress));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (isExhumable(it->second))
+			return it->second;
 	}
 
 	lInfo() << "Unable to find exhumable 1-1 chat room with local address [" << localAddress.asString() << "] and participant [" << participantAddress.asString() << "]";
@@ -606,8 +768,10 @@ void CorePrivate::updateChatRoomConferenceId (const shared_ptr<AbstractChatRoom>
 	const ConferenceId &newConferenceId = chatRoom->getConferenceId();
 	lInfo() << "Chat room [" << oldConferenceId << "] has been exhumed into [" << newConferenceId << "]";
 
+	removeChatRoomFromIndexes(chatRoom);
 	chatRoomsById.erase(oldConferenceId);
 	chatRoomsById[newConferenceId] = chatRoom;
+	addChatRoomToIndexes(chatRoom);
 
 	mainDb->updateChatRoomConferenceId(oldConferenceId, newConferenceId);
 #endif
@@ -708,7 +872,8 @@ list<shared_ptr<AbstractChatRoom>> Core::findChatRooms (const IdentityAddress &p
 	L_D();
 
 	list<shared_ptr<AbstractChatRoom>> output;
-	for (auto it = d->chatRoomsById.begin(); it != d->chatRoomsById.end(); it++) {
+	auto range = d->chatRoomsByPeerAddress.equal_range(getPeerAddressKey(peerAddress));
+	for (auto it = range.first; it != range.second; ++it) {
 		const auto &chatRoom = it->second;
 		if (chatRoom->getPeerAddress() == peerAddress) {
 			output.push_front(chatRoom);
@@ -726,39 +891,12 @@ shared_ptr<AbstractChatRoom> Core::findOneToOneChatRoom (
 	bool encrypted
 ) const {
 	L_D();
-	for (auto it = d->chatRoomsById.begin(); it != d->chatRoomsById.end(); it++) {
-		const auto &chatRoom = it->second;
-		const IdentityAddress &curLocalAddress = chatRoom->getLocalAddress();
-		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
-
-		// We are looking for a one to one chatroom
-		// Do not return a group chat room that everyone except one person has left
-		if (!(capabilities & ChatRoom::Capabilities::OneToOne))
-			continue;
-
-		if (encrypted != bool(capabilities & ChatRoom::Capabilities::Encrypted))
-			continue;
 
-		// One to one client group chat room
-		// The only participant's address must match the participantAddress argument
-		if (
-			!basicOnly &&
-		        (capabilities & ChatRoom::Capabilities::Conference) &&
-			!chatRoom->getParticipants().empty() &&
-			localAddress.getAddressWithoutGruu() == curLocalAddress.getAddressWithoutGruu() &&
-			participantAddress.getAddressWithoutGruu() == chatRoom->getParticipants().front()->getAddress()
-		)
-			return chatRoom;
-
-		// One to one basic chat room (addresses without gruu)
-		// The peer address must match the participantAddress argument
-		if (
-			!conferenceOnly && 
-				(capabilities & ChatRoom::Capabilities::Basic) &&
-			localAddress.getAddressWithoutGruu() == curLocalAddress.getAddressWithoutGruu() &&
-			participantAddress.getAddressWithoutGruu() == chatRoom->getPeerAddress().getAddressWithoutGruu()
-		)
-			return chatRoom;
+	d->indexOneToOneChatRoomsWithParticipant();
+	auto range = d->oneToOneChatRoomsByAddresses.equal_range(getOneToOneKey(localAddress, participantAddress));
+	for (auto it = range.first; it != range.second; ++it) {
+		if (isMatchingOneToOneChatRoom(it->second, localAddress, participantAddress, basicOnly, conferenceOnly, encrypted))
+			return it->second;
 	}
 	return nullptr;
 }
@@ -826,6 +964,7 @@ void Core::deleteChatRoom (const shared_ptr<const AbstractChatRoom> &chatRoom) {
 	d->noCreatedClientGroupChatRooms.erase(chatRoom.get());
 	auto chatRoomsByIdIt = d->chatRoomsById.find(conferenceId);
 	if (chatRoomsByIdIt != d->chatRoomsById.end()) {
+		d->removeChatRoomFromIndexes(chatRoomsByIdIt->second);
 		d->chatRoomsById.erase(chatRoomsByIdIt);
 		if (d->mainDb->isInitialized()) d->mainDb->deleteChatRoom(conferenceId);
 	} else {
@@ -32,6 +32,7 @@
 #include "auth-info/auth-stack.h"
 #include "conference/session/tone-manager.h"
 #include "utils/background-task.h"
+#include "utils/if-addrs.h"
 #include "call/audio-device/audio-device.h"
 
 // =============================================================================
@@ -40,6 +41,7 @@ LINPHONE_BEGIN_NAMESPACE
 
 class CoreListener;
 class EncryptionEngine;
+class ImdnStateQueue;
 class LocalConferenceListEventHandler;
 class RemoteConferenceListEventHandler;
 
@@ -140,6 +142,12 @@ public:
 	void replaceChatRoom (const std::shared_ptr<AbstractChatRoom> &replacedChatRoom, const std::shared_ptr<AbstractChatRoom> &newChatRoom);
 
 	void updateChatRoomConferenceId (const std::shared_ptr<AbstractChatRoom> &chatRoom, ConferenceId newConferenceId);
+	void addChatRoomToIndexes (const std::shared_ptr<AbstractChatRoom> &chatRoom);
+	void addChatRoomToOneToOneIndex (const std::shared_ptr<AbstractChatRoom> &chatRoom) const;
+	void indexOneToOneChatRoomsWithParticipant () const;
+	void removeChatRoomFromIndexes (const std::shared_ptr<const AbstractChatRoom> &chatRoom);
+	void updateChatRoomIndexes (const std::shared_ptr<AbstractChatRoom> &chatRoom);
+	void clearChatRooms ();
 	std::shared_ptr<AbstractChatRoom> findExhumableOneToOneChatRoom (
 		const IdentityAddress &localAddress,
 		const IdentityAddress &participantAddress,
@@ -152,6 +160,7 @@ public:
 	belle_sip_main_loop_t *getMainLoop();
 	bool basicToFlexisipChatroomMigrationEnabled()const;
 	std::unique_ptr<MainDb> mainDb;
+	std::unique_ptr<ImdnStateQueue> imdnStateQueue;
 #ifdef HAVE_ADVANCED_IM
 	std::unique_ptr<RemoteConferenceListEventHandler> remoteListEventHandler;
 	std::unique_ptr<LocalConferenceListEventHandler> localListEventHandler;
@@ -159,6 +168,9 @@ public:
 	AuthStack &getAuthStack(){
 		return authStack;
 	}
+	IfAddrsCache &getIfAddrsCache(){
+		return ifAddrsCache;
+	}
 	Sal * getSal();
 	LinphoneCore *getCCore() const;
 
@@ -182,6 +194,11 @@ private:
 	std::shared_ptr<Call> currentCall;
 
 	std::unordered_map<ConferenceId, std::shared_ptr<AbstractChatRoom>> chatRoomsById;
+	// Secondary indexes of chatRoomsById, see addChatRoomToIndexes().
+	std::unordered_multimap<std::string, std::shared_ptr<AbstractChatRoom>> chatRoomsByPeerAddress;
+	mutable std::unordered_multimap<std::string, std::shared_ptr<AbstractChatRoom>> oneToOneChatRoomsByAddresses;
+	// One-to-one conference chat rooms whose participant was not known yet when they were indexed.
+	mutable std::list<std::shared_ptr<AbstractChatRoom>> unindexedOneToOneChatRooms;
 
 	std::unique_ptr<EncryptionEngine> imee;
 
@@ -193,6 +210,7 @@ private:
 	// Otherwise the chatRoom will be freed() before it is inserted
 	std::unordered_map<const AbstractChatRoom *, std::shared_ptr<const AbstractChatRoom>> noCreatedClientGroupChatRooms;
 	AuthStack authStack;
+	IfAddrsCache ifAddrsCache;
 
 	std::list<std::shared_ptr<ChatMessage>> ephemeralMessages;
 	belle_sip_source_t *ephemeralTimer = nullptr;
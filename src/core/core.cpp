@@ -42,6 +42,7 @@
 #ifdef HAVE_LIME_X3DH
 #include "chat/encryption/lime-x3dh-encryption-engine.h"
 #endif
+#include "chat/notification/imdn-state-queue.h"
 #ifdef HAVE_ADVANCED_IM
 #include "conference/handlers/local-conference-list-event-handler.h"
 #include "conference/handlers/remote-conference-list-event-handler.h"
@@ -87,7 +88,9 @@ void CorePrivate::init () {
 	L_Q();
 
 	mainDb.reset(new MainDb(q->getSharedFromThis()));
+	imdnStateQueue.reset(new ImdnStateQueue(q->getSharedFromThis()));
 	getToneManager(); // Forces instanciation of the ToneManager.
+	ifAddrsCache.startMonitoring(getMainLoop());
 #ifdef HAVE_ADVANCED_IM
 	remoteListEventHandler = makeUnique<RemoteConferenceListEventHandler>(q->getSharedFromThis());
 	localListEventHandler = makeUnique<LocalConferenceListEventHandler>(q->getSharedFromThis());
@@ -279,6 +282,11 @@ void CorePrivate::uninit() {
 		q->enableLimeX3dh(false);
 	}
 
+	if (imdnStateQueue) {
+		imdnStateQueue->flush();
+		imdnStateQueue.reset();
+	}
+
 	const list<shared_ptr<AbstractChatRoom>> chatRooms = q->getChatRooms();
 	shared_ptr<ChatRoom> cr;
 	for (const auto &chatRoom : chatRooms) {
@@ -302,7 +310,7 @@ void CorePrivate::uninit() {
 		}
 	}
 
-	chatRoomsById.clear();
+	clearChatRooms();
 
 	for (const auto &audioVideoConference : q->audioVideoConferenceById) {
 		// Terminate audio video conferences just before core is stopped
@@ -314,6 +322,7 @@ void CorePrivate::uninit() {
 	listeners.clear();
 	pushReceivedBackgroundTask.stop();
 	mLdapServers.clear();
+	ifAddrsCache.stopMonitoring();
 
 #ifdef HAVE_ADVANCED_IM
 	remoteListEventHandler.reset();
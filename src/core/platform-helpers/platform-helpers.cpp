@@ -17,6 +17,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "core/core-p.h"
 #include "logger/logger.h"
 #include "platform-helpers.h"
 
@@ -166,9 +167,12 @@ bool GenericPlatformHelpers::checkIpAddressChanged(){
 
 	char newIp4[LINPHONE_IPADDR_SIZE] = {0};
 	char newIp6[LINPHONE_IPADDR_SIZE] = {0};
-	linphone_core_get_local_ip(core, AF_INET, nullptr, newIp4);
+	// Bypass the cache of the core: this check is what detects the changes where the interfaces are not monitored.
+	linphone_core_get_local_ip_for(AF_INET, nullptr, newIp4);
 	if (ipv6Enabled)
-		linphone_core_get_local_ip(core, AF_INET6, nullptr, newIp6);
+		linphone_core_get_local_ip_for(AF_INET6, nullptr, newIp6);
+	if (strcmp(newIp4, core->localip4) != 0 || (ipv6Enabled && strcmp(newIp6, core->localip6) != 0))
+		getCore()->getPrivate()->getIfAddrsCache().invalidate();
 
 	bool status = strcmp(newIp6,"::1") != 0 || strcmp(newIp4,"127.0.0.1") != 0;
 	bool ipChanged = false;
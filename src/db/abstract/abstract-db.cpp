@@ -97,6 +97,8 @@ bool AbstractDb::connect (Backend backend, const string &nameParams) {
 void AbstractDb::disconnect () {
 #ifdef HAVE_DB_STORAGE
 	L_D();
+	// Statements must be finalized before the connection is closed.
+	d->dbSession.clearCachedStatements();
 	d->dbSession = DbSession();
 #endif
 }
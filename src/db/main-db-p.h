@@ -21,6 +21,7 @@
 #define _L_MAIN_DB_P_H_
 
 #include <unordered_map>
+#include <vector>
 
 #include "linphone/utils/utils.h"
 
@@ -69,6 +70,8 @@ private:
 	long long insertChatRoomParticipant (long long chatRoomId, long long participantSipAddressId, bool isAdmin);
 	void insertChatRoomParticipantDevice (long long participantId, long long participantDeviceSipAddressId, const std::string &deviceName);
 	void insertChatMessageParticipant (long long chatMessageId, long long sipAddressId, int state, time_t stateChangeTime);
+	void updateChatMessageParticipantStateCounts (long long chatMessageId, int oldState, int newState, int addedParticipants = 0);
+	MainDb::ParticipantStateCounts selectChatMessageParticipantStateCounts (long long chatMessageId) const;
 	long long insertConferenceInfo (const std::shared_ptr<ConferenceInfo> &conferenceInfo);
 	long long insertConferenceInfoParticipant (long long conferenceInfoId, long long participantSipAddressId);
 	long long insertOrUpdateConferenceCall (const std::shared_ptr<CallLog> &callLog, const std::shared_ptr<ConferenceInfo> &conferenceInfo = nullptr);
@@ -189,10 +192,46 @@ private:
 		ChatMessage::State state,
 		time_t stateChangeTime
 	);
+	// Returns false if the participant is unknown or if its state can't be changed.
+	bool setChatMessageParticipantState (
+		long long eventId,
+		const IdentityAddress &participantAddress,
+		ChatMessage::State state,
+		time_t stateChangeTime,
+		bool checkTransition
+	);
 
 	void insertNewPreviousConferenceId(const ConferenceId& currentConfId, const ConferenceId& previousConfId);
 	void removePreviousConferenceId(const ConferenceId& confId);
 
+	// Loads the contents of a batch of messages with one query for the contents and their file informations,
+	// and one for their app data. The messages whose contents are already loaded are skipped.
+	void loadChatMessagesContents (const std::list<std::shared_ptr<ChatMessage>> &chatMessages) const;
+	// Same for the messages of a page of the history.
+	void loadChatMessagesContents (const std::list<std::shared_ptr<EventLog>> &events) const;
+
+	// ---------------------------------------------------------------------------
+	// Chat rooms loading.
+	// ---------------------------------------------------------------------------
+
+	struct ParticipantRow {
+		long long id;
+		std::string address;
+		bool isAdmin;
+	};
+
+	struct ParticipantDeviceRow {
+		std::string address;
+		unsigned int state;
+		std::string name;
+	};
+
+	void selectChatRoomsParticipants (
+		std::unordered_map<long long, std::vector<ParticipantRow>> &participantsByChatRoom,
+		std::unordered_map<long long, std::vector<ParticipantDeviceRow>> &devicesByParticipant,
+		std::unordered_map<long long, std::vector<std::string>> &previousConferenceIdsByChatRoom
+	) const;
+
 	// ---------------------------------------------------------------------------
 	// Call log API.
 	// ---------------------------------------------------------------------------
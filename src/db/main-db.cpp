@@ -22,7 +22,9 @@
 	#pragma GCC diagnostic ignored "-Wstringop-overflow"
 #endif
 
+#include <algorithm>
 #include <ctime>
+#include <limits>
 
 #include "linphone/utils/algorithm.h"
 #include "linphone/utils/static-string.h"
@@ -63,12 +65,38 @@ LINPHONE_BEGIN_NAMESPACE
 
 #ifdef HAVE_DB_STORAGE
 namespace {
-	constexpr unsigned int ModuleVersionEvents = makeVersion(1, 0, 17);
+	constexpr unsigned int ModuleVersionEvents = makeVersion(1, 0, 19);
 	constexpr unsigned int ModuleVersionFriends = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyFriendsImport = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyHistoryImport = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyCallLogsImport = makeVersion(1, 0, 0);
 
+	// Column of conference_chat_message_event counting the participants in a state, if this state is counted.
+	const char *participantStateCountColumn (ChatMessage::State state) {
+		switch (state) {
+			case ChatMessage::State::Displayed:
+				return "displayed_count";
+			case ChatMessage::State::DeliveredToUser:
+				return "delivered_to_user_count";
+			case ChatMessage::State::NotDelivered:
+				return "not_delivered_count";
+			default:
+				break;
+		}
+		return nullptr;
+	}
+
+	// Queries built at run time and prepared once by the DbSession, see DbSession::getCachedStatement().
+	enum class CachedStatement : uint32_t {
+		SelectHistoryRange,
+		SelectHistoryBefore,
+		SelectHistorySize
+	};
+
+	inline uint64_t makeCachedStatementKey (CachedStatement statement, MainDb::FilterMask mask) {
+		return (uint64_t(statement) << 32) | uint32_t(mask);
+	}
+
 	constexpr int LegacyFriendListColId = 0;
 	constexpr int LegacyFriendListColName = 1;
 	constexpr int LegacyFriendListColRlsUri = 2;
@@ -552,6 +580,36 @@ void MainDbPrivate::insertChatMessageParticipant (long long chatMessageId, long
 #endif
 }
 
+MainDb::ParticipantStateCounts MainDbPrivate::selectChatMessageParticipantStateCounts (long long chatMessageId) const {
+	MainDb::ParticipantStateCounts counts;
+#ifdef HAVE_DB_STORAGE
+	*dbSession.getBackendSession() << "SELECT participant_count, displayed_count, delivered_to_user_count, not_delivered_count"
+		" FROM conference_chat_message_event WHERE event_id = :chatMessageId",
+		soci::into(counts.total), soci::into(counts.displayed), soci::into(counts.deliveredToUser), soci::into(counts.notDelivered),
+		soci::use(chatMessageId);
+#endif
+	return counts;
+}
+
+// The participant states of a chat message are counted in conference_chat_message_event, its aggregate state
+// is updated in constant time whatever the number of participants.
+void MainDbPrivate::updateChatMessageParticipantStateCounts (long long chatMessageId, int oldState, int newState, int addedParticipants) {
+#ifdef HAVE_DB_STORAGE
+	const char *oldColumn = addedParticipants == 0 ? participantStateCountColumn(ChatMessage::State(oldState)) : nullptr;
+	const char *newColumn = participantStateCountColumn(ChatMessage::State(newState));
+	if (oldColumn == newColumn && addedParticipants == 0)
+		return;
+
+	string query = "UPDATE conference_chat_message_event SET participant_count = participant_count + :addedParticipants";
+	if (oldColumn)
+		query += string(", ") + oldColumn + " = " + oldColumn + " - 1";
+	if (newColumn)
+		query += string(", ") + newColumn + " = " + newColumn + " + " + Utils::toString(addedParticipants == 0 ? 1 : addedParticipants);
+	query += " WHERE event_id = :chatMessageId";
+	*dbSession.getBackendSession() << query, soci::use(addedParticipants), soci::use(chatMessageId);
+#endif
+}
+
 long long MainDbPrivate::insertConferenceInfo (const std::shared_ptr<ConferenceInfo> &conferenceInfo) {
 #ifdef HAVE_DB_STORAGE
 	if (!conferenceInfo->getOrganizer().isValid() || !conferenceInfo->getUri().isValid()) {
@@ -1106,6 +1164,117 @@ shared_ptr<EventLog> MainDbPrivate::selectConferenceChatMessageEvent (
 	);
 }
 
+template<typename T>
+static void fetchContentsAppData (
+	soci::session *session,
+	const string &eventIds,
+	const unordered_map<long long, Content *> &contents,
+	T &data
+) {
+	const string query = "SELECT chat_message_content_id, name, data FROM chat_message_content_app_data"
+		" WHERE chat_message_content_id IN (SELECT id FROM chat_message_content WHERE event_id IN (" + eventIds + "))";
+
+	long long contentId;
+	string name;
+	soci::statement statement = (session->prepare << query, soci::into(contentId), soci::into(name), soci::into(data));
+	statement.execute();
+	while (statement.fetch()) {
+		auto it = contents.find(contentId);
+		if (it != contents.cend())
+			it->second->setAppData(name, blobToString(data));
+	}
+}
+
+void MainDbPrivate::loadChatMessagesContents (const list<shared_ptr<ChatMessage>> &chatMessages) const {
+	L_Q();
+
+	// The ids are integers, they are inserted in the queries instead of binding one parameter per message.
+	string eventIds;
+	for (const auto &chatMessage : chatMessages) {
+		if (chatMessage->getPrivate()->areContentsLoaded() || chatMessage->getStorageId() <= 0)
+			continue;
+		if (!eventIds.empty())
+			eventIds += ",";
+		eventIds += Utils::toString(chatMessage->getStorageId());
+	}
+	if (eventIds.empty())
+		return;
+
+	soci::session *session = dbSession.getBackendSession();
+
+	unordered_map<long long, list<Content *>> contentsByEvent;
+	unordered_map<long long, Content *> contentsById;
+
+	// 1 - Fetch the contents with their file informations if they exist.
+	const string query = "SELECT chat_message_content.event_id, chat_message_content.id, content_type.value,"
+		"  chat_message_content.body, chat_message_content.body_encoding_type,"
+		"  chat_message_file_content.name, chat_message_file_content.size,"
+		"  chat_message_file_content.path, chat_message_file_content.duration"
+		" FROM chat_message_content"
+		" JOIN content_type ON content_type.id = chat_message_content.content_type_id"
+		" LEFT JOIN chat_message_file_content ON chat_message_file_content.chat_message_content_id = chat_message_content.id"
+		" WHERE chat_message_content.event_id IN (" + eventIds + ")"
+		" ORDER BY chat_message_content.id";
+	soci::rowset<soci::row> rows = (session->prepare << query);
+	for (const auto &row : rows) {
+		const long long &eventId = dbSession.resolveId(row, 0);
+		const long long &contentId = dbSession.resolveId(row, 1);
+		ContentType contentType(row.get<string>(2));
+		Content *content;
+
+		if (contentType == ContentType::FileTransfer)
+			content = new FileTransferContent();
+		else if (row.get_indicator(5) != soci::i_null) {
+			FileContent *fileContent = new FileContent();
+			fileContent->setFileName(row.get<string>(5));
+			fileContent->setFileSize(size_t(dbSession.getInteger(row, 6)));
+			fileContent->setFilePath(row.get<string>(7));
+			fileContent->setFileDuration(int(dbSession.getInteger(row, 8)));
+			content = fileContent;
+		} else
+			content = new Content();
+
+		content->setContentType(contentType);
+		if (row.get<int>(4) == 1)
+			content->setBodyFromUtf8(row.get<string>(3));
+		else
+			content->setBodyFromLocale(row.get<string>(3));
+
+		contentsByEvent[eventId].push_back(content);
+		contentsById[contentId] = content;
+	}
+
+	// 2 - Fetch the contents' app data.
+	if (!contentsById.empty()) {
+		// TODO: Do not test backend, encapsulate!!!
+		if (q->getBackend() == MainDb::Backend::Sqlite3) {
+			soci::blob data(*session);
+			fetchContentsAppData(session, eventIds, contentsById, data);
+		} else {
+			string data;
+			fetchContentsAppData(session, eventIds, contentsById, data);
+		}
+	}
+
+	// 3 - Give the contents to the messages, including the ones without contents so they are not loaded again.
+	for (const auto &chatMessage : chatMessages) {
+		ChatMessagePrivate *dChatMessage = chatMessage->getPrivate();
+		if (dChatMessage->areContentsLoaded() || chatMessage->getStorageId() <= 0)
+			continue;
+		auto it = contentsByEvent.find(chatMessage->getStorageId());
+		dChatMessage->setContentsLoadedFromDatabase(it != contentsByEvent.cend() ? it->second : list<Content *>());
+	}
+}
+
+void MainDbPrivate::loadChatMessagesContents (const list<shared_ptr<EventLog>> &events) const {
+	list<shared_ptr<ChatMessage>> chatMessages;
+	for (const auto &event : events) {
+		if (event->getType() == EventLog::Type::ConferenceChatMessage)
+			chatMessages.push_back(static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage());
+	}
+	loadChatMessagesContents(chatMessages);
+}
+
 shared_ptr<EventLog> MainDbPrivate::selectConferenceParticipantEvent (
 	const ConferenceId &conferenceId,
 	EventLog::Type type,
@@ -1361,10 +1530,14 @@ long long MainDbPrivate::insertConferenceChatMessageEvent (const shared_ptr<Even
 		insertContent(eventId, *content);
 
 	shared_ptr<AbstractChatRoom> chatRoom(chatMessage->getChatRoom());
+	int participantCount = 0;
 	for (const auto &participant : chatRoom->getParticipants()) {
 		const long long &participantSipAddressId = selectSipAddressId(participant->getAddress().asString());
 		insertChatMessageParticipant(eventId, participantSipAddressId, state, chatMessage->getTime());
+		participantCount++;
 	}
+	if (participantCount > 0)
+		updateChatMessageParticipantStateCounts(eventId, state, state, participantCount);
 
 	const long long &dbChatRoomId = selectChatRoomId(chatRoom->getConferenceId());
 	*dbSession.getBackendSession() << "UPDATE chat_room SET last_message_id = :1 WHERE id = :2", soci::use(eventId), soci::use(dbChatRoomId);
@@ -1660,18 +1833,34 @@ void MainDbPrivate::setChatMessageParticipantState (
 #ifdef HAVE_DB_STORAGE
 	const EventLogPrivate *dEventLog = eventLog->getPrivate();
 	MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
-	const long long &eventId = dEventKey->storageId;
+	setChatMessageParticipantState(dEventKey->storageId, participantAddress, state, stateChangeTime, false);
+#endif
+}
+
+bool MainDbPrivate::setChatMessageParticipantState (
+	long long eventId,
+	const IdentityAddress &participantAddress,
+	ChatMessage::State state,
+	time_t stateChangeTime,
+	bool checkTransition
+) {
+#ifdef HAVE_DB_STORAGE
 	const long long &participantSipAddressId = selectSipAddressId(participantAddress.asString());
 
 	/* setChatMessageParticipantState can be called by updateConferenceChatMessageEvent, which try to update participant state
 	 by message state. However, we can not change state Displayed/DeliveredToUser to Delivered/NotDelivered. */
-	int intState;
-	*dbSession.getBackendSession() << "SELECT state FROM chat_message_participant WHERE event_id = :eventId AND participant_sip_address_id = :participantSipAddressId",
+	int intState = 0;
+	soci::session *session = dbSession.getBackendSession();
+	*session << "SELECT state FROM chat_message_participant WHERE event_id = :eventId AND participant_sip_address_id = :participantSipAddressId",
 		soci::into(intState),  soci::use(eventId), soci::use(participantSipAddressId);
+	if (!session->got_data())
+		return false;
 	ChatMessage::State dbState = ChatMessage::State(intState);
+	if (checkTransition && !ChatMessagePrivate::isValidStateTransition(dbState, state))
+		return false;
 	if (int(state) < intState && (dbState == ChatMessage::State::Displayed || dbState == ChatMessage::State::DeliveredToUser)) {
 		lInfo() << "setChatMessageParticipantState: can not change state from " << dbState << " to " << state;
-		return;
+		return false;
 	}
 
 	
@@ -1682,6 +1871,10 @@ void MainDbPrivate::setChatMessageParticipantState (
 		" state_change_time = :stateChangeTm"
 		" WHERE event_id = :eventId AND participant_sip_address_id = :participantSipAddressId",
 		soci::use(stateInt), soci::use(stateChangeTm), soci::use(eventId), soci::use(participantSipAddressId);
+	updateChatMessageParticipantStateCounts(eventId, intState, stateInt);
+	return true;
+#else
+	return false;
 #endif
 }
 
@@ -2106,6 +2299,26 @@ void MainDbPrivate::updateSchema () {
 	if (version < makeVersion(1, 0, 17)) {
 		*session << "ALTER TABLE sip_address ADD COLUMN display_name VARCHAR(255)";
 	}
+
+	if (version < makeVersion(1, 0, 18)) {
+		*session << "ALTER TABLE conference_chat_message_event ADD COLUMN participant_count INT UNSIGNED NOT NULL DEFAULT 0";
+		*session << "ALTER TABLE conference_chat_message_event ADD COLUMN displayed_count INT UNSIGNED NOT NULL DEFAULT 0";
+		*session << "ALTER TABLE conference_chat_message_event ADD COLUMN delivered_to_user_count INT UNSIGNED NOT NULL DEFAULT 0";
+		*session << "ALTER TABLE conference_chat_message_event ADD COLUMN not_delivered_count INT UNSIGNED NOT NULL DEFAULT 0";
+		*session << "UPDATE conference_chat_message_event SET"
+			"  participant_count = (SELECT COUNT(*) FROM chat_message_participant WHERE event_id = conference_chat_message_event.event_id),"
+			"  displayed_count = (SELECT COUNT(*) FROM chat_message_participant WHERE event_id = conference_chat_message_event.event_id"
+			"    AND state = " + Utils::toString(int(ChatMessage::State::Displayed)) + "),"
+			"  delivered_to_user_count = (SELECT COUNT(*) FROM chat_message_participant WHERE event_id = conference_chat_message_event.event_id"
+			"    AND state = " + Utils::toString(int(ChatMessage::State::DeliveredToUser)) + "),"
+			"  not_delivered_count = (SELECT COUNT(*) FROM chat_message_participant WHERE event_id = conference_chat_message_event.event_id"
+			"    AND state = " + Utils::toString(int(ChatMessage::State::NotDelivered)) + ")";
+	}
+
+	if (version < makeVersion(1, 0, 19)) {
+		// Used by the history pagination of MainDb::getHistoryBefore().
+		*session << "CREATE INDEX conference_event_chat_room_index ON conference_event (chat_room_id, event_id)";
+	}
 #endif
 }
 
@@ -2366,6 +2579,7 @@ void MainDbPrivate::importLegacyHistory (DbSession &inDbSession) {
 				insertContent(eventId, *content);
 			insertChatRoomParticipant(chatRoomId, remoteSipAddressId, false);
 			insertChatMessageParticipant(eventId, remoteSipAddressId, state, std::time(nullptr));
+			updateChatMessageParticipantStateCounts(eventId, state, state, 1);
 		}
 		// Set last_message_id to the last timed message for all chat room
 		*dbSession.getBackendSession() << "UPDATE chat_room SET last_message_id = "
@@ -2460,6 +2674,35 @@ void MainDb::init () {
 	 * The mysql backend (used server-side) doesn't support this PRAGMA.
 	 */
 	
+	/* Journal mode, synchronous level and cache size of the sqlite3 database, see the [storage] section.
+	 * Unset settings keep the sqlite3 defaults. The journal mode can't be changed within a transaction.
+	 * journal_mode=wal allows the history to be read while messages are written.
+	 */
+	if (backend == Sqlite3) {
+		LinphoneConfig *config = linphone_core_get_config(getCore()->getCCore());
+		const string journalMode = L_C_TO_STRING(linphone_config_get_string(config, "storage", "journal_mode", nullptr));
+		const string synchronous = L_C_TO_STRING(linphone_config_get_string(config, "storage", "synchronous", nullptr));
+		const int cacheSize = linphone_config_get_int(config, "storage", "cache_size", 0);
+		try {
+			if (_linphone_sqlite3_is_pragma_value(journalMode.c_str())) {
+				string mode;
+				*session << "PRAGMA journal_mode = " + journalMode, soci::into(mode);
+				lInfo() << "Database journal mode: " << mode << ".";
+			} else if (!journalMode.empty())
+				lError() << "Invalid database journal mode: `" << journalMode << "`.";
+
+			if (_linphone_sqlite3_is_pragma_value(synchronous.c_str()))
+				*session << "PRAGMA synchronous = " + synchronous;
+			else if (!synchronous.empty())
+				lError() << "Invalid database synchronous level: `" << synchronous << "`.";
+
+			if (cacheSize != 0)
+				*session << "PRAGMA cache_size = " + Utils::toString(cacheSize);
+		} catch (const soci::soci_error &e) {
+			lError() << "Unable to set database options: " << e.what() << ".";
+		}
+	}
+
 	session->begin();
 	
 	try{
@@ -2935,6 +3178,8 @@ void MainDb::init () {
 		return;
 	}
 	session->commit();
+	// A statement prepared before a schema update may use a former definition of the tables.
+	d->dbSession.clearCachedStatements();
 #endif
 }
 
@@ -3532,6 +3777,43 @@ list<ChatMessage::State> MainDb::getChatMessageParticipantStates (const shared_p
 #endif
 }
 
+MainDb::ParticipantStateCounts MainDb::getChatMessageParticipantStateCounts (const shared_ptr<EventLog> &eventLog) const {
+#ifdef HAVE_DB_STORAGE
+	return L_DB_TRANSACTION {
+		L_D();
+
+		const EventLogPrivate *dEventLog = eventLog->getPrivate();
+		MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
+		return d->selectChatMessageParticipantStateCounts(dEventKey->storageId);
+	};
+#else
+	return ParticipantStateCounts();
+#endif
+}
+
+unordered_map<long long, MainDb::ParticipantStateCounts> MainDb::setChatMessageParticipantStates (list<ParticipantStateUpdate> &updates) {
+#ifdef HAVE_DB_STORAGE
+	return L_DB_TRANSACTION {
+		L_D();
+
+		unordered_map<long long, ParticipantStateCounts> counts;
+		for (auto &update : updates) {
+			const long long eventId = update.chatMessage->getStorageId();
+			update.applied = d->setChatMessageParticipantState(eventId, update.address, update.state, update.timestamp, true);
+			if (update.applied)
+				counts[eventId];
+		}
+		for (auto &messageCounts : counts)
+			messageCounts.second = d->selectChatMessageParticipantStateCounts(messageCounts.first);
+
+		tr.commit();
+		return counts;
+	};
+#else
+	return unordered_map<long long, ParticipantStateCounts>();
+#endif
+}
+
 ChatMessage::State MainDb::getChatMessageParticipantState (
 	const shared_ptr<EventLog> &eventLog,
 	const IdentityAddress &participantAddress
@@ -3849,8 +4131,6 @@ list<shared_ptr<EventLog>> MainDb::getHistoryRange (
 	FilterMask mask
 ) const {
 #ifdef HAVE_DB_STORAGE
-	L_D();
-
 	if (begin < 0)
 		begin = 0;
 
@@ -3860,19 +4140,6 @@ list<shared_ptr<EventLog>> MainDb::getHistoryRange (
 		return events;
 	}
 
-	string query = Statements::get(Statements::SelectConferenceEvents) + buildSqlEventFilter({
-		ConferenceCallFilter, ConferenceChatMessageFilter, ConferenceInfoFilter, ConferenceInfoNoDeviceFilter, ConferenceChatMessageSecurityFilter
-	}, mask, "AND");
-	query += " ORDER BY event_id DESC";
-
-	if (end > 0)
-		query += " LIMIT " + Utils::toString(end - begin);
-	else
-		query += " LIMIT " + d->dbSession.noLimitValue();
-
-	if (begin > 0)
-		query += " OFFSET " + Utils::toString(begin);
-
 	/*
 	DurationLogger durationLogger(
 		"Get history range of: (peer=" + conferenceId.getPeerAddress().asString() +
@@ -3888,14 +4155,28 @@ list<shared_ptr<EventLog>> MainDb::getHistoryRange (
 		if (!chatRoom)
 			return events;
 
-		const long long &dbChatRoomId = d->selectChatRoomId(conferenceId);
-		soci::rowset<soci::row> rows = (d->dbSession.getBackendSession()->prepare << query, soci::use(dbChatRoomId));
-		for (const auto &row : rows) {
-			shared_ptr<EventLog> event = d->selectGenericConferenceEvent(chatRoom, row);
+		// The range is bound, so that the same statement is used for all the pages of the history.
+		DbCachedStatement &cachedStatement = d->dbSession.getCachedStatement(
+			makeCachedStatementKey(CachedStatement::SelectHistoryRange, mask), 3, [mask] {
+				return Statements::get(Statements::SelectConferenceEvents) + buildSqlEventFilter({
+					ConferenceCallFilter, ConferenceChatMessageFilter, ConferenceInfoFilter, ConferenceInfoNoDeviceFilter, ConferenceChatMessageSecurityFilter
+				}, mask, "AND") + " ORDER BY event_id DESC LIMIT :limit OFFSET :offset";
+			}
+		);
+		cachedStatement.parameters[0] = d->selectChatRoomId(conferenceId);
+		cachedStatement.parameters[1] = end > 0 ? end - begin : numeric_limits<long long>::max();
+		cachedStatement.parameters[2] = begin;
+		cachedStatement.statement.execute();
+		while (cachedStatement.statement.fetch()) {
+			shared_ptr<EventLog> event = d->selectGenericConferenceEvent(chatRoom, cachedStatement.row);
 			if (event)
 				events.push_front(event);
 		}
 
+		// A page of the history is displayed: load the contents of its messages at once.
+		if (end > 0)
+			d->loadChatMessagesContents(events);
+
 		return events;
 	};
 #else
@@ -3903,20 +4184,89 @@ list<shared_ptr<EventLog>> MainDb::getHistoryRange (
 #endif
 }
 
-int MainDb::getHistorySize (const ConferenceId &conferenceId, FilterMask mask) const {
+list<shared_ptr<EventLog>> MainDb::getHistoryBefore (
+	const ConferenceId &conferenceId,
+	const shared_ptr<const EventLog> &lastEventLog,
+	int nLast,
+	FilterMask mask
+) const {
+	long long lastEventId = 0;
+	if (lastEventLog) {
+		const EventLogPrivate *dEventLog = lastEventLog->getPrivate();
+		if (!dEventLog->dbKey.isValid()) {
+			lWarning() << "Unable to get history before an event which is not stored.";
+			return list<shared_ptr<EventLog>>();
+		}
+		lastEventId = static_cast<const MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+	}
+	return getHistoryBefore(conferenceId, lastEventId, nLast, mask);
+}
+
+list<shared_ptr<EventLog>> MainDb::getHistoryBefore (
+	const ConferenceId &conferenceId,
+	long long lastEventId,
+	int nLast,
+	FilterMask mask
+) const {
 #ifdef HAVE_DB_STORAGE
-	const string query = "SELECT COUNT(*) FROM event, conference_event"
-		"  WHERE chat_room_id = :chatRoomId"
-		"  AND event_id = event.id" + buildSqlEventFilter({
-			ConferenceCallFilter, ConferenceChatMessageFilter, ConferenceInfoFilter, ConferenceInfoNoDeviceFilter, ConferenceChatMessageSecurityFilter
-		}, mask, "AND");
+	list<shared_ptr<EventLog>> events;
 
 	return L_DB_TRANSACTION {
 		L_D();
 
-		int count;
-		const long long &dbChatRoomId = d->selectChatRoomId(conferenceId);
-		*d->dbSession.getBackendSession() << query, soci::into(count), soci::use(dbChatRoomId);
+		shared_ptr<AbstractChatRoom> chatRoom = d->findChatRoom(conferenceId);
+		if (!chatRoom)
+			return events;
+
+		// The history of a chat room is walked from the given event with conference_event_chat_room_index,
+		// instead of skipping the more recent events with an OFFSET.
+		DbCachedStatement &cachedStatement = d->dbSession.getCachedStatement(
+			makeCachedStatementKey(CachedStatement::SelectHistoryBefore, mask), 3, [mask] {
+				return Statements::get(Statements::SelectConferenceEvents) + buildSqlEventFilter({
+					ConferenceCallFilter, ConferenceChatMessageFilter, ConferenceInfoFilter, ConferenceInfoNoDeviceFilter, ConferenceChatMessageSecurityFilter
+				}, mask, "AND") + " AND conference_event_view.id < :lastEventId ORDER BY event_id DESC LIMIT :limit";
+			}
+		);
+		cachedStatement.parameters[0] = d->selectChatRoomId(conferenceId);
+		cachedStatement.parameters[1] = lastEventId > 0 ? lastEventId : numeric_limits<long long>::max();
+		cachedStatement.parameters[2] = nLast > 0 ? nLast : numeric_limits<long long>::max();
+		cachedStatement.statement.execute();
+		while (cachedStatement.statement.fetch()) {
+			shared_ptr<EventLog> event = d->selectGenericConferenceEvent(chatRoom, cachedStatement.row);
+			if (event)
+				events.push_front(event);
+		}
+
+		if (nLast > 0)
+			d->loadChatMessagesContents(events);
+
+		return events;
+	};
+#else
+	return list<shared_ptr<EventLog>>();
+#endif
+}
+
+int MainDb::getHistorySize (const ConferenceId &conferenceId, FilterMask mask) const {
+#ifdef HAVE_DB_STORAGE
+	return L_DB_TRANSACTION {
+		L_D();
+
+		DbCachedStatement &cachedStatement = d->dbSession.getCachedStatement(
+			makeCachedStatementKey(CachedStatement::SelectHistorySize, mask), 1, [mask] {
+				return "SELECT COUNT(*) FROM event, conference_event"
+					"  WHERE chat_room_id = :chatRoomId"
+					"  AND event_id = event.id" + buildSqlEventFilter({
+						ConferenceCallFilter, ConferenceChatMessageFilter, ConferenceInfoFilter, ConferenceInfoNoDeviceFilter, ConferenceChatMessageSecurityFilter
+					}, mask, "AND");
+			}
+		);
+		cachedStatement.parameters[0] = d->selectChatRoomId(conferenceId);
+		cachedStatement.statement.execute();
+
+		int count = 0;
+		while (cachedStatement.statement.fetch())
+			count = int(d->dbSession.getInteger(cachedStatement.row, 0));
 
 		return count;
 	};
@@ -3961,88 +4311,11 @@ void MainDb::cleanHistory (const ConferenceId &conferenceId, FilterMask mask) {
 
 // -----------------------------------------------------------------------------
 
-#ifdef HAVE_DB_STORAGE
-template<typename T>
-static void fetchContentAppData (soci::session *session, Content &content, long long contentId, T &data) {
-	static const string query = "SELECT name, data FROM chat_message_content_app_data"
-		" WHERE chat_message_content_id = :contentId";
-
-	string name;
-	soci::statement statement = (session->prepare << query, soci::use(contentId), soci::into(name), soci::into(data));
-	statement.execute();
-	while (statement.fetch())
-		content.setAppData(name, blobToString(data));
-}
-#endif
-
 void MainDb::loadChatMessageContents (const shared_ptr<ChatMessage> &chatMessage) {
 #ifdef HAVE_DB_STORAGE
 	L_DB_TRANSACTION {
 		L_D();
-
-		soci::session *session = d->dbSession.getBackendSession();
-
-		bool hasFileTransferContent = false;
-
-		ChatMessagePrivate *dChatMessage = chatMessage->getPrivate();
-		const long long &eventId = chatMessage->getStorageId();
-
-		static const string query = "SELECT chat_message_content.id, content_type.id, content_type.value, body, body_encoding_type"
-			" FROM chat_message_content, content_type"
-			" WHERE event_id = :eventId AND content_type_id = content_type.id";
-		soci::rowset<soci::row> rows = (session->prepare << query, soci::use(eventId));
-		for (const auto &row : rows) {
-			ContentType contentType(row.get<string>(2));
-			const long long &contentId = d->dbSession.resolveId(row, 0);
-			Content *content;
-			int bodyEncodingType = row.get<int>(4);
-
-			if (contentType == ContentType::FileTransfer) {
-				hasFileTransferContent = true;
-				content = new FileTransferContent();
-			} else {
-				// 1.1 - Fetch contents' file informations if they exist
-				string name;
-				int size;
-				string path;
-				int duration;
-
-				*session << "SELECT name, size, path, duration FROM chat_message_file_content"
-					" WHERE chat_message_content_id = :contentId",
-					soci::into(name), soci::into(size), soci::into(path), soci::into(duration), soci::use(contentId);
-				if (session->got_data()) {
-					FileContent *fileContent = new FileContent();
-					fileContent->setFileName(name);
-					fileContent->setFileSize(size_t(size));
-					fileContent->setFilePath(path);
-					fileContent->setFileDuration(duration);
-					content = fileContent;
-				} else {
-					content = new Content();
-				}
-			}
-
-			content->setContentType(contentType);
-			if(bodyEncodingType == 1)
-				content->setBodyFromUtf8(row.get<string>(3));
-			else
-				content->setBodyFromLocale(row.get<string>(3));
-
-			// 1.2 - Fetch contents' app data.
-			// TODO: Do not test backend, encapsulate!!!
-			if (getBackend() == MainDb::Backend::Sqlite3) {
-				soci::blob data(*session);
-				fetchContentAppData(session, *content, contentId, data);
-			} else {
-				string data;
-				fetchContentAppData(session, *content, contentId, data);
-			}
-			chatMessage->addContent(content);
-		}
-
-		// 2 - Load external body url from body into FileTransferContent if needed.
-		if (hasFileTransferContent)
-			dChatMessage->loadFileTransferUrlFromBodyToContent();
+		d->loadChatMessagesContents(list<shared_ptr<ChatMessage>>{ chatMessage });
 	};
 #endif
 }
@@ -4099,6 +4372,15 @@ list<shared_ptr<AbstractChatRoom>> MainDb::getChatRooms () const {
 
 		soci::session *session = d->dbSession.getBackendSession();
 
+#ifdef HAVE_ADVANCED_IM
+		// The participants, devices and previous conference ids of all the chat rooms are fetched
+		// with one query each, instead of a few queries per chat room.
+		unordered_map<long long, vector<MainDbPrivate::ParticipantRow>> participantsByChatRoom;
+		unordered_map<long long, vector<MainDbPrivate::ParticipantDeviceRow>> devicesByParticipant;
+		unordered_map<long long, vector<string>> previousConferenceIdsByChatRoom;
+		d->selectChatRoomsParticipants(participantsByChatRoom, devicesByParticipant, previousConferenceIdsByChatRoom);
+#endif
+
 		soci::rowset<soci::row> rows = (session->prepare << query);
 		for (const auto &row : rows) {
 			ConferenceId conferenceId = ConferenceId(
@@ -4129,35 +4411,19 @@ list<shared_ptr<AbstractChatRoom>> MainDb::getChatRooms () const {
 #ifdef HAVE_ADVANCED_IM
 				list<shared_ptr<Participant>> participants;
 
-				static const string query = "SELECT chat_room_participant.id, sip_address.value, is_admin"
-					" FROM sip_address, chat_room, chat_room_participant"
-					" WHERE chat_room.id = :chatRoomId"
-					" AND sip_address.id = chat_room_participant.participant_sip_address_id"
-					" AND chat_room_participant.chat_room_id = chat_room.id";
-
-				// Fetch participants.
 				unsigned int lastNotifyId = d->dbSession.getUnsignedInt(row, 7, 0);
-				soci::rowset<soci::row> rows = (session->prepare << query, soci::use(dbChatRoomId));
 				shared_ptr<Participant> me;
-				for (const auto &row : rows) {
-					shared_ptr<Participant> participant = Participant::create(nullptr, IdentityAddress(row.get<string>(1)));
-					participant->setAdmin(!!row.get<int>(2));
-
-					// Fetch devices.
-					{
-						const long long &participantId = d->dbSession.resolveId(row, 0);
-						static const string query = "SELECT sip_address.value, state, name FROM chat_room_participant_device, sip_address"
-							" WHERE chat_room_participant_id = :participantId"
-							" AND participant_device_sip_address_id = sip_address.id";
-
-						soci::rowset<soci::row> rows = (session->prepare << query, soci::use(participantId));
-						for (const auto &row : rows) {
-							shared_ptr<ParticipantDevice> device = participant->addDevice(IdentityAddress(row.get<string>(0)), row.get<string>(2, ""));
-							device->setState(ParticipantDevice::State(static_cast<unsigned int>(row.get<int>(1, 0))));
-						}
+				const IdentityAddress localAddress = conferenceId.getLocalAddress().getAddressWithoutGruu();
+				for (const auto &participantRow : participantsByChatRoom[dbChatRoomId]) {
+					shared_ptr<Participant> participant = Participant::create(nullptr, IdentityAddress(participantRow.address));
+					participant->setAdmin(participantRow.isAdmin);
+
+					for (const auto &deviceRow : devicesByParticipant[participantRow.id]) {
+						shared_ptr<ParticipantDevice> device = participant->addDevice(IdentityAddress(deviceRow.address), deviceRow.name);
+						device->setState(ParticipantDevice::State(deviceRow.state));
 					}
 
-					if (participant->getAddress() == conferenceId.getLocalAddress().getAddressWithoutGruu())
+					if (participant->getAddress() == localAddress)
 						me = participant;
 					else
 						participants.push_back(participant);
@@ -4193,13 +4459,8 @@ list<shared_ptr<AbstractChatRoom>> MainDb::getChatRooms () const {
 					);
 
 					if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::OneToOne)) {
-						// TODO: load previous IDs if any
-						static const string query = "SELECT sip_address.value FROM one_to_one_chat_room_previous_conference_id, sip_address"
-							" WHERE chat_room_id = :chatRoomId"
-							" AND sip_address_id = sip_address.id";
-						soci::rowset<soci::row> rows = (session->prepare << query, soci::use(dbChatRoomId));
-						for (const auto &row : rows) {
-							ConferenceId previousId = ConferenceId(ConferenceAddress(row.get<string>(0)), conferenceId.getLocalAddress());
+						for (const auto &previousPeerAddress : previousConferenceIdsByChatRoom[dbChatRoomId]) {
+							ConferenceId previousId = ConferenceId(ConferenceAddress(previousPeerAddress), conferenceId.getLocalAddress());
 							if (previousId != conferenceId) {
 								lInfo() << "Keeping around previous chat room ID [" << previousId << "] in case BYE is received for exhumed chat room [" << conferenceId << "]";
 								clientGroupChatRoom->getPrivate()->addConferenceIdToPreviousList(previousId);
@@ -4254,6 +4515,45 @@ list<shared_ptr<AbstractChatRoom>> MainDb::getChatRooms () const {
 #endif
 }
 
+void MainDbPrivate::selectChatRoomsParticipants (
+	unordered_map<long long, vector<ParticipantRow>> &participantsByChatRoom,
+	unordered_map<long long, vector<ParticipantDeviceRow>> &devicesByParticipant,
+	unordered_map<long long, vector<string>> &previousConferenceIdsByChatRoom
+) const {
+#ifdef HAVE_DB_STORAGE
+	static const string participantsQuery = "SELECT chat_room_participant.chat_room_id, chat_room_participant.id, sip_address.value, is_admin"
+		" FROM chat_room_participant, sip_address"
+		" WHERE sip_address.id = chat_room_participant.participant_sip_address_id"
+		" ORDER BY chat_room_participant.id";
+	static const string devicesQuery = "SELECT chat_room_participant_id, sip_address.value, state, name"
+		" FROM chat_room_participant_device, sip_address"
+		" WHERE participant_device_sip_address_id = sip_address.id";
+	static const string previousConferenceIdsQuery = "SELECT chat_room_id, sip_address.value"
+		" FROM one_to_one_chat_room_previous_conference_id, sip_address"
+		" WHERE sip_address_id = sip_address.id";
+
+	soci::session *session = dbSession.getBackendSession();
+
+	soci::rowset<soci::row> participantRows = (session->prepare << participantsQuery);
+	for (const auto &row : participantRows) {
+		participantsByChatRoom[dbSession.resolveId(row, 0)].push_back({
+			dbSession.resolveId(row, 1), row.get<string>(2), !!row.get<int>(3)
+		});
+	}
+
+	soci::rowset<soci::row> deviceRows = (session->prepare << devicesQuery);
+	for (const auto &row : deviceRows) {
+		devicesByParticipant[dbSession.resolveId(row, 0)].push_back({
+			row.get<string>(1), static_cast<unsigned int>(row.get<int>(2, 0)), row.get<string>(3, "")
+		});
+	}
+
+	soci::rowset<soci::row> previousConferenceIdRows = (session->prepare << previousConferenceIdsQuery);
+	for (const auto &row : previousConferenceIdRows)
+		previousConferenceIdsByChatRoom[dbSession.resolveId(row, 0)].push_back(row.get<string>(1));
+#endif
+}
+
 void MainDbPrivate::insertNewPreviousConferenceId(const ConferenceId& currentConfId, const ConferenceId& previousConfId) {
 #ifdef HAVE_DB_STORAGE
 	const long long &previousConferenceSipAddressId = selectSipAddressId(previousConfId.getPeerAddress().asString());
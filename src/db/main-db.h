@@ -20,8 +20,9 @@
 #ifndef _L_MAIN_DB_H_
 #define _L_MAIN_DB_H_
 
-#include <memory>
 #include <functional>
+#include <memory>
+#include <unordered_map>
 
 #include "linphone/utils/enum-mask.h"
 
@@ -73,6 +74,25 @@ public:
 		time_t timestamp = 0;
 	};
 
+	// Number of participants of a chat message in the states defining its aggregate state.
+	struct ParticipantStateCounts {
+		int total = 0;
+		int displayed = 0;
+		int deliveredToUser = 0;
+		int notDelivered = 0;
+	};
+
+	struct ParticipantStateUpdate {
+		ParticipantStateUpdate (const std::shared_ptr<ChatMessage> &chatMessage, const IdentityAddress &address, ChatMessage::State state, time_t timestamp)
+			: chatMessage(chatMessage), address(address), state(state), timestamp(timestamp) {}
+
+		std::shared_ptr<ChatMessage> chatMessage;
+		IdentityAddress address;
+		ChatMessage::State state;
+		time_t timestamp;
+		bool applied = false; // Set by setChatMessageParticipantStates.
+	};
+
 	MainDb (const std::shared_ptr<Core> &core);
 
 	// ---------------------------------------------------------------------------
@@ -116,6 +136,7 @@ public:
 		ChatMessage::State state
 	) const;
 	std::list<ChatMessage::State> getChatMessageParticipantStates (const std::shared_ptr<EventLog> &eventLog) const;
+	ParticipantStateCounts getChatMessageParticipantStateCounts (const std::shared_ptr<EventLog> &eventLog) const;
 	ChatMessage::State getChatMessageParticipantState (
 		const std::shared_ptr<EventLog> &eventLog,
 		const IdentityAddress &participantAddress
@@ -127,6 +148,9 @@ public:
 		time_t stateChangeTime
 	);
 
+	// Applies the valid state transitions in one transaction, returns the state counts of the updated chat messages by storage id.
+	std::unordered_map<long long, ParticipantStateCounts> setChatMessageParticipantStates (std::list<ParticipantStateUpdate> &updates);
+
 	std::list<std::shared_ptr<ChatMessage>> getEphemeralMessages () const;
 
 	bool isChatRoomEmpty (const ConferenceId &conferenceId) const;
@@ -162,6 +186,21 @@ public:
 		FilterMask mask = NoFilter
 	) const;
 
+	// Keyset pagination: the nLast events older than the given one, the most recent ones if it is null.
+	// Unlike getHistoryRange(), the cost doesn't depend on the position of the page in the history.
+	std::list<std::shared_ptr<EventLog>> getHistoryBefore (
+		const ConferenceId &conferenceId,
+		const std::shared_ptr<const EventLog> &lastEventLog,
+		int nLast,
+		FilterMask mask = NoFilter
+	) const;
+	std::list<std::shared_ptr<EventLog>> getHistoryBefore (
+		const ConferenceId &conferenceId,
+		long long lastEventId,
+		int nLast,
+		FilterMask mask = NoFilter
+	) const;
+
 	int getHistorySize (const ConferenceId &conferenceId, FilterMask mask = NoFilter) const;
 
 	void cleanHistory (const ConferenceId &conferenceId, FilterMask mask = NoFilter);
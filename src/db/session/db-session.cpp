@@ -17,6 +17,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
+
 #include "linphone/utils/utils.h"
 
 #include "sqlite3_bctbx_vfs.h"
@@ -38,8 +40,30 @@ public:
 	} backend = Backend::None;
 
 	std::unique_ptr<soci::session> backendSession;
+
+	// Destroyed before the session.
+	std::unordered_map<std::uint64_t, std::unique_ptr<DbCachedStatement>> cachedStatements;
+	std::uint64_t prepareCount = 0;
+	std::uint64_t executionCount = 0;
 };
 
+// -----------------------------------------------------------------------------
+
+namespace {
+	soci::statement prepareStatement (soci::session &session, const string &query, soci::row &row, vector<long long> &parameters) {
+		soci::details::prepare_temp_type prepare = (session.prepare << query);
+		prepare, soci::into(row);
+		for (long long &parameter : parameters)
+			prepare, soci::use(parameter);
+		return soci::statement(prepare);
+	}
+}
+
+DbCachedStatement::DbCachedStatement (soci::session &session, const string &query, size_t parametersCount) :
+	parameters(parametersCount), statement(prepareStatement(session, query, row, parameters)) {}
+
+// -----------------------------------------------------------------------------
+
 DbSession::DbSession () : mPrivate(new DbSessionPrivate) {}
 
 DbSession::DbSession (const string &uri) : DbSession() {
@@ -290,6 +314,45 @@ unsigned int DbSession::getUnsignedInt (const soci::row &row, const std::size_t
 	return 0;
 }
 
+DbCachedStatement &DbSession::getCachedStatement (
+	uint64_t key,
+	size_t parametersCount,
+	const function<string ()> &buildQuery
+) {
+	L_D();
+
+	d->executionCount++;
+	auto it = d->cachedStatements.find(key);
+	if (it != d->cachedStatements.end())
+		return *it->second;
+
+	// Not cached if the preparation fails: the soci error is thrown before the insertion.
+	unique_ptr<DbCachedStatement> cachedStatement = makeUnique<DbCachedStatement>(*d->backendSession, buildQuery(), parametersCount);
+	d->prepareCount++;
+	return *d->cachedStatements.emplace(key, move(cachedStatement)).first->second;
+}
+
+void DbSession::clearCachedStatements () {
+	L_D();
+	d->cachedStatements.clear();
+}
+
+DbSession::CachedStatementsStats DbSession::getCachedStatementsStats () const {
+	L_D();
+	return { d->prepareCount, d->executionCount, d->cachedStatements.size() };
+}
+
+long long DbSession::getInteger (const soci::row &row, std::size_t col) const {
+	switch (row.get_properties(col).get_data_type()) {
+		case soci::dt_long_long:
+			return row.get<long long>(col);
+		case soci::dt_unsigned_long_long:
+			return static_cast<long long>(row.get<unsigned long long>(col));
+		default:
+			return static_cast<long long>(row.get<int>(col));
+	}
+}
+
 time_t DbSession::getTime (const soci::row &row, int col) const {
 	L_D();
 
@@ -20,6 +20,10 @@
 #ifndef _L_DB_SESSION_H_
 #define _L_DB_SESSION_H_
 
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 #include <soci/soci.h>
 
 #include "linphone/utils/general.h"
@@ -30,6 +34,20 @@ LINPHONE_BEGIN_NAMESPACE
 
 class DbSessionPrivate;
 
+// Statement prepared once by a DbSession, executed again with new values of its parameters.
+// It must be fetched until the end before being executed again, so that SQLite releases it.
+class DbCachedStatement {
+public:
+	DbCachedStatement (soci::session &session, const std::string &query, std::size_t parametersCount);
+	DbCachedStatement (const DbCachedStatement &other) = delete;
+
+	// Values of the parameters, bound in the order of the placeholders of the query.
+	std::vector<long long> parameters;
+	// Values of the current row, set by each fetch.
+	soci::row row;
+	soci::statement statement;
+};
+
 class DbSession {
 public:
 	DbSession ();
@@ -64,6 +82,25 @@ public:
 
 	unsigned int getUnsignedInt (const soci::row &row, std::size_t col, const unsigned int def = 0) const;
 
+	// Value of an integer column whose type depends on the backend, like COUNT(*).
+	long long getInteger (const soci::row &row, std::size_t col) const;
+
+	struct CachedStatementsStats {
+		std::uint64_t prepareCount;
+		std::uint64_t executionCount;
+		std::size_t size;
+	};
+
+	// Returns the statement cached with this key, the query is only built and prepared by the first call.
+	// Each call is counted as one execution of the statement.
+	DbCachedStatement &getCachedStatement (
+		std::uint64_t key,
+		std::size_t parametersCount,
+		const std::function<std::string ()> &buildQuery
+	);
+	void clearCachedStatements ();
+	CachedStatementsStats getCachedStatementsStats () const;
+
 private:
 	DbSessionPrivate *mPrivate;
 
@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+#include "async-log-sink.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	constexpr chrono::milliseconds FlushInterval(50);
+	constexpr chrono::milliseconds FlushPollInterval(1);
+	constexpr size_t MaxBatchSize = 64 * 1024;
+
+	const char *levelToString (BctbxLogLevel level) {
+		switch (level) {
+			case BCTBX_LOG_DEBUG:
+				return "DEBUG";
+			case BCTBX_LOG_TRACE:
+				return "TRACE";
+			case BCTBX_LOG_MESSAGE:
+				return "MESSAGE";
+			case BCTBX_LOG_WARNING:
+				return "WARNING";
+			case BCTBX_LOG_ERROR:
+				return "ERROR";
+			case BCTBX_LOG_FATAL:
+				return "FATAL";
+			default:
+				break;
+		}
+		return "undef";
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+AsyncLogSink::AsyncLogSink (const string &path, size_t capacity, OverflowPolicy policy) :
+	mPolicy(policy), mEnqueuePosition(0), mWrittenCount(0), mDroppedCount(0) {
+	if (path.empty())
+		mFile = stdout;
+	else {
+		mFile = fopen(path.c_str(), "a");
+		mOwnsFile = true;
+	}
+
+	size_t size = 1;
+	while (size < capacity)
+		size <<= 1;
+	mSlots.reset(new Slot[size]);
+	for (size_t i = 0; i < size; ++i)
+		mSlots[i].sequence.store(i, memory_order_relaxed);
+	mMask = size - 1;
+
+	if (mFile)
+		mThread = thread(&AsyncLogSink::run, this);
+}
+
+AsyncLogSink::~AsyncLogSink () {
+	if (mThread.joinable()) {
+		{
+			lock_guard<mutex> lock(mMutex);
+			mStopped = true;
+		}
+		mWriterCondition.notify_one();
+		mThread.join();
+	}
+	if (mFile && mOwnsFile)
+		fclose(mFile);
+}
+
+bool AsyncLogSink::isValid () const {
+	return mFile != nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+void AsyncLogSink::log (const char *domain, BctbxLogLevel level, const char *fmt, va_list args) {
+	if (!mFile)
+		return;
+
+	const bool fatal = (level == BCTBX_LOG_FATAL);
+	uint64_t position;
+	while (!tryPush(domain, level, fmt, args, position)) {
+		wakeUpWriter();
+		// A fatal record is never dropped: the process is about to abort.
+		if (mPolicy == OverflowPolicy::Drop && !fatal) {
+			mDroppedCount.fetch_add(1, memory_order_relaxed);
+			return;
+		}
+		this_thread::yield();
+	}
+
+	if (fatal)
+		flush();
+	else if (((position + 1) & (mMask >> 1)) == 0)
+		// Half of the buffer has been filled since the last wake up, don't wait for the next flush interval.
+		wakeUpWriter();
+}
+
+void AsyncLogSink::flush () {
+	if (!mFile)
+		return;
+
+	const uint64_t position = mEnqueuePosition.load(memory_order_acquire);
+	unique_lock<mutex> lock(mMutex);
+	mFlushRequestPosition = max(mFlushRequestPosition, position);
+	mWriterCondition.notify_one();
+	mFlushedCondition.wait(lock, [this, position] { return mFlushedPosition >= position || mStopped; });
+}
+
+uint64_t AsyncLogSink::getWrittenCount () const {
+	return mWrittenCount.load(memory_order_relaxed);
+}
+
+uint64_t AsyncLogSink::getDroppedCount () const {
+	return mDroppedCount.load(memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+// Bounded multi-producer queue: a slot is free for the position equal to its sequence,
+// and holds the record of a position once its sequence is this position + 1.
+bool AsyncLogSink::tryPush (const char *domain, BctbxLogLevel level, const char *fmt, va_list args, uint64_t &position) {
+	uint64_t pos = mEnqueuePosition.load(memory_order_relaxed);
+	Slot *slot;
+	for (;;) {
+		slot = &mSlots[pos & mMask];
+		const int64_t diff = int64_t(slot->sequence.load(memory_order_acquire) - pos);
+		if (diff == 0) {
+			if (mEnqueuePosition.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+				break;
+		} else if (diff < 0)
+			return false; // Full.
+		else
+			pos = mEnqueuePosition.load(memory_order_relaxed);
+	}
+
+	slot->level = level;
+	ortp_gettimeofday(&slot->time, nullptr);
+	slot->domain.assign(domain ? domain : "");
+
+	// Format in place, the string of the slot keeps its capacity from one record to the next.
+	string &text = slot->text;
+	text.resize(text.capacity());
+	va_list copy;
+	va_copy(copy, args);
+	int length = vsnprintf(&text[0], text.size() + 1, fmt, copy);
+	va_end(copy);
+	if (length < 0)
+		length = 0;
+	if (size_t(length) > text.size()) {
+		text.resize(min(size_t(length), MaxTextLength));
+		va_copy(copy, args);
+		vsnprintf(&text[0], text.size() + 1, fmt, copy);
+		va_end(copy);
+	}
+	text.resize(min(size_t(length), text.size()));
+
+	slot->sequence.store(pos + 1, memory_order_release);
+	position = pos;
+	return true;
+}
+
+void AsyncLogSink::wakeUpWriter () {
+	// Not locked on purpose: a missed notification only delays the write until the next flush interval.
+	mWriterCondition.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+
+void AsyncLogSink::run () {
+	string batch;
+	batch.reserve(MaxBatchSize + 1024);
+
+	unique_lock<mutex> lock(mMutex);
+	for (;;) {
+		const bool stopped = mStopped;
+		lock.unlock();
+
+		size_t count;
+		do {
+			batch.clear();
+			count = drain(batch);
+			if (count > 0) {
+				fwrite(batch.data(), 1, batch.size(), mFile);
+				mWrittenCount.fetch_add(count, memory_order_relaxed);
+			}
+		} while (count > 0);
+		fflush(mFile);
+
+		lock.lock();
+		mFlushedPosition = mDequeuePosition;
+		mFlushedCondition.notify_all();
+		if (stopped)
+			break;
+		// A record being formatted by a logging thread may delay a flush, check again soon in this case.
+		mWriterCondition.wait_for(lock, mFlushRequestPosition > mFlushedPosition ? FlushPollInterval : FlushInterval);
+	}
+}
+
+size_t AsyncLogSink::drain (string &batch) {
+	size_t count = 0;
+	while (batch.size() < MaxBatchSize) {
+		Slot &slot = mSlots[mDequeuePosition & mMask];
+		if (slot.sequence.load(memory_order_acquire) != mDequeuePosition + 1)
+			break;
+		appendRecord(batch, slot);
+		slot.sequence.store(mDequeuePosition + mMask + 1, memory_order_release);
+		++mDequeuePosition;
+		++count;
+	}
+	return count;
+}
+
+void AsyncLogSink::appendRecord (string &batch, const Slot &slot) const {
+	time_t seconds = (time_t)slot.time.tv_sec;
+	struct tm lt;
+#ifdef _WIN32
+	localtime_s(&lt, &seconds);
+#else
+	localtime_r(&seconds, &lt);
+#endif
+
+	char header[64];
+	int length = snprintf(header, sizeof(header), "%i-%.2i-%.2i %.2i:%.2i:%.2i:%.3i ",
+		1900 + lt.tm_year, lt.tm_mon + 1, lt.tm_mday, lt.tm_hour, lt.tm_min, lt.tm_sec, (int)(slot.time.tv_usec / 1000));
+	if (length > 0)
+		batch.append(header, min(size_t(length), sizeof(header) - 1));
+	batch += '[';
+	batch += slot.domain;
+	batch += "] ";
+	batch += levelToString(slot.level);
+	batch += ' ';
+	batch += slot.text;
+	batch += '\n';
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_ASYNC_LOG_SINK_H_
+#define _L_ASYNC_LOG_SINK_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <bctoolbox/logging.h>
+#include <ortp/port.h>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Log output written by a dedicated thread.
+ * The logging threads format their records into the slots of a bounded lock-free ring buffer,
+ * the writer thread drains it and writes the records in batches, with one write per batch.
+ * A fatal record is written and flushed before the logging thread returns.
+ */
+class AsyncLogSink {
+public:
+	enum class OverflowPolicy {
+		Drop, // A record logged while the buffer is full is lost and counted.
+		Block // The logging thread waits for the writer to free a slot.
+	};
+
+	/**
+	 * @param[in] path file where the records are appended, stdout if empty
+	 * @param[in] capacity maximum number of records waiting for the writer, rounded up to a power of two
+	 * @param[in] policy what to do with a record logged while the buffer is full
+	 **/
+	AsyncLogSink (const std::string &path, size_t capacity, OverflowPolicy policy);
+	AsyncLogSink (const AsyncLogSink &other) = delete;
+	// Writes the pending records.
+	~AsyncLogSink ();
+
+	/**
+	 * @return false if the output file can't be opened, nothing is logged in this case
+	 **/
+	bool isValid () const;
+
+	/**
+	 * Queue a record. Can be called from any thread, but not from the writer thread.
+	 **/
+	void log (const char *domain, BctbxLogLevel level, const char *fmt, va_list args);
+
+	/**
+	 * Wait until the records queued before the call are written and flushed.
+	 **/
+	void flush ();
+
+	uint64_t getWrittenCount () const;
+	uint64_t getDroppedCount () const;
+
+private:
+	struct Slot {
+		std::atomic<uint64_t> sequence;
+		BctbxLogLevel level;
+		struct timeval time;
+		std::string domain;
+		std::string text;
+	};
+
+	static constexpr size_t MaxTextLength = 64 * 1024;
+
+	bool tryPush (const char *domain, BctbxLogLevel level, const char *fmt, va_list args, uint64_t &position);
+	void run ();
+	size_t drain (std::string &batch);
+	void appendRecord (std::string &batch, const Slot &slot) const;
+	void wakeUpWriter ();
+
+	FILE *mFile = nullptr;
+	bool mOwnsFile = false;
+	OverflowPolicy mPolicy;
+
+	std::unique_ptr<Slot[]> mSlots;
+	size_t mMask;
+	std::atomic<uint64_t> mEnqueuePosition;
+	uint64_t mDequeuePosition = 0; // Only used by the writer thread.
+
+	std::atomic<uint64_t> mWrittenCount;
+	std::atomic<uint64_t> mDroppedCount;
+
+	// Only used to put the writer thread to sleep and to wait for a flush, never taken to queue a record.
+	std::mutex mMutex;
+	std::condition_variable mWriterCondition;
+	std::condition_variable mFlushedCondition;
+	uint64_t mFlushedPosition = 0;
+	uint64_t mFlushRequestPosition = 0;
+	bool mStopped = false;
+
+	std::thread mThread;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_ASYNC_LOG_SINK_H_
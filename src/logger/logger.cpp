@@ -18,6 +18,9 @@
  */
 
 #include <chrono>
+#include <streambuf>
+#include <string>
+#include <vector>
 
 #include <bctoolbox/logging.h>
 
@@ -33,48 +36,139 @@ LINPHONE_BEGIN_NAMESPACE
 
 // -----------------------------------------------------------------------------
 
-class LoggerPrivate : public BaseObjectPrivate {
+// Output of a Logger: appends to a string which keeps its capacity from one message to the next.
+class LogStreamBuffer : public streambuf {
 public:
-	Logger::Level level;
-	ostringstream os;
+	string data;
+
+protected:
+	int_type overflow (int_type c) override {
+		if (!traits_type::eq_int_type(c, traits_type::eof()))
+			data.push_back(traits_type::to_char_type(c));
+		return traits_type::not_eof(c);
+	}
+
+	streamsize xsputn (const char *s, streamsize n) override {
+		data.append(s, size_t(n));
+		return n;
+	}
+};
+
+class LogStream : private LogStreamBuffer, public ostream {
+public:
+	LogStream () : ostream(static_cast<LogStreamBuffer *>(this)) {
+		data.reserve(InitialCapacity);
+	}
+
+	const string &str () const {
+		return data;
+	}
+
+	// Restores the state of a new stream, a previous message may have changed its flags.
+	void reset () {
+		if (data.capacity() > MaxCapacity)
+			string().swap(data);
+		data.clear();
+		clear();
+		flags(ios_base::skipws | ios_base::dec);
+		precision(6);
+		width(0);
+		fill(' ');
+	}
+
+private:
+	static constexpr size_t InitialCapacity = 256;
+	static constexpr size_t MaxCapacity = 64 * 1024;
+};
+
+// Streams of the messages of a thread. Several of them can be used at the same time by nested or DurationLogger messages.
+class LogStreamPool {
+public:
+	~LogStreamPool () {
+		destroyed = true;
+	}
+
+	static unique_ptr<LogStream> acquire () {
+		unique_ptr<LogStream> stream;
+		if (!destroyed && !pool.streams.empty()) {
+			stream = move(pool.streams.back());
+			pool.streams.pop_back();
+			stream->reset();
+		} else
+			stream.reset(new LogStream);
+		return stream;
+	}
+
+	static void release (unique_ptr<LogStream> stream) {
+		// Logs sent at thread exit, after the destruction of the pool, are not recycled.
+		if (!destroyed && pool.streams.size() < MaxSize)
+			pool.streams.push_back(move(stream));
+	}
+
+private:
+	static constexpr size_t MaxSize = 4;
+
+	vector<unique_ptr<LogStream>> streams;
+
+	static thread_local bool destroyed;
+	static thread_local LogStreamPool pool;
 };
 
+thread_local bool LogStreamPool::destroyed = false;
+thread_local LogStreamPool LogStreamPool::pool;
+
 // -----------------------------------------------------------------------------
 
-Logger::Logger (Level level) : BaseObject(*new LoggerPrivate) {
-	L_D();
-	d->level = level;
-}
+Logger::Logger (Level level) : mLevel(level), mStream(LogStreamPool::acquire()) {}
 
 Logger::~Logger () {
-	L_D();
-
-	const string str = d->os.str();
+	const char *str = mStream->str().c_str();
 
-	switch (d->level) {
+	switch (mLevel) {
 		case Debug:
 			#if DEBUG_LOGS
-				bctbx_debug("%s", str.c_str());
+				bctbx_debug("%s", str);
 			#endif // if DEBUG_LOGS
 			break;
 		case Info:
-			bctbx_message("%s", str.c_str());
+			bctbx_message("%s", str);
 			break;
 		case Warning:
-			bctbx_warning("%s", str.c_str());
+			bctbx_warning("%s", str);
 			break;
 		case Error:
-			bctbx_error("%s", str.c_str());
+			bctbx_error("%s", str);
 			break;
 		case Fatal:
-			bctbx_fatal("%s", str.c_str());
+			bctbx_fatal("%s", str);
 			break;
 	}
+
+	LogStreamPool::release(move(mStream));
 }
 
-ostringstream &Logger::getOutput () {
-	L_D();
-	return d->os;
+ostream &Logger::getOutput () {
+	return *mStream;
+}
+
+bool Logger::isEnabled (Level level) {
+	switch (level) {
+		case Debug:
+			#if DEBUG_LOGS
+				return !!bctbx_log_level_enabled(BCTBX_LOG_DOMAIN, BCTBX_LOG_DEBUG);
+			#else
+				return false;
+			#endif // if DEBUG_LOGS
+		case Info:
+			return !!bctbx_log_level_enabled(BCTBX_LOG_DOMAIN, BCTBX_LOG_MESSAGE);
+		case Warning:
+			return !!bctbx_log_level_enabled(BCTBX_LOG_DOMAIN, BCTBX_LOG_WARNING);
+		case Error:
+			return !!bctbx_log_level_enabled(BCTBX_LOG_DOMAIN, BCTBX_LOG_ERROR);
+		case Fatal:
+			break;
+	}
+	return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -20,6 +20,8 @@
 #ifndef _L_LOGGER_H_
 #define _L_LOGGER_H_
 
+#include <memory>
+#include <ostream>
 #include <sstream>
 
 #include "object/base-object.h"
@@ -28,9 +30,10 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
-class LoggerPrivate;
+class LogStream;
 
-class LINPHONE_PUBLIC Logger : public BaseObject {
+// Not a BaseObject: it is instantiated for each log message and must not allocate.
+class LINPHONE_PUBLIC Logger {
 public:
 	enum Level {
 		Debug,
@@ -43,13 +46,30 @@ public:
 	explicit Logger (Level level);
 	~Logger ();
 
-	std::ostringstream &getOutput ();
+	/**
+	 * @return the stream to format the message into, reused by the next messages of the thread
+	 **/
+	std::ostream &getOutput ();
+
+	/**
+	 * @param[in] level the level of a message
+	 * @return whether a message of this level is emitted, so that it is formatted only in this case
+	 **/
+	static bool isEnabled (Level level);
 
 private:
-	L_DECLARE_PRIVATE(Logger);
+	Level mLevel;
+	std::unique_ptr<LogStream> mStream;
+
 	L_DISABLE_COPY(Logger);
 };
 
+// Turns a log statement into a void expression, see L_LOG().
+class LogVoidify {
+public:
+	void operator& (std::ostream &) {}
+};
+
 class DurationLoggerPrivate;
 
 class DurationLogger : public BaseObject {
@@ -64,11 +84,23 @@ private:
 
 LINPHONE_END_NAMESPACE
 
-#define lDebug() LinphonePrivate::Logger(LinphonePrivate::Logger::Debug).getOutput()
-#define lInfo() LinphonePrivate::Logger(LinphonePrivate::Logger::Info).getOutput()
-#define lWarning() LinphonePrivate::Logger(LinphonePrivate::Logger::Warning).getOutput()
-#define lError() LinphonePrivate::Logger(LinphonePrivate::Logger::Error).getOutput()
-#define lFatal() LinphonePrivate::Logger(LinphonePrivate::Logger::Fatal).getOutput()
+// The operands of the stream are not evaluated when the level is disabled.
+#define L_LOG(LEVEL) \
+	!LinphonePrivate::Logger::isEnabled(LEVEL) ? (void)0 : \
+	LinphonePrivate::LogVoidify() & LinphonePrivate::Logger(LEVEL).getOutput()
+
+#if DEBUG_LOGS
+	#define lDebug() L_LOG(LinphonePrivate::Logger::Debug)
+#else
+	// Still compiled, never evaluated.
+	#define lDebug() \
+		true ? (void)0 : \
+		LinphonePrivate::LogVoidify() & LinphonePrivate::Logger(LinphonePrivate::Logger::Debug).getOutput()
+#endif // if DEBUG_LOGS
+#define lInfo() L_LOG(LinphonePrivate::Logger::Info)
+#define lWarning() L_LOG(LinphonePrivate::Logger::Warning)
+#define lError() L_LOG(LinphonePrivate::Logger::Error)
+#define lFatal() L_LOG(LinphonePrivate::Logger::Fatal)
 
 #define L_BEGIN_LOG_EXCEPTION try {
 
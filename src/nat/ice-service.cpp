@@ -23,6 +23,7 @@
 #include "c-wrapper/internal/c-tools.h"
 #include "conference/session/streams.h"
 #include "conference/session/media-session-p.h"
+#include "core/core-p.h"
 #include "utils/if-addrs.h"
 
 #if defined(__APPLE__)
@@ -213,7 +214,7 @@ LinphoneCore *IceService::getCCore()const{
 }
 
 int IceService::gatherLocalCandidates(){
-	list<string> localAddrs = IfAddrs::fetchLocalAddresses();
+	list<string> localAddrs = L_GET_PRIVATE_FROM_C_OBJECT(getCCore())->getIfAddrsCache().getLocalAddresses();
 	bool ipv6Allowed = linphone_core_ipv6_enabled(getCCore());
 	const auto & mediaLocalIp = getMediaSessionPrivate().getMediaLocalIp();
 	const auto it = std::find(localAddrs.cbegin(), localAddrs.cend(), mediaLocalIp);
@@ -824,7 +825,7 @@ bool IceService::reinviteNeedsDeferedResponse(const std::shared_ptr<SalMediaDesc
 }
 
 bool IceService::hasLocalNetworkPermission(){
-	return hasLocalNetworkPermission(IfAddrs::fetchLocalAddresses());
+	return hasLocalNetworkPermission(L_GET_PRIVATE_FROM_C_OBJECT(getCCore())->getIfAddrsCache().getLocalAddresses());
 }
 
 bool IceService::checkLocalNetworkPermission(const string &localAddr){
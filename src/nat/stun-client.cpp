@@ -21,9 +21,9 @@
 
 #include "logger/logger.h"
 
+#include "core/core-p.h"
 #include "stun-client.h"
 #include "c-wrapper/internal/c-tools.h"
-#include "c-wrapper/internal/c-tools.h"
 
 // =============================================================================
 
@@ -31,94 +31,196 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+namespace {
+	constexpr int StunTimeout = 2000; // In milliseconds.
+	constexpr unsigned int StunRetransmissionInterval = 200; // In milliseconds.
+}
+
+// -----------------------------------------------------------------------------
+
+StunClient::~StunClient () {
+	if (mainLoop) {
+		stopAsync(-1);
+		close_socket(sockAudio);
+		if (sockVideo != -1) close_socket(sockVideo);
+		if (sockText != -1) close_socket(sockText);
+	}
+}
+
 int StunClient::run (int audioPort, int videoPort, int textPort) {
+	if (openSockets(audioPort, videoPort, textPort) < 0)
+		return -1;
+
+	int loops = 0;
+	bool timedOut = false;
+	do {
+		if ((loops % 20) == 0)
+			sendStunRequests();
+		ms_usleep(10000);
+		recvStunResponses();
+		if (getElapsedTime() > StunTimeout) {
+			timedOut = true;
+			break;
+		}
+		loops++;
+	} while (!isComplete());
+
+	return finish(timedOut);
+}
+
+int StunClient::runAsync (int audioPort, int videoPort, int textPort, const function<void (int)> &callback) {
+	if (isRunning()) {
+		lError() << "STUN tests are already running";
+		return -1;
+	}
+	if (openSockets(audioPort, videoPort, textPort) < 0)
+		return -1;
+
+	onDone = callback;
+	mainLoop = getCore()->getPrivate()->getMainLoop();
+	belle_sip_object_ref(mainLoop);
+
+	const ortp_socket_t sockets[3] = { sockAudio, sockVideo, sockText };
+	for (size_t i = 0; i < 3; i++) {
+		if (sockets[i] == -1)
+			continue;
+		socketSources[i] = belle_sip_socket_source_new(onSocketReadable, this, sockets[i], BELLE_SIP_EVENT_READ, (unsigned int)-1);
+		belle_sip_main_loop_add_source(mainLoop, socketSources[i]);
+	}
+
+	sendStunRequests();
+	retransmissionTimer = getCore()->getCCore()->sal->createTimer(
+		[this]() { return onRetransmissionTimer(); }, StunRetransmissionInterval, "STUN requests retransmission"
+	);
+	return 0;
+}
+
+bool StunClient::isRunning () const {
+	return mainLoop != nullptr;
+}
+
+void StunClient::updateMediaDescription (std::shared_ptr<SalMediaDescription> & md) const {
+	if (!stunDiscoveryDone) return;
+	for (auto & stream : md->streams) {
+		if (!stream.enabled())
+			continue;
+		if (stream.getType() == SalAudio && audioCandidate.port != 0) {
+			stream.rtp_addr = audioCandidate.address;
+			stream.rtp_port = audioCandidate.port;
+			if (
+				(
+					!audioCandidate.address.empty() &&
+					!videoCandidate.address.empty() &&
+					audioCandidate.address == videoCandidate.address
+				) ||
+				md->getNbActiveStreams() == 1
+			) {
+				md->addr = audioCandidate.address;
+			}
+		} else if (stream.type == SalVideo && videoCandidate.port != 0) {
+			stream.rtp_addr = videoCandidate.address;
+			stream.rtp_port = videoCandidate.port;
+		} else if (stream.type == SalText && textCandidate.port != 0) {
+			stream.rtp_addr = textCandidate.address;
+			stream.rtp_port = textCandidate.port;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+int StunClient::openSockets (int audioPort, int videoPort, int textPort) {
 	stunDiscoveryDone = false;
+	gotAudio = gotVideo = gotText = false;
+	coneAudio = coneVideo = coneText = false;
 	if (linphone_core_ipv6_enabled(getCore()->getCCore())) {
 		lWarning() << "STUN support is not implemented for ipv6";
 		return -1;
 	}
 	if (!linphone_core_get_stun_server(getCore()->getCCore()))
 		return -1;
-	const struct addrinfo *ai = linphone_core_get_stun_server_addrinfo(getCore()->getCCore());
-	if (!ai) {
+	server = linphone_core_get_stun_server_addrinfo(getCore()->getCCore());
+	if (!server) {
 		lError() << "Could not obtain STUN server addrinfo";
 		return -1;
 	}
 
 	/* Create the RTP sockets and send STUN messages to the STUN server */
-	ortp_socket_t sockAudio = createStunSocket(audioPort);
+	sockAudio = createStunSocket(audioPort);
 	if (sockAudio == -1)
 		return -1;
-	ortp_socket_t sockVideo = -1;
 	if (linphone_core_video_enabled(getCore()->getCCore())) {
 		sockVideo = createStunSocket(videoPort);
-		if (sockVideo == -1)
+		if (sockVideo == -1) {
+			close_socket(sockAudio);
+			sockAudio = -1;
 			return -1;
+		}
 	}
-	ortp_socket_t sockText = -1;
 	if (linphone_core_realtime_text_enabled(getCore()->getCCore())) {
 		sockText = createStunSocket(textPort);
-		if (sockText == -1)
+		if (sockText == -1) {
+			close_socket(sockAudio);
+			sockAudio = -1;
+			if (sockVideo != -1) close_socket(sockVideo);
+			sockVideo = -1;
 			return -1;
+		}
 	}
 
-	int ret = 0;
-	int loops = 0;
-	bool gotAudio = false;
-	bool gotVideo = false;
-	bool gotText = false;
-	bool coneAudio = false;
-	bool coneVideo = false;
-	bool coneText = false;
-	double elapsed;
-	struct timeval init;
-	ortp_gettimeofday(&init, nullptr);
+	ortp_gettimeofday(&startTime, nullptr);
+	return 0;
+}
 
-	do {
-		int id;
-		if ((loops % 20) == 0) {
-			lInfo() << "Sending STUN requests...";
-			sendStunRequest(sockAudio, ai->ai_addr, (socklen_t)ai->ai_addrlen, 11, true);
-			sendStunRequest(sockAudio, ai->ai_addr, (socklen_t)ai->ai_addrlen, 1, false);
-			if (sockVideo != -1) {
-				sendStunRequest(sockVideo, ai->ai_addr, (socklen_t)ai->ai_addrlen, 22, true);
-				sendStunRequest(sockVideo, ai->ai_addr, (socklen_t)ai->ai_addrlen, 2, false);
-			}
-			if (sockText != -1) {
-				sendStunRequest(sockText, ai->ai_addr, (socklen_t)ai->ai_addrlen, 33, true);
-				sendStunRequest(sockText, ai->ai_addr, (socklen_t)ai->ai_addrlen, 3, false);
-			}
-		}
-		ms_usleep(10000);
+void StunClient::sendStunRequests () {
+	lInfo() << "Sending STUN requests...";
+	sendStunRequest(sockAudio, server->ai_addr, (socklen_t)server->ai_addrlen, 11, true);
+	sendStunRequest(sockAudio, server->ai_addr, (socklen_t)server->ai_addrlen, 1, false);
+	if (sockVideo != -1) {
+		sendStunRequest(sockVideo, server->ai_addr, (socklen_t)server->ai_addrlen, 22, true);
+		sendStunRequest(sockVideo, server->ai_addr, (socklen_t)server->ai_addrlen, 2, false);
+	}
+	if (sockText != -1) {
+		sendStunRequest(sockText, server->ai_addr, (socklen_t)server->ai_addrlen, 33, true);
+		sendStunRequest(sockText, server->ai_addr, (socklen_t)server->ai_addrlen, 3, false);
+	}
+}
 
-		if (recvStunResponse(sockAudio, audioCandidate, id) > 0) {
-			lInfo() << "STUN test result: local audio port maps to " << audioCandidate.address << ":" << audioCandidate.port;
-			if (id == 11) coneAudio = true;
-			gotAudio = true;
-		}
-		if (recvStunResponse(sockVideo, videoCandidate, id) > 0) {
-			lInfo() << "STUN test result: local video port maps to " << videoCandidate.address << ":" << videoCandidate.port;
-			if (id == 22) coneVideo = true;
-			gotVideo = true;
-		}
-		if (recvStunResponse(sockText, textCandidate, id) > 0) {
-			lInfo() << "STUN test result: local text port maps to " << textCandidate.address << ":" << textCandidate.port;
-			if (id == 33) coneText = true;
-			gotText = true;
-		}
-		struct timeval cur;
-		ortp_gettimeofday(&cur, nullptr);
-		elapsed = static_cast<double>(cur.tv_sec - init.tv_sec) * 1000 + static_cast<double>(cur.tv_usec - init.tv_usec) / 1000;
-		if (elapsed > 2000.) {
-			lInfo() << "STUN responses timeout, going ahead";
-			ret = -1;
-			break;
-		}
-		loops++;
-	} while (!(gotAudio && (gotVideo || sockVideo == -1) && (gotText || sockText == -1)));
+void StunClient::recvStunResponses () {
+	int id;
+	while (recvStunResponse(sockAudio, audioCandidate, id) > 0) {
+		lInfo() << "STUN test result: local audio port maps to " << audioCandidate.address << ":" << audioCandidate.port;
+		if (id == 11) coneAudio = true;
+		gotAudio = true;
+	}
+	while (sockVideo != -1 && recvStunResponse(sockVideo, videoCandidate, id) > 0) {
+		lInfo() << "STUN test result: local video port maps to " << videoCandidate.address << ":" << videoCandidate.port;
+		if (id == 22) coneVideo = true;
+		gotVideo = true;
+	}
+	while (sockText != -1 && recvStunResponse(sockText, textCandidate, id) > 0) {
+		lInfo() << "STUN test result: local text port maps to " << textCandidate.address << ":" << textCandidate.port;
+		if (id == 33) coneText = true;
+		gotText = true;
+	}
+}
 
-	if (ret == 0)
-		ret = (int)elapsed;
+bool StunClient::isComplete () const {
+	return gotAudio && (gotVideo || sockVideo == -1) && (gotText || sockText == -1);
+}
+
+int StunClient::getElapsedTime () const {
+	struct timeval cur;
+	ortp_gettimeofday(&cur, nullptr);
+	return static_cast<int>((cur.tv_sec - startTime.tv_sec) * 1000 + (cur.tv_usec - startTime.tv_usec) / 1000);
+}
+
+int StunClient::finish (bool timedOut) {
+	int ret = -1;
+	if (timedOut)
+		lInfo() << "STUN responses timeout, going ahead";
+	else
+		ret = getElapsedTime();
 
 	if (!gotAudio)
 		lError() << "No STUN server response for audio port";
@@ -142,36 +244,52 @@ int StunClient::run (int audioPort, int videoPort, int textPort) {
 	close_socket(sockAudio);
 	if (sockVideo != -1) close_socket(sockVideo);
 	if (sockText != -1) close_socket(sockText);
+	sockAudio = sockVideo = sockText = -1;
 	stunDiscoveryDone = true;
 	return ret;
 }
 
-void StunClient::updateMediaDescription (std::shared_ptr<SalMediaDescription> & md) const {
-	if (!stunDiscoveryDone) return;
-	for (auto & stream : md->streams) {
-		if (!stream.enabled())
+// -----------------------------------------------------------------------------
+
+int StunClient::onSocketReadable (void *data, unsigned int events) {
+	StunClient *client = static_cast<StunClient *>(data);
+	client->recvStunResponses();
+	if (client->isComplete())
+		client->stopAsync(client->finish(false));
+	return BELLE_SIP_CONTINUE;
+}
+
+bool StunClient::onRetransmissionTimer () {
+	if (getElapsedTime() > StunTimeout) {
+		stopAsync(finish(true));
+		return false;
+	}
+	sendStunRequests();
+	return true;
+}
+
+// Removes the sources from the main loop, and notifies the end of the tests if they are finished.
+void StunClient::stopAsync (int ret) {
+	for (auto &source : socketSources) {
+		if (!source)
 			continue;
-		if (stream.getType() == SalAudio && audioCandidate.port != 0) {
-			stream.rtp_addr = audioCandidate.address;
-			stream.rtp_port = audioCandidate.port;
-			if (
-				(
-					!audioCandidate.address.empty() &&
-					!videoCandidate.address.empty() &&
-					audioCandidate.address == videoCandidate.address
-				) ||
-				md->getNbActiveStreams() == 1
-			) {
-				md->addr = audioCandidate.address;
-			}
-		} else if (stream.type == SalVideo && videoCandidate.port != 0) {
-			stream.rtp_addr = videoCandidate.address;
-			stream.rtp_port = videoCandidate.port;
-		} else if (stream.type == SalText && textCandidate.port != 0) {
-			stream.rtp_addr = textCandidate.address;
-			stream.rtp_port = textCandidate.port;
-		}
+		belle_sip_main_loop_remove_source(mainLoop, source);
+		belle_sip_object_unref(source);
+		source = nullptr;
+	}
+	if (retransmissionTimer) {
+		belle_sip_main_loop_remove_source(mainLoop, retransmissionTimer);
+		belle_sip_object_unref(retransmissionTimer);
+		retransmissionTimer = nullptr;
 	}
+	belle_sip_object_unref(mainLoop);
+	mainLoop = nullptr;
+
+	// The callback may destroy this client.
+	function<void (int)> callback = move(onDone);
+	onDone = nullptr;
+	if (stunDiscoveryDone && callback)
+		callback(ret);
 }
 
 // -----------------------------------------------------------------------------
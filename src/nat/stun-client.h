@@ -20,8 +20,10 @@
 #ifndef _L_STUN_CLIENT_H_
 #define _L_STUN_CLIENT_H_
 
+#include <functional>
 #include <string>
 
+#include <belle-sip/belle-sip.h>
 #include <ortp/port.h>
 
 #include "core/core.h"
@@ -43,8 +45,22 @@ class StunClient : public CoreAccessor {
 
 public:
 	StunClient (const std::shared_ptr<Core> &core) : CoreAccessor(core) {}
+	~StunClient ();
 
+	/*
+	 * Blocking discovery, returns the duration of the tests in milliseconds, or -1 if they failed.
+	 */
 	int run (int audioPort, int videoPort, int textPort);
+
+	/*
+	 * Discovery driven by the main loop: the responses are read when the sockets are readable,
+	 * the requests are retransmitted by a timer.
+	 * callback is called with the duration of the tests in milliseconds, or -1 if they failed.
+	 * Returns -1 if the tests can't be started, callback is not called in this case.
+	 */
+	int runAsync (int audioPort, int videoPort, int textPort, const std::function<void (int)> &callback);
+	bool isRunning () const;
+
 	void updateMediaDescription (std::shared_ptr<SalMediaDescription> & md) const;
 
 	const Candidate &getAudioCandidate () const {
@@ -64,10 +80,38 @@ public:
 	int sendStunRequest (ortp_socket_t sock, const struct sockaddr *server, socklen_t addrlen, int id, bool changeAddr);
 
 private:
+	int openSockets (int audioPort, int videoPort, int textPort);
+	void sendStunRequests ();
+	void recvStunResponses ();
+	bool isComplete () const;
+	int getElapsedTime () const;
+	int finish (bool timedOut);
+
+	static int onSocketReadable (void *data, unsigned int events);
+	bool onRetransmissionTimer ();
+	void stopAsync (int ret);
+
 	Candidate audioCandidate;
 	Candidate videoCandidate;
 	Candidate textCandidate;
 	bool stunDiscoveryDone = false;
+
+	const struct addrinfo *server = nullptr;
+	ortp_socket_t sockAudio = -1;
+	ortp_socket_t sockVideo = -1;
+	ortp_socket_t sockText = -1;
+	bool gotAudio = false;
+	bool gotVideo = false;
+	bool gotText = false;
+	bool coneAudio = false;
+	bool coneVideo = false;
+	bool coneText = false;
+	struct timeval startTime;
+
+	belle_sip_main_loop_t *mainLoop = nullptr;
+	belle_sip_source_t *socketSources[3] = { nullptr, nullptr, nullptr };
+	belle_sip_source_t *retransmissionTimer = nullptr;
+	std::function<void (int)> onDone;
 };
 
 LINPHONE_END_NAMESPACE
@@ -60,13 +60,12 @@ protected:
 				BELLE_SIP_HEADER(belle_sip_header_content_length_create(0))
 			);
 		} else {
-			std::string body = content.getBodyAsUtf8String();
-			size_t contentLength = body.size();
+			size_t contentLength = content.getSize();
 			belle_sip_message_add_header(
 				BELLE_SIP_MESSAGE(req),
 				BELLE_SIP_HEADER(belle_sip_header_content_length_create(contentLength))
 			);
-			belle_sip_message_set_body(BELLE_SIP_MESSAGE(req), body.c_str(), contentLength);
+			belle_sip_message_set_body(BELLE_SIP_MESSAGE(req), content.getBodyData(), contentLength);
 		}
 	}
 
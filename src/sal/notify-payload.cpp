@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+	#include <zlib.h>
+#endif // ifdef HAVE_ZLIB
+
+#include "logger/logger.h"
+
+#include "notify-payload.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	const char EncodedBodyKey[] = "notify-payload";
+
+	// Same output as the deflate content encoding of belle-sip: a zlib stream.
+	bool deflateBody (const string &body, string &encodedBody) {
+#ifdef HAVE_ZLIB
+		uLongf encodedSize = compressBound(uLong(body.size()));
+		encodedBody.resize(encodedSize);
+		int result = compress2(
+			reinterpret_cast<Bytef *>(&encodedBody[0]), &encodedSize,
+			reinterpret_cast<const Bytef *>(body.data()), uLong(body.size()),
+			Z_DEFAULT_COMPRESSION
+		);
+		if (result != Z_OK) {
+			lError() << "Unable to deflate NOTIFY body: " << result;
+			return false;
+		}
+		encodedBody.resize(encodedSize);
+		return true;
+#else
+		return false;
+#endif // ifdef HAVE_ZLIB
+	}
+
+	void destroyEncodedBody (void *data) {
+		delete static_cast<shared_ptr<const string> *>(data);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+NotifyPayload::NotifyPayload (const string &body, const ContentType &contentType, bool deflate) :
+	mContentType(contentType), mBodySize(body.size()) {
+	string encodedBody;
+	if (deflate && deflateBody(body, encodedBody)) {
+		mContentEncoding = "deflate";
+		mEncodedBody = make_shared<const string>(move(encodedBody));
+	} else
+		mEncodedBody = make_shared<const string>(body);
+}
+
+SalBodyHandler *NotifyPayload::createBodyHandler () const {
+	// A user body handler: belle-sip only encodes memory body handlers, the body is sent as is.
+	belle_sip_user_body_handler_t *bh = belle_sip_user_body_handler_new(
+		mEncodedBody->size(), nullptr, nullptr, nullptr, onSendBody, nullptr, nullptr
+	);
+	// The request may outlive the payload, it keeps its own reference on the encoded bytes.
+	auto encodedBody = new shared_ptr<const string>(mEncodedBody);
+	belle_sip_object_data_set(BELLE_SIP_OBJECT(bh), EncodedBodyKey, encodedBody, destroyEncodedBody);
+
+	SalBodyHandler *bodyHandler = reinterpret_cast<SalBodyHandler *>(BELLE_SIP_BODY_HANDLER(bh));
+	sal_body_handler_set_type(bodyHandler, mContentType.getType().c_str());
+	sal_body_handler_set_subtype(bodyHandler, mContentType.getSubType().c_str());
+	for (const auto &param : mContentType.getParameters())
+		sal_body_handler_set_content_type_parameter(bodyHandler, param.getName().c_str(), param.getValue().c_str());
+	sal_body_handler_set_size(bodyHandler, mEncodedBody->size());
+	if (!mContentEncoding.empty())
+		sal_body_handler_set_encoding(bodyHandler, mContentEncoding.c_str());
+	return bodyHandler;
+}
+
+const ContentType &NotifyPayload::getContentType () const {
+	return mContentType;
+}
+
+const string &NotifyPayload::getContentEncoding () const {
+	return mContentEncoding;
+}
+
+size_t NotifyPayload::getBodySize () const {
+	return mBodySize;
+}
+
+size_t NotifyPayload::getEncodedSize () const {
+	return mEncodedBody->size();
+}
+
+// -----------------------------------------------------------------------------
+
+int NotifyPayload::onSendBody (
+	belle_sip_user_body_handler_t *bh,
+	belle_sip_message_t *m,
+	void *data,
+	size_t offset,
+	uint8_t *buffer,
+	size_t *size
+) {
+	auto encodedBody = static_cast<shared_ptr<const string> *>(belle_sip_object_data_get(BELLE_SIP_OBJECT(bh), EncodedBodyKey));
+	const string &body = **encodedBody;
+	if (offset >= body.size()) {
+		*size = 0;
+		return BELLE_SIP_STOP;
+	}
+	*size = min(*size, body.size() - offset);
+	memcpy(buffer, body.data() + offset, *size);
+	return offset + *size < body.size() ? BELLE_SIP_CONTINUE : BELLE_SIP_STOP;
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_NOTIFY_PAYLOAD_H_
+#define _L_NOTIFY_PAYLOAD_H_
+
+#include <memory>
+#include <string>
+
+#include "c-wrapper/internal/c-sal.h"
+#include "content/content-type.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Body of a NOTIFY, encoded once and shared by the NOTIFY requests sent to all the subscribers.
+ * The encoded bytes are never modified: each request reads them through its own body handler.
+ */
+class NotifyPayload {
+public:
+	/**
+	 * @param[in] body the body to send
+	 * @param[in] contentType the content type of the body
+	 * @param[in] deflate whether the body is compressed with the deflate content encoding
+	 **/
+	NotifyPayload (const std::string &body, const ContentType &contentType, bool deflate);
+	NotifyPayload (const NotifyPayload &other) = delete;
+	virtual ~NotifyPayload () = default;
+
+	/**
+	 * @return a new body handler sending the encoded body, to be given to a NOTIFY request
+	 **/
+	SalBodyHandler *createBodyHandler () const;
+
+	const ContentType &getContentType () const;
+	// Empty if the body is not encoded.
+	const std::string &getContentEncoding () const;
+
+	size_t getBodySize () const;
+	size_t getEncodedSize () const;
+
+private:
+	static int onSendBody (belle_sip_user_body_handler_t *bh, belle_sip_message_t *m, void *data, size_t offset, uint8_t *buffer, size_t *size);
+
+	ContentType mContentType;
+	std::string mContentEncoding;
+	size_t mBodySize;
+	std::shared_ptr<const std::string> mEncodedBody;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_NOTIFY_PAYLOAD_H_
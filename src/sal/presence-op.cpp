@@ -18,6 +18,7 @@
  */
 
 #include "c-wrapper/internal/c-tools.h"
+#include "sal/notify-payload.h"
 #include "sal/presence-op.h"
 
 using namespace std;
@@ -380,14 +381,20 @@ belle_sip_request_t *SalPresenceOp::createPresenceNotify () {
 	return request;
 }
 
+char *SalPresenceOp::presenceToXml (belle_sip_message_t *notify, SalPresenceModel *presence) {
+	char *content = nullptr;
+	auto fromHeader = belle_sip_message_get_header_by_type(notify, belle_sip_header_from_t);
+	char *contactInfo = belle_sip_uri_to_string(belle_sip_header_address_get_uri(BELLE_SIP_HEADER_ADDRESS(fromHeader)));
+	mRoot->mCallbacks.convert_presence_to_xml_requested(this, presence, contactInfo, &content);
+	belle_sip_free(contactInfo);
+	return content;
+}
+
 void SalPresenceOp::addPresenceInfo (belle_sip_message_t *notify, SalPresenceModel *presence) {
 	char *content = nullptr;
 
 	if (presence) {
-		auto fromHeader = belle_sip_message_get_header_by_type(notify, belle_sip_header_from_t);
-		char *contactInfo = belle_sip_uri_to_string(belle_sip_header_address_get_uri(BELLE_SIP_HEADER_ADDRESS(fromHeader)));
-		mRoot->mCallbacks.convert_presence_to_xml_requested(this, presence, contactInfo, &content);
-		belle_sip_free(contactInfo);
+		content = presenceToXml(notify, presence);
 		if (!content)
 			return;
 	}
@@ -427,6 +434,34 @@ int SalPresenceOp::notifyPresence (SalPresenceModel *presence) {
 	return sendRequest(request);
 }
 
+int SalPresenceOp::notifyPresence (SalPresenceModel *presence, shared_ptr<const NotifyPayload> &payload, bool deflate) {
+	if (!presence)
+		return notifyPresence(presence);
+
+	if (checkDialogState())
+		return -1;
+
+	auto request = createPresenceNotify();
+	if (!request)
+		return-1;
+
+	if (!payload) {
+		// The presentity of the model is set by the first serialization, the following NOTIFYs would get the same body.
+		char *content = presenceToXml(BELLE_SIP_MESSAGE(request), presence);
+		if (content) {
+			payload = make_shared<const NotifyPayload>(content, ContentType::Pidf, deflate);
+			ms_free(content);
+		}
+	}
+	if (payload)
+		belle_sip_message_set_body_handler(BELLE_SIP_MESSAGE(request), BELLE_SIP_BODY_HANDLER(payload->createBodyHandler()));
+	belle_sip_message_add_header(
+		BELLE_SIP_MESSAGE(request),
+		BELLE_SIP_HEADER(belle_sip_header_subscription_state_create(BELLE_SIP_SUBSCRIPTION_STATE_ACTIVE, 600))
+	);
+	return sendRequest(request);
+}
+
 int SalPresenceOp::notifyPresenceClose () {
 	if (checkDialogState())
 		return -1;
@@ -20,10 +20,14 @@
 #ifndef _L_SAL_PRESENCE_OP_H_
 #define _L_SAL_PRESENCE_OP_H_
 
+#include <memory>
+
 #include "sal/event-op.h"
 
 LINPHONE_BEGIN_NAMESPACE
 
+class NotifyPayload;
+
 class SalPresenceOp : public SalSubscribeOp {
 public:
 	SalPresenceOp (Sal *sal);
@@ -31,6 +35,8 @@ public:
 	int subscribe (int expires);
 	int unsubscribe () { return SalOp::unsubscribe(); }
 	int notifyPresence (SalPresenceModel *presence);
+	// Same, with a body shared by all the NOTIFYs of a presence change: it is created by the first call from the model.
+	int notifyPresence (SalPresenceModel *presence, std::shared_ptr<const NotifyPayload> &payload, bool deflate);
 	int notifyPresenceClose ();
 
 private:
@@ -39,6 +45,7 @@ private:
 	SalPresenceModel *processPresenceNotification (belle_sip_request_t *request);
 	int checkDialogState ();
 	belle_sip_request_t *createPresenceNotify ();
+	char *presenceToXml (belle_sip_message_t *notify, SalPresenceModel *presence);
 	void addPresenceInfo (belle_sip_message_t *notify, SalPresenceModel *presence);
 
 	static SalSubscribeStatus getSubscriptionState (const belle_sip_message_t *message);
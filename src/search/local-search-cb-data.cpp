@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "local-search-cb-data.h"
+
+#include "core/core.h"
+#include "linphone/core.h"
+#include "linphone/utils/utils.h"
+#include "logger/logger.h"
+#include "search-result.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+LocalSearchCbData::LocalSearchCbData (int sourceFlags, const SearchAsyncData *asyncData) : mAsyncData(asyncData), mCancelled(false) {
+	mSourceFlags = sourceFlags;
+	mRequestCount = asyncData->getRequestCount();
+}
+
+LocalSearchCbData::~LocalSearchCbData () {
+	cancel();
+	if (mThread.joinable())
+		mThread.join();
+	// Snapshots are released here, on the main loop: they hold belle-sip objects.
+	for (const auto &snapshot : mFriends)
+		linphone_friend_unref(snapshot.lFriend);
+}
+
+void LocalSearchCbData::cancel () {
+	mCancelled = true;
+}
+
+void LocalSearchCbData::addFriend (LinphoneFriend *lFriend, const shared_ptr<const MagicSearchFriendRecord> &record) {
+	mFriends.push_back({ linphone_friend_ref(lFriend), record });
+}
+
+void LocalSearchCbData::addAddress (const LinphoneAddress *address, bool matchAllWithoutFilter) {
+	mAddresses.emplace_back(address, matchAllWithoutFilter);
+}
+
+void LocalSearchCbData::start (const shared_ptr<LocalSearchCbData> &self, const shared_ptr<Core> &core, const MagicSearchWeights &weights) {
+	if (self->mFriends.empty() && self->mAddresses.empty()) {
+		self->onBatch(vector<Match>(), true);
+		return;
+	}
+	self->mSelf = self;
+	self->mCore = core;
+	self->mWeights = weights;
+	self->mFilterLC = Utils::stringToLower(self->mFilter);
+	self->mThread = thread(&LocalSearchCbData::run, self.get());
+}
+
+// -----------------------------------------------------------------------------
+
+bool LocalSearchCbData::isCancelled () const {
+	return mCancelled || mAsyncData->getRequestCount() != mRequestCount;
+}
+
+// Worker thread: only reads the snapshots, belle-sip objects are neither created nor (un)referenced.
+void LocalSearchCbData::run () {
+	vector<Match> batch;
+	if (!mFriends.empty()) {
+		vector<MagicSearchFriendRecord::Match> friendMatches;
+		for (size_t i = 0; i < mFriends.size(); ++i) {
+			if (isCancelled())
+				return;
+			friendMatches.clear();
+			mFriends[i].record->match(mFilterLC, mWithDomain, mWeights, friendMatches);
+			for (const auto &match : friendMatches)
+				batch.push_back({ i, match.weight, match.address, match.phoneNumber });
+			if (batch.size() >= BatchSize)
+				sendBatch(batch, false);
+		}
+	} else {
+		for (size_t i = 0; i < mAddresses.size(); ++i) {
+			if (isCancelled())
+				return;
+			unsigned int weight;
+			if (mAddresses[i].match(mFilterLC, mWithDomain, mWeights, weight))
+				batch.push_back({ i, weight, mAddresses[i].getAddress(), nullptr });
+			if (batch.size() >= BatchSize)
+				sendBatch(batch, false);
+		}
+	}
+	if (!isCancelled())
+		sendBatch(batch, true);
+}
+
+void LocalSearchCbData::sendBatch (vector<Match> &batch, bool last) {
+	shared_ptr<Core> core = mCore.lock();
+	if (!core)
+		return;
+	weak_ptr<LocalSearchCbData> self = mSelf;
+	vector<Match> matches;
+	matches.swap(batch);
+	// The provider may have been destroyed when the batch reaches the main loop: it is then dropped.
+	core->doLater([self, matches, last]() {
+		shared_ptr<LocalSearchCbData> data = self.lock();
+		if (data)
+			data->onBatch(matches, last);
+	});
+}
+
+// Main loop.
+void LocalSearchCbData::onBatch (const vector<Match> &batch, bool last) {
+	if (mEnd || mCancelled)
+		return;
+	for (const auto &match : batch) {
+		const LinphoneFriend *lFriend = mFriends.empty() ? nullptr : mFriends[match.index].lFriend;
+		mResult->push_back(SearchResult::create(match.weight, match.address, match.phoneNumber ? *match.phoneNumber : "", lFriend, mSourceFlags));
+	}
+	mResultCount += batch.size();
+	if (last) {
+		const char *source = (mSourceFlags == LinphoneMagicSearchSourceFriends) ? "friends"
+			: (mSourceFlags == LinphoneMagicSearchSourceCallLogs) ? "call logs" : "chat rooms";
+		lInfo() << "[Magic Search] Found " << mResultCount << " results in " << source;
+		mEnd = TRUE;
+	}
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_LOCAL_SEARCH_CB_DATA_H_
+#define _L_LOCAL_SEARCH_CB_DATA_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "magic-search-index.h"
+#include "search-async-data.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class Core;
+
+/**
+ * @brief The LocalSearchCbData class. Asynchronous provider searching in friends, call logs or chat rooms.
+ * The source is copied on the main loop into immutable records, then weighted on a worker thread.
+ * Matches are sent back to the main loop in batches, where the SearchResult objects are created.
+ * The worker stops as soon as the provider is cancelled or a newer request is pushed.
+ */
+class LocalSearchCbData : public SearchAsyncData::CbData {
+public:
+	/**
+	 * @param sourceFlags The searched source: #LinphoneMagicSearchSourceFriends, #LinphoneMagicSearchSourceCallLogs or #LinphoneMagicSearchSourceChatRooms.
+	 * @param asyncData The data of the search, used to detect newer requests.
+	 */
+	LocalSearchCbData (int sourceFlags, const SearchAsyncData *asyncData);
+	LocalSearchCbData (const LocalSearchCbData &other) = delete;
+	virtual ~LocalSearchCbData ();
+
+	virtual void cancel () override;
+
+	/**
+	 * @brief addFriend Add a friend to search in. Must be called before start().
+	 * @param lFriend The friend, referenced until the provider is destroyed.
+	 * @param record The search keys of the friend.
+	 */
+	void addFriend (LinphoneFriend *lFriend, const std::shared_ptr<const MagicSearchFriendRecord> &record);
+
+	/**
+	 * @brief addAddress Add an address to search in. Must be called before start().
+	 * @param address The address, referenced until the provider is destroyed.
+	 * @param matchAllWithoutFilter Whether the address matches an empty filter whatever the domain.
+	 */
+	void addAddress (const LinphoneAddress *address, bool matchAllWithoutFilter);
+
+	/**
+	 * @brief start Start the search on a worker thread. mFilter and mWithDomain must be set.
+	 * @param self The shared pointer owning this provider, it is only weakly referenced by the batches.
+	 * @param core The core on which main loop the batches are delivered.
+	 * @param weights The weighting settings of the MagicSearch.
+	 */
+	static void start (const std::shared_ptr<LocalSearchCbData> &self, const std::shared_ptr<Core> &core, const MagicSearchWeights &weights);
+
+private:
+	struct Match {
+		size_t index; // Index of the friend or the address in the snapshot.
+		unsigned int weight;
+		const LinphoneAddress *address;
+		const std::string *phoneNumber;
+	};
+
+	static const size_t BatchSize = 256;
+
+	void run ();
+	bool isCancelled () const;
+	void sendBatch (std::vector<Match> &batch, bool last);
+	void onBatch (const std::vector<Match> &batch, bool last);
+
+	struct FriendSnapshot {
+		LinphoneFriend *lFriend;
+		std::shared_ptr<const MagicSearchFriendRecord> record;
+	};
+	std::vector<FriendSnapshot> mFriends;
+	std::vector<MagicSearchAddressRecord> mAddresses;
+
+	const SearchAsyncData *mAsyncData;
+	unsigned int mRequestCount;
+	std::atomic<bool> mCancelled;
+	std::string mFilterLC;
+	MagicSearchWeights mWeights;
+	std::weak_ptr<LocalSearchCbData> mSelf;
+	std::weak_ptr<Core> mCore;
+	std::thread mThread;
+	size_t mResultCount = 0;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_LOCAL_SEARCH_CB_DATA_H_
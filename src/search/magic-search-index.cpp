@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "magic-search-index.h"
+
+#include "linphone/core.h"
+#include "logger/logger.h"
+#include "private.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+static string toLowerCase (const char *str) {
+	string result = str ? str : "";
+	transform(result.begin(), result.end(), result.begin(), [](unsigned char c){ return tolower(c); });
+	return result;
+}
+
+static int compareStringItems (const char *a, const char *b) {
+	if (a == nullptr) a = "";
+	if (b == nullptr) b = "";
+	return strcasecmp(a, b);
+}
+
+// -----------------------------------------------------------------------------
+
+unsigned int MagicSearchWeights::getWeight (const string &stringWordsLC, const string &filterLC) const {
+	size_t weight = string::npos;
+
+	// Finding all occurrences of "filterLC" in "stringWordsLC"
+	for (size_t w = stringWordsLC.find(filterLC);
+		w != string::npos;
+		w = stringWordsLC.find(filterLC, w + filterLC.length())
+	) {
+		// weight max if occurence find at beginning
+		if (w == 0) {
+			weight = maxWeight;
+		} else {
+			bool isDelimiter = false;
+			if (useDelimiter) {
+				// get the char before the matched filterLC
+				const char l = stringWordsLC.at(w - 1);
+				// Check if it's a delimiter
+				for (const char d : delimiter) {
+					if (l == d) {
+						isDelimiter = true;
+						break;
+					}
+				}
+			}
+			unsigned int newWeight = maxWeight - (unsigned int)((isDelimiter) ? 1 : w + 1);
+			weight = (weight != string::npos) ? weight + newWeight : newWeight;
+		}
+		// Only one search on the stringWordsLC for the moment
+		// due to weight calcul which dos not take into the case of multiple occurence
+		break;
+	}
+
+	return (weight != string::npos) ? (unsigned int)(weight) : minWeight;
+}
+
+// -----------------------------------------------------------------------------
+
+MagicSearchFriendRecord::MagicSearchFriendRecord (const LinphoneFriend *lFriend, LinphoneProxyConfig *proxy) {
+	if (linphone_core_vcard_supported() && linphone_friend_get_vcard(lFriend)) {
+		const char *name = linphone_vcard_get_full_name(linphone_friend_get_vcard(lFriend));
+		if (name) {
+			hasName = true;
+			nameLC = toLowerCase(name);
+		}
+	}
+
+	for (const bctbx_list_t *listAddress = linphone_friend_get_addresses(lFriend);
+		 listAddress != nullptr && listAddress->data != nullptr;
+		 listAddress = listAddress->next) {
+		const LinphoneAddress *lAddress = static_cast<LinphoneAddress*>(listAddress->data);
+		AddressKeys keys;
+		keys.address = linphone_address_ref(const_cast<LinphoneAddress *>(lAddress));
+		if (linphone_address_get_username(lAddress)) {
+			keys.hasUsername = true;
+			keys.usernameLC = toLowerCase(linphone_address_get_username(lAddress));
+		}
+		if (linphone_address_get_display_name(lAddress)) {
+			keys.hasDisplayName = true;
+			keys.displayNameLC = toLowerCase(linphone_address_get_display_name(lAddress));
+		}
+		if (linphone_address_get_domain(lAddress))
+			keys.domain = linphone_address_get_domain(lAddress);
+
+		char *uri = linphone_address_as_string_uri_only(lAddress);
+		const LinphonePresenceModel *presence = linphone_friend_get_presence_model_for_uri_or_tel(lFriend, uri);
+		char *contact = presence ? linphone_presence_model_get_contact(presence) : nullptr;
+		if (contact) {
+			LinphoneAddress *contactAddress = linphone_address_new(contact);
+			if (contactAddress) {
+				keys.hasPresenceDomain = true;
+				const char *domain = linphone_address_get_domain(contactAddress);
+				keys.presenceDomain = domain ? domain : "";
+				linphone_address_unref(contactAddress);
+			}
+			bctbx_free(contact);
+		}
+		ms_free(uri);
+		addresses.push_back(move(keys));
+	}
+
+	bctbx_list_t *numbers = linphone_friend_get_phone_numbers(lFriend);
+	for (const bctbx_list_t *n = numbers ; n != nullptr && n->data != nullptr ; n = n->next) {
+		const char *number = static_cast<const char *>(n->data);
+		PhoneNumberKeys keys;
+		keys.number = number;
+		if (proxy) {
+			char *normalized = linphone_proxy_config_normalize_phone_number(proxy, number);
+			if (normalized) {
+				keys.number = normalized;
+				bctbx_free(normalized);
+			}
+		}
+		keys.numberLC = toLowerCase(keys.number.c_str());
+
+		const LinphonePresenceModel *presence = linphone_friend_get_presence_model_for_uri_or_tel(lFriend, number);
+		if (presence) {
+			keys.hasPresence = true;
+			char *contact = linphone_presence_model_get_contact(presence);
+			if (contact) {
+				keys.contactAddress = linphone_address_new(contact);
+				if (keys.contactAddress) {
+					keys.contactLC = toLowerCase(contact);
+					const char *domain = linphone_address_get_domain(keys.contactAddress);
+					keys.contactDomain = domain ? domain : "";
+				}
+				bctbx_free(contact);
+			}
+		}
+		phoneNumbers.push_back(move(keys));
+	}
+	if (numbers) bctbx_list_free(numbers);
+}
+
+MagicSearchFriendRecord::~MagicSearchFriendRecord () {
+	for (const auto &keys : addresses)
+		linphone_address_unref(keys.address);
+	for (const auto &keys : phoneNumbers) {
+		if (keys.contactAddress)
+			linphone_address_unref(keys.contactAddress);
+	}
+}
+
+// Must be kept in sync with the strings weighted by MagicSearch::searchInFriend().
+vector<string> MagicSearchFriendRecord::getSearchKeys () const {
+	vector<string> keys;
+	if (hasName)
+		keys.push_back(nameLC);
+	for (const auto &address : addresses) {
+		if (address.hasUsername)
+			keys.push_back(address.usernameLC);
+		if (address.hasDisplayName)
+			keys.push_back(address.displayNameLC);
+	}
+	for (const auto &number : phoneNumbers) {
+		keys.push_back(number.numberLC);
+		if (number.contactAddress)
+			keys.push_back(number.contactLC);
+	}
+	return keys;
+}
+
+void MagicSearchFriendRecord::match (const string &filterLC, const string &withDomain, const MagicSearchWeights &weights, vector<Match> &matches) const {
+	unsigned int weight = weights.minWeight;
+	bool onlyOneDomain = !withDomain.empty() && withDomain != "*";
+
+	// NAME
+	if (hasName) {
+		weight += weights.getWeight(nameLC, filterLC) * 3;
+	}
+
+	//SIP URI
+	for (const auto &address : addresses) {
+		bool addressInDomain = !onlyOneDomain || compareStringItems(withDomain.c_str(), address.domain.c_str()) == 0;
+		// Same as MagicSearch::checkDomain() with the presence of the friend
+		if (!addressInDomain && !(address.hasPresenceDomain && compareStringItems(withDomain.c_str(), address.presenceDomain.c_str()) == 0)) {
+			if (!withDomain.empty()) {
+				continue;
+			}
+		}
+
+		// Same as MagicSearch::searchInAddress()
+		unsigned int weightAddress = weights.minWeight;
+		if (addressInDomain) {
+			if (address.hasUsername) {
+				weightAddress += weights.getWeight(address.usernameLC, filterLC);
+			}
+			if (address.hasDisplayName) {
+				weightAddress += weights.getWeight(address.displayNameLC, filterLC);
+			}
+		}
+
+		if ((weightAddress + weight) > weights.minWeight) {
+			matches.push_back({ weight + weightAddress, address.address, nullptr });
+		}
+	}
+
+	// PHONE NUMBER
+	for (const auto &phoneNumber : phoneNumbers) {
+		unsigned int weightNumber = weights.getWeight(phoneNumber.numberLC, filterLC);
+		if (phoneNumber.hasPresence) {
+			if (phoneNumber.contactAddress) {
+				if (withDomain.empty() || withDomain == "*" || compareStringItems(phoneNumber.contactDomain.c_str(), withDomain.c_str()) == 0) {
+					weightNumber += weights.getWeight(phoneNumber.contactLC, filterLC) * 2;
+					if ((weightNumber + weight) > weights.minWeight) {
+						matches.push_back({ weight + weightNumber, phoneNumber.contactAddress, &phoneNumber.number });
+					}
+				}
+			}
+		} else {
+			if ((weightNumber + weight) > weights.minWeight && withDomain.empty()) {
+				matches.push_back({ weight + weightNumber, nullptr, &phoneNumber.number });
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+MagicSearchAddressRecord::MagicSearchAddressRecord (const LinphoneAddress *address, bool matchAllWithoutFilter) {
+	mAddress = linphone_address_ref(const_cast<LinphoneAddress *>(address));
+	mMatchAllWithoutFilter = matchAllWithoutFilter;
+	if (linphone_address_get_username(address)) {
+		mHasUsername = true;
+		mUsernameLC = toLowerCase(linphone_address_get_username(address));
+	}
+	if (linphone_address_get_display_name(address)) {
+		mHasDisplayName = true;
+		mDisplayNameLC = toLowerCase(linphone_address_get_display_name(address));
+	}
+	if (linphone_address_get_domain(address))
+		mDomain = linphone_address_get_domain(address);
+}
+
+MagicSearchAddressRecord::MagicSearchAddressRecord (MagicSearchAddressRecord &&other) :
+	mAddress(other.mAddress),
+	mMatchAllWithoutFilter(other.mMatchAllWithoutFilter),
+	mHasUsername(other.mHasUsername),
+	mUsernameLC(move(other.mUsernameLC)),
+	mHasDisplayName(other.mHasDisplayName),
+	mDisplayNameLC(move(other.mDisplayNameLC)),
+	mDomain(move(other.mDomain)) {
+	other.mAddress = nullptr;
+}
+
+MagicSearchAddressRecord::~MagicSearchAddressRecord () {
+	if (mAddress)
+		linphone_address_unref(mAddress);
+}
+
+const LinphoneAddress *MagicSearchAddressRecord::getAddress () const {
+	return mAddress;
+}
+
+bool MagicSearchAddressRecord::match (const string &filterLC, const string &withDomain, const MagicSearchWeights &weights, unsigned int &weight) const {
+	if (filterLC.empty() && (withDomain.empty() || mMatchAllWithoutFilter)) {
+		weight = 0;
+		return true;
+	}
+	weight = weights.minWeight;
+	bool onlyOneDomain = !withDomain.empty() && withDomain != "*";
+	if (!onlyOneDomain || compareStringItems(withDomain.c_str(), mDomain.c_str()) == 0) {
+		if (mHasUsername)
+			weight += weights.getWeight(mUsernameLC, filterLC);
+		if (mHasDisplayName)
+			weight += weights.getWeight(mDisplayNameLC, filterLC);
+	}
+	return weight > weights.minWeight;
+}
+
+// -----------------------------------------------------------------------------
+
+MagicSearchIndex *MagicSearchIndex::create (const LinphoneFriendList *friendList) {
+	MagicSearchIndex *index = new MagicSearchIndex();
+	// Friends are prepended to the list: walk it backward to keep the insertion order.
+	bctbx_list_t *friends = bctbx_list_copy(friendList->friends);
+	friends = bctbx_list_reverse(friends);
+	for (bctbx_list_t *f = friends ; f != nullptr ; f = bctbx_list_next(f))
+		index->addFriend(static_cast<LinphoneFriend *>(f->data));
+	bctbx_list_free(friends);
+	lInfo() << "[Magic Search] Index created for " << index->size() << " friends";
+	return index;
+}
+
+void MagicSearchIndex::addFriend (LinphoneFriend *lFriend) {
+	auto it = mEntries.find(lFriend);
+	if (it != mEntries.end()) {
+		invalidateFriend(lFriend);
+		return;
+	}
+	Entry entry;
+	entry.lFriend = lFriend;
+	entry.order = mNextOrder++;
+	mEntries.emplace(lFriend, move(entry));
+	mDirtyFriends.insert(lFriend);
+}
+
+void MagicSearchIndex::removeFriend (const LinphoneFriend *lFriend) {
+	auto it = mEntries.find(lFriend);
+	if (it == mEntries.end())
+		return;
+	unindexFriend(it->second);
+	mEntries.erase(it);
+	mDirtyFriends.erase(lFriend);
+}
+
+void MagicSearchIndex::invalidateFriend (const LinphoneFriend *lFriend) {
+	if (mEntries.find(lFriend) != mEntries.end())
+		mDirtyFriends.insert(lFriend);
+}
+
+size_t MagicSearchIndex::size () const {
+	return mEntries.size();
+}
+
+void MagicSearchIndex::update (LinphoneProxyConfig *proxy) {
+	const char *dialPrefix = proxy ? linphone_proxy_config_get_dial_prefix(proxy) : nullptr;
+	bool dialEscapePlus = proxy ? !!linphone_proxy_config_get_dial_escape_plus(proxy) : false;
+	if (mHasProxy != (proxy != nullptr) || mDialPrefix != (dialPrefix ? dialPrefix : "") || mDialEscapePlus != dialEscapePlus) {
+		// Phone numbers have to be normalized again with the new dial plan.
+		for (const auto &entry : mEntries)
+			mDirtyFriends.insert(entry.first);
+		mHasProxy = (proxy != nullptr);
+		mDialPrefix = dialPrefix ? dialPrefix : "";
+		mDialEscapePlus = dialEscapePlus;
+	}
+
+	if (mDirtyFriends.empty())
+		return;
+	lDebug() << "[Magic Search] Indexing " << mDirtyFriends.size() << " friends";
+	for (const LinphoneFriend *lFriend : mDirtyFriends) {
+		Entry &entry = mEntries.at(lFriend);
+		unindexFriend(entry);
+		indexFriend(entry, proxy);
+	}
+	mDirtyFriends.clear();
+}
+
+shared_ptr<const MagicSearchFriendRecord> MagicSearchIndex::getRecord (const LinphoneFriend *lFriend) const {
+	auto it = mEntries.find(lFriend);
+	return it == mEntries.end() ? nullptr : it->second.record;
+}
+
+vector<LinphoneFriend *> MagicSearchIndex::findCandidates (const string &filterLC) const {
+	vector<LinphoneFriend *> candidates;
+	vector<const vector<const LinphoneFriend *> *> postings;
+	if (filterLC.size() <= MaxGramSize) {
+		auto it = mGrams.find(filterLC);
+		if (it == mGrams.end())
+			return candidates;
+		postings.push_back(&it->second);
+	} else {
+		for (size_t i = 0; i + MaxGramSize <= filterLC.size(); ++i) {
+			auto it = mGrams.find(filterLC.substr(i, MaxGramSize));
+			if (it == mGrams.end())
+				return candidates;
+			postings.push_back(&it->second);
+		}
+	}
+
+	// Intersect all the postings, starting from the smallest one. A friend appears at most once per posting.
+	sort(postings.begin(), postings.end(), [](const vector<const LinphoneFriend *> *a, const vector<const LinphoneFriend *> *b) {
+		return a->size() < b->size();
+	});
+	unordered_map<const LinphoneFriend *, size_t> matches;
+	matches.reserve(postings.front()->size());
+	for (const LinphoneFriend *lFriend : *postings.front())
+		matches[lFriend] = 1;
+	for (size_t i = 1; i < postings.size(); ++i) {
+		for (const LinphoneFriend *lFriend : *postings[i]) {
+			auto it = matches.find(lFriend);
+			if (it != matches.end() && it->second == i)
+				it->second++;
+		}
+	}
+
+	vector<const Entry *> entries;
+	for (const auto &match : matches) {
+		if (match.second == postings.size())
+			entries.push_back(&mEntries.at(match.first));
+	}
+	sort(entries.begin(), entries.end(), [](const Entry *a, const Entry *b) {
+		return a->order > b->order;
+	});
+	candidates.reserve(entries.size());
+	for (const Entry *entry : entries)
+		candidates.push_back(entry->lFriend);
+	return candidates;
+}
+
+// -----------------------------------------------------------------------------
+
+void MagicSearchIndex::indexFriend (Entry &entry, LinphoneProxyConfig *proxy) {
+	entry.record = make_shared<const MagicSearchFriendRecord>(entry.lFriend, proxy);
+	for (const string &gram : getGrams(entry.record->getSearchKeys()))
+		mGrams[gram].push_back(entry.lFriend);
+}
+
+void MagicSearchIndex::unindexFriend (Entry &entry) {
+	if (!entry.record)
+		return;
+	for (const string &gram : getGrams(entry.record->getSearchKeys())) {
+		auto it = mGrams.find(gram);
+		if (it == mGrams.end())
+			continue;
+		vector<const LinphoneFriend *> &posting = it->second;
+		auto friendIt = find(posting.begin(), posting.end(), entry.lFriend);
+		if (friendIt != posting.end()) {
+			*friendIt = posting.back();
+			posting.pop_back();
+		}
+		if (posting.empty())
+			mGrams.erase(it);
+	}
+	entry.record.reset();
+}
+
+unordered_set<string> MagicSearchIndex::getGrams (const vector<string> &keys) {
+	unordered_set<string> grams;
+	for (const string &key : keys) {
+		for (size_t i = 0; i < key.size(); ++i) {
+			for (size_t n = 1; n <= MaxGramSize && i + n <= key.size(); ++n)
+				grams.insert(key.substr(i, n));
+		}
+	}
+	return grams;
+}
+
+LINPHONE_END_NAMESPACE
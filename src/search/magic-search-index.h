@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_MAGIC_SEARCH_INDEX_H_
+#define _L_MAGIC_SEARCH_INDEX_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "linphone/types.h"
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Weighting settings of a MagicSearch, copied so that a search can run outside of the main loop.
+ */
+struct MagicSearchWeights {
+	unsigned int minWeight = 0;
+	unsigned int maxWeight = 1000;
+	bool useDelimiter = true;
+	std::string delimiter;
+
+	/**
+	 * Return a weight for a searched in with a filter
+	 * @param[in] stringWordsLC lowercased string where we are searching
+	 * @param[in] filterLC lowercased filter
+	 * @return calculate weight
+	 **/
+	unsigned int getWeight (const std::string &stringWordsLC, const std::string &filterLC) const;
+};
+
+/**
+ * Search keys of a friend, computed once and kept until the friend or the default proxy config changes.
+ * All the "LC" strings are lowercased the same way MagicSearch lowercases its filter.
+ */
+class MagicSearchFriendRecord {
+public:
+	struct AddressKeys {
+		LinphoneAddress *address = nullptr; // Referenced, can be returned in a SearchResult.
+		bool hasUsername = false;
+		std::string usernameLC;
+		bool hasDisplayName = false;
+		std::string displayNameLC;
+		std::string domain;
+		bool hasPresenceDomain = false;
+		std::string presenceDomain; // Domain of the presence contact associated to the address.
+	};
+
+	struct PhoneNumberKeys {
+		std::string number; // Normalized with the default proxy config, if any.
+		std::string numberLC;
+		bool hasPresence = false;
+		LinphoneAddress *contactAddress = nullptr; // Referenced, parsed presence contact.
+		std::string contactLC;
+		std::string contactDomain;
+	};
+
+	// A SearchResult to create for the friend.
+	struct Match {
+		unsigned int weight;
+		const LinphoneAddress *address; // Owned by the record, can be nullptr.
+		const std::string *phoneNumber; // Owned by the record, nullptr for SIP addresses.
+	};
+
+	MagicSearchFriendRecord (const LinphoneFriend *lFriend, LinphoneProxyConfig *proxy);
+	MagicSearchFriendRecord (const MagicSearchFriendRecord &other) = delete;
+	~MagicSearchFriendRecord ();
+
+	/**
+	 * @return all the lowercased strings MagicSearch may weight for this friend
+	 **/
+	std::vector<std::string> getSearchKeys () const;
+
+	/**
+	 * Weight the addresses and phone numbers of the friend. Only reads the record: it can be called from any thread.
+	 * @param[in] filterLC lowercased word we search
+	 * @param[in] withDomain domain which we want to search only
+	 * @param[in] weights weighting settings of the search
+	 * @param[out] matches where to append the addresses and phone numbers which match
+	 **/
+	void match (const std::string &filterLC, const std::string &withDomain, const MagicSearchWeights &weights, std::vector<Match> &matches) const;
+
+	bool hasName = false;
+	std::string nameLC;
+	std::vector<AddressKeys> addresses;
+	std::vector<PhoneNumberKeys> phoneNumbers;
+};
+
+/**
+ * Search keys of an address coming from a call log or a chat room.
+ */
+class MagicSearchAddressRecord {
+public:
+	/**
+	 * @param[in] address the address, referenced by the record
+	 * @param[in] matchAllWithoutFilter whether the address matches an empty filter whatever the domain
+	 **/
+	MagicSearchAddressRecord (const LinphoneAddress *address, bool matchAllWithoutFilter);
+	MagicSearchAddressRecord (const MagicSearchAddressRecord &other) = delete;
+	MagicSearchAddressRecord (MagicSearchAddressRecord &&other);
+	~MagicSearchAddressRecord ();
+
+	/**
+	 * Same as MagicSearch::searchInAddress(). Only reads the record: it can be called from any thread.
+	 * @param[in] filterLC lowercased word we search
+	 * @param[in] withDomain domain which we want to search only
+	 * @param[in] weights weighting settings of the search
+	 * @param[out] weight weight of the address
+	 * @return true if the address matches
+	 **/
+	bool match (const std::string &filterLC, const std::string &withDomain, const MagicSearchWeights &weights, unsigned int &weight) const;
+
+	const LinphoneAddress *getAddress () const;
+
+private:
+	LinphoneAddress *mAddress = nullptr;
+	bool mMatchAllWithoutFilter = false;
+	bool mHasUsername = false;
+	std::string mUsernameLC;
+	bool mHasDisplayName = false;
+	std::string mDisplayNameLC;
+	std::string mDomain;
+};
+
+/**
+ * In-memory n-gram index over the searchable keys of the friends of a friend list
+ * (vCard full name, SIP usernames and display names, normalized phone numbers and their presence contacts).
+ * It only narrows the set of friends that may match a filter: weights are still computed by MagicSearch.
+ * Friends are (re)indexed lazily, on the first lookup following their addition or modification.
+ */
+class MagicSearchIndex {
+public:
+	MagicSearchIndex () = default;
+	MagicSearchIndex (const MagicSearchIndex &other) = delete;
+
+	/**
+	 * Build an index holding all the friends currently in the list.
+	 * @param[in] friendList the friend list to index
+	 * @return a new index, owned by the caller
+	 **/
+	static MagicSearchIndex *create (const LinphoneFriendList *friendList);
+
+	/**
+	 * Register a friend added to the indexed list.
+	 * @param[in] lFriend the friend
+	 **/
+	void addFriend (LinphoneFriend *lFriend);
+
+	/**
+	 * Forget a friend removed from the indexed list.
+	 * @param[in] lFriend the friend
+	 **/
+	void removeFriend (const LinphoneFriend *lFriend);
+
+	/**
+	 * Schedule a friend for re-indexation, after its name, addresses, phone numbers or presence changed.
+	 * @param[in] lFriend the friend
+	 **/
+	void invalidateFriend (const LinphoneFriend *lFriend);
+
+	/**
+	 * Re-index the friends modified since the last update, or all of them if the dial plan of the proxy config changed.
+	 * @param[in] proxy the proxy config used to normalize phone numbers, can be nullptr
+	 **/
+	void update (LinphoneProxyConfig *proxy);
+
+	/**
+	 * Find all friends having at least one searchable key containing the filter.
+	 * update() must have been called before.
+	 * @param[in] filterLC non empty lowercased word we search
+	 * @return the candidate friends, in the order of the friend list
+	 **/
+	std::vector<LinphoneFriend *> findCandidates (const std::string &filterLC) const;
+
+	/**
+	 * update() must have been called before.
+	 * A record is never modified: it is replaced when the friend is re-indexed, and can be shared with a search running on another thread.
+	 * @param[in] lFriend the friend
+	 * @return the search record of the friend, nullptr if it is not in the indexed list
+	 **/
+	std::shared_ptr<const MagicSearchFriendRecord> getRecord (const LinphoneFriend *lFriend) const;
+
+	/**
+	 * @return the number of indexed friends
+	 **/
+	size_t size () const;
+
+private:
+	struct Entry {
+		LinphoneFriend *lFriend;
+		uint64_t order; // Insertion order, the friend list prepends its friends.
+		std::shared_ptr<const MagicSearchFriendRecord> record; // The record the friend is currently indexed with.
+	};
+
+	static const size_t MaxGramSize = 3;
+
+	void indexFriend (Entry &entry, LinphoneProxyConfig *proxy);
+	void unindexFriend (Entry &entry);
+
+	static std::unordered_set<std::string> getGrams (const std::vector<std::string> &keys);
+
+	std::unordered_map<const LinphoneFriend *, Entry> mEntries;
+	std::unordered_map<std::string, std::vector<const LinphoneFriend *>> mGrams;
+	std::unordered_set<const LinphoneFriend *> mDirtyFriends;
+
+	// Dial plan used to normalize the indexed phone numbers.
+	bool mHasProxy = false;
+	std::string mDialPrefix;
+	bool mDialEscapePlus = false;
+
+	uint64_t mNextOrder = 0;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_MAGIC_SEARCH_INDEX_H_
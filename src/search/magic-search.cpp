@@ -17,8 +17,11 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "local-search-cb-data.h"
+#include "magic-search-index.h"
 #include "magic-search-p.h"
 #include "search-async-data.h"
+#include "search-results-merger.h"
 
 #include <bctoolbox/list.h>
 #include <algorithm>
@@ -362,21 +365,10 @@ void MagicSearch::setSearchCache (std::shared_ptr<list<std::shared_ptr<SearchRes
 		d->mCacheResult = cache;
 }
 
-static bool findAddress (const list<std::shared_ptr<SearchResult>> &list, const LinphoneAddress *addr) {
-	for (auto r : list) {
-		if (r->getAddress()) {
-			if (linphone_address_weak_equal(r->getAddress(), addr)) {
-				return true;
-			}
-		}
-	}
-	return false;
-}
-
 list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromCallLog (
 	const string &filter,
 	const string &withDomain,
-	const list<std::shared_ptr<SearchResult>> &currentList
+	const SearchResultsMerger &currentResults
 ) const {
 	list<std::shared_ptr<SearchResult>> resultList;
 	const bctbx_list_t *callLog = linphone_core_get_call_logs(this->getCore()->getCCore());
@@ -388,12 +380,12 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromCallLog (
 		linphone_call_log_get_from_address(log) : linphone_call_log_get_to_address(log);
 		if (addr && linphone_call_log_get_status(log) != LinphoneCallAborted) {
 			if (filter.empty() && withDomain.empty()) {
-				if (findAddress(currentList, addr)) continue;
+				if (currentResults.contains(addr)) continue;
 				resultList.push_back(SearchResult::create((unsigned int)0, addr, "", nullptr, LinphoneMagicSearchSourceCallLogs));
 			} else {
 				unsigned int weight = searchInAddress(addr, filter, withDomain);
 				if (weight > getMinWeight()) {
-					if (findAddress(currentList, addr)) continue;
+					if (currentResults.contains(addr)) continue;
 					resultList.push_back(SearchResult::create(weight, addr, "", nullptr, LinphoneMagicSearchSourceCallLogs));
 				}
 			}
@@ -407,7 +399,7 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromCallLog (
 list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomParticipants (
 	const string &filter,
 	const string &withDomain,
-	const list<std::shared_ptr<SearchResult>> &currentList
+	const SearchResultsMerger &currentResults
 ) const {
 	list<std::shared_ptr<SearchResult>> resultList;
 	const bctbx_list_t *chatRooms = linphone_core_get_chat_rooms(this->getCore()->getCCore());
@@ -421,7 +413,7 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomPart
 				LinphoneParticipant *participant = static_cast<LinphoneParticipant*>(p->data);
 				const LinphoneAddress *addr = linphone_address_clone(linphone_participant_get_address(participant));
 				if (filter.empty() && withDomain.empty()) {
-					if (findAddress(currentList, addr)) {
+					if (currentResults.contains(addr)) {
 						linphone_address_unref(const_cast<LinphoneAddress *>(addr));
 						continue;
 					}
@@ -429,7 +421,7 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomPart
 				} else {
 					unsigned int weight = searchInAddress(addr, filter, withDomain);
 					if (weight > getMinWeight()) {
-						if (findAddress(currentList, addr)) {
+						if (currentResults.contains(addr)) {
 							linphone_address_unref(const_cast<LinphoneAddress *>(addr));
 							continue;
 						}
@@ -446,7 +438,7 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomPart
 			if( peerAddress){
 				LinphoneAddress *addr = linphone_address_clone(peerAddress);
 				if (filter.empty()) {
-					if (findAddress(currentList, addr)) {
+					if (currentResults.contains(addr)) {
 						linphone_address_unref(addr);		
 						continue;
 					}
@@ -454,7 +446,7 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomPart
 				} else {
 					unsigned int weight = searchInAddress(addr, filter, withDomain);
 					if (weight > getMinWeight()) {
-						if (findAddress(currentList, addr)) {
+						if (currentResults.contains(addr)) {
 							linphone_address_unref(addr);
 							continue;
 						}
@@ -470,6 +462,39 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomPart
 	return resultList;
 }
 
+list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromFriends (const string &filter, const string &withDomain) const {
+	list<std::shared_ptr<SearchResult>> resultList;
+	const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(this->getCore()->getCCore());
+	LinphoneProxyConfig *proxy = linphone_core_get_default_proxy_config(this->getCore()->getCCore());
+	const string filterLC = Utils::stringToLower(filter);
+	// With a minimum weight, every friend gets a positive weight whatever the filter: the index cannot help.
+	bool useIndex = !filter.empty() && getMinWeight() == 0;
+
+	for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
+		LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
+		MagicSearchIndex *index = linphone_friend_list_get_search_index(fList);
+		index->update(proxy);
+		if (useIndex) {
+			for (LinphoneFriend *lFriend : index->findCandidates(filterLC)) {
+				list<std::shared_ptr<SearchResult>> fResults = searchInFriend(lFriend, *index->getRecord(lFriend), filterLC, withDomain);
+				addResultsToResultsList(fResults, resultList);
+			}
+		} else {
+			for (bctbx_list_t *f = fList->friends ; f != nullptr ; f = bctbx_list_next(f)) {
+				const LinphoneFriend *lFriend = static_cast<LinphoneFriend*>(f->data);
+				std::shared_ptr<const MagicSearchFriendRecord> record = index->getRecord(lFriend);
+				list<std::shared_ptr<SearchResult>> fResults = record
+					? searchInFriend(lFriend, *record, filterLC, withDomain)
+					: searchInFriend(lFriend, filter, withDomain);
+				addResultsToResultsList(fResults, resultList);
+			}
+		}
+	}
+
+	lInfo() << "[Magic Search] Found " << resultList.size() << " results in friends";
+	return resultList;
+}
+
 #ifdef LDAP_ENABLED
 void MagicSearch::getAddressFromLDAPServerStartAsync (
 	const string &filter,
@@ -535,76 +560,134 @@ std::list<list<std::shared_ptr<SearchResult>>> MagicSearch::getAddressFromLDAPSe
 }
 #endif
 
-// List all searchs to be done. Provider order will prioritize results : next contacts will be removed if already exist in results
-void MagicSearch::beginNewSearchAsync (const SearchRequest& request, SearchAsyncData * asyncData) const{
-	asyncData->clear();
-	asyncData->setSearchRequest(request);
-	if( (request.getSourceFlags() & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends){
-		const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(this->getCore()->getCCore());
-		list<std::shared_ptr<SearchResult>> friendsList;
-		for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
-			LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
-			// For all friends or when we reach the search limit
+std::shared_ptr<LocalSearchCbData> MagicSearch::createLocalSearchCbData (int sourceFlags, const SearchRequest& request, SearchAsyncData * asyncData) const {
+	std::shared_ptr<LocalSearchCbData> data = std::make_shared<LocalSearchCbData>(sourceFlags, asyncData);
+	data->mResult = asyncData->createResult();
+	data->mParent = this;
+	data->mFilter = request.getFilter();
+	data->mWithDomain = request.getWithDomain();
+	asyncData->pushData(data);
+	return data;
+}
+
+void MagicSearch::getAddressFromFriendsStartAsync (const SearchRequest& request, SearchAsyncData * asyncData) const {
+	std::shared_ptr<LocalSearchCbData> data = createLocalSearchCbData(LinphoneMagicSearchSourceFriends, request, asyncData);
+	const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(this->getCore()->getCCore());
+	LinphoneProxyConfig *proxy = linphone_core_get_default_proxy_config(this->getCore()->getCCore());
+	// Same candidates as getAddressFromFriends(): only the weighting is done by the worker thread.
+	bool useIndex = !request.getFilter().empty() && getMinWeight() == 0;
+	const string filterLC = Utils::stringToLower(request.getFilter());
+
+	for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
+		LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
+		MagicSearchIndex *index = linphone_friend_list_get_search_index(fList);
+		index->update(proxy);
+		if (useIndex) {
+			for (LinphoneFriend *lFriend : index->findCandidates(filterLC))
+				data->addFriend(lFriend, index->getRecord(lFriend));
+		} else {
 			for (bctbx_list_t *f = fList->friends ; f != nullptr ; f = bctbx_list_next(f)) {
-				list<std::shared_ptr<SearchResult>> fResults = searchInFriend(static_cast<LinphoneFriend*>(f->data), request.getFilter(), request.getWithDomain());
-				addResultsToResultsList(fResults, friendsList);
+				LinphoneFriend *lFriend = static_cast<LinphoneFriend*>(f->data);
+				std::shared_ptr<const MagicSearchFriendRecord> record = index->getRecord(lFriend);
+				if (!record)
+					record = std::make_shared<const MagicSearchFriendRecord>(lFriend, proxy);
+				data->addFriend(lFriend, record);
 			}
 		}
-		lInfo() << "[Magic Search] Found " << friendsList.size() << " results in friends";
-		asyncData->createResult(friendsList);
 	}
+	LocalSearchCbData::start(data, this->getCore(), getWeights());
+}
+
+void MagicSearch::getAddressFromCallLogStartAsync (const SearchRequest& request, SearchAsyncData * asyncData) const {
+	std::shared_ptr<LocalSearchCbData> data = createLocalSearchCbData(LinphoneMagicSearchSourceCallLogs, request, asyncData);
+	const bctbx_list_t *callLog = linphone_core_get_call_logs(this->getCore()->getCCore());
+	for (const bctbx_list_t *f = callLog ; f != nullptr ; f = bctbx_list_next(f)) {
+		LinphoneCallLog *log = static_cast<LinphoneCallLog*>(f->data);
+		const LinphoneAddress *addr = (linphone_call_log_get_dir(log) == LinphoneCallDir::LinphoneCallIncoming) ?
+		linphone_call_log_get_from_address(log) : linphone_call_log_get_to_address(log);
+		if (addr && linphone_call_log_get_status(log) != LinphoneCallAborted)
+			data->addAddress(addr, false);
+	}
+	LocalSearchCbData::start(data, this->getCore(), getWeights());
+}
+
+void MagicSearch::getAddressFromGroupChatRoomParticipantsStartAsync (const SearchRequest& request, SearchAsyncData * asyncData) const {
+	std::shared_ptr<LocalSearchCbData> data = createLocalSearchCbData(LinphoneMagicSearchSourceChatRooms, request, asyncData);
+	const bctbx_list_t *chatRooms = linphone_core_get_chat_rooms(this->getCore()->getCCore());
+	for (const bctbx_list_t *f = chatRooms ; f != nullptr ; f = bctbx_list_next(f)) {
+		LinphoneChatRoom *room = static_cast<LinphoneChatRoom*>(f->data);
+		if (linphone_chat_room_get_capabilities(room) & LinphoneChatRoomCapabilitiesConference) {
+			bctbx_list_t *participants = linphone_chat_room_get_participants(room);
+			for (const bctbx_list_t *p = participants ; p != nullptr ; p = bctbx_list_next(p)) {
+				LinphoneParticipant *participant = static_cast<LinphoneParticipant*>(p->data);
+				LinphoneAddress *addr = linphone_address_clone(linphone_participant_get_address(participant));
+				data->addAddress(addr, false);
+				linphone_address_unref(addr);
+			}
+			bctbx_list_free_with_data(participants, (bctbx_list_free_func)linphone_participant_unref);
+		} else if (linphone_chat_room_get_capabilities(room) & LinphoneChatRoomCapabilitiesBasic) {
+			const LinphoneAddress* peerAddress = linphone_chat_room_get_peer_address(room);// Can return NULL if getPeerAddress() is not valid
+			if (peerAddress) {
+				LinphoneAddress *addr = linphone_address_clone(peerAddress);
+				data->addAddress(addr, true);
+				linphone_address_unref(addr);
+			}
+		}
+	}
+	LocalSearchCbData::start(data, this->getCore(), getWeights());
+}
+
+// List all searchs to be done. Provider order will prioritize results : next contacts will be removed if already exist in results
+// Friends, call logs and chat rooms are searched concurrently on worker threads, LDAP servers stay driven by the main loop.
+void MagicSearch::beginNewSearchAsync (const SearchRequest& request, SearchAsyncData * asyncData) const{
+	asyncData->clear();
+	asyncData->setSearchRequest(request);
+	if( (request.getSourceFlags() & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends)
+		getAddressFromFriendsStartAsync(request, asyncData);
 #ifdef LDAP_ENABLED
 	if( (request.getSourceFlags() & LinphoneMagicSearchSourceLdapServers) == LinphoneMagicSearchSourceLdapServers && linphone_core_is_network_reachable(this->getCore()->getCCore()))
 		getAddressFromLDAPServerStartAsync(request.getFilter(), request.getWithDomain(), asyncData);
 #endif
 	if( (request.getSourceFlags() & LinphoneMagicSearchSourceCallLogs) == LinphoneMagicSearchSourceCallLogs)
-		asyncData->createResult(getAddressFromCallLog(request.getFilter(), request.getWithDomain(), list<std::shared_ptr<SearchResult>>()));
+		getAddressFromCallLogStartAsync(request, asyncData);
 	if( (request.getSourceFlags() & LinphoneMagicSearchSourceChatRooms) == LinphoneMagicSearchSourceChatRooms)
-		asyncData->createResult(getAddressFromGroupChatRoomParticipants(request.getFilter(), request.getWithDomain(), list<std::shared_ptr<SearchResult>>()));
+		getAddressFromGroupChatRoomParticipantsStartAsync(request, asyncData);
 }
 
 void MagicSearch::mergeResults (const SearchRequest& request, SearchAsyncData * asyncData) {
-	std::shared_ptr<list<std::shared_ptr<SearchResult>>> resultList = std::make_shared<list<std::shared_ptr<SearchResult>>>();
+	SearchResultsMerger merger;
 	for(auto it = asyncData->mProviderResults.begin() ; it != asyncData->mProviderResults.end() ; ++it){
-		addResultsToResultsList(*it, *resultList, request.getFilter(), request.getWithDomain());
+		merger.merge(*it);
 	}
-	asyncData->setSearchResults(resultList);
+	asyncData->setSearchResults(merger.toList());
 }
 
 std::shared_ptr<list<std::shared_ptr<SearchResult>>> MagicSearch::beginNewSearch (const string &filter, const string &withDomain, int sourceFlags) {
 	list<std::shared_ptr<SearchResult>> clResults, crResults;
 	list<list<std::shared_ptr<SearchResult>>> multiClResults;
-	std::shared_ptr<list<std::shared_ptr<SearchResult>>> resultList = std::make_shared<list<std::shared_ptr<SearchResult>>>();
+	SearchResultsMerger merger;
 	
 	if( (sourceFlags & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends){
-		const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(this->getCore()->getCCore());
-
-		for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
-			LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
-			// For all friends or when we reach the search limit
-			for (bctbx_list_t *f = fList->friends ; f != nullptr ; f = bctbx_list_next(f)) {
-				list<std::shared_ptr<SearchResult>> fResults = searchInFriend(static_cast<LinphoneFriend*>(f->data), filter, withDomain);
-				addResultsToResultsList(fResults, *resultList);
-			}
-		}
+		list<std::shared_ptr<SearchResult>> fResults = getAddressFromFriends(filter, withDomain);
+		merger.append(fResults);
 	}
 #ifdef LDAP_ENABLED
 	if( (sourceFlags & LinphoneMagicSearchSourceLdapServers) == LinphoneMagicSearchSourceLdapServers && linphone_core_is_network_reachable(this->getCore()->getCCore())){
 		multiClResults = getAddressFromLDAPServer(filter, withDomain);
 		for(auto it = multiClResults.begin() ; it != multiClResults.end() ; ++it)
-			addResultsToResultsList(*it, *resultList, filter, withDomain);
+			merger.merge(*it);
 	}
 #endif
 	if( (sourceFlags & LinphoneMagicSearchSourceCallLogs) == LinphoneMagicSearchSourceCallLogs){
-		clResults = getAddressFromCallLog(filter, withDomain, *resultList);
-		addResultsToResultsList(clResults, *resultList);
+		clResults = getAddressFromCallLog(filter, withDomain, merger);
+		merger.append(clResults);
 	}
 	if( (sourceFlags & LinphoneMagicSearchSourceChatRooms) == LinphoneMagicSearchSourceChatRooms){
-		crResults = getAddressFromGroupChatRoomParticipants(filter, withDomain, *resultList);
-		addResultsToResultsList(crResults, *resultList);
+		crResults = getAddressFromGroupChatRoomParticipants(filter, withDomain, merger);
+		merger.append(crResults);
 	}
 
-	return resultList;
+	return merger.toList();
 }
 
 std::shared_ptr<list<std::shared_ptr<SearchResult>>> MagicSearch::continueSearch (const string &filter, const string &withDomain) const {
@@ -631,78 +714,27 @@ std::shared_ptr<list<std::shared_ptr<SearchResult>>> MagicSearch::continueSearch
 }
 
 list<std::shared_ptr<SearchResult>> MagicSearch::searchInFriend (const LinphoneFriend *lFriend, const string &filter, const string &withDomain) const{
-	list<std::shared_ptr<SearchResult>> friendResult;
-	string phoneNumber = "";
-	unsigned int weight = getMinWeight();
-
-	// NAME
-	if (linphone_core_vcard_supported()) {
-		if (linphone_friend_get_vcard(lFriend)) {
-			const char *name = linphone_vcard_get_full_name(linphone_friend_get_vcard(lFriend));
-			if (name) {
-				weight += getWeight(name, filter) * 3;
-			}
-		}
-	}
-
-	//SIP URI
-	for (const bctbx_list_t *listAddress = linphone_friend_get_addresses(lFriend);
-		 listAddress != nullptr && listAddress->data != nullptr;
-		 listAddress = listAddress->next) {
-		const LinphoneAddress *lAddress = static_cast<LinphoneAddress*>(listAddress->data);
-		if (!checkDomain(lFriend, lAddress, withDomain)) {
-			if (!withDomain.empty()) {
-				continue;
-			}
-		}
-
-		unsigned int weightAddress = searchInAddress(lAddress, filter, withDomain) * 1;
-
-		if ((weightAddress + weight) > getMinWeight()) {
-			friendResult.push_back(SearchResult::create(weight + weightAddress, lAddress, phoneNumber, lFriend, LinphoneMagicSearchSourceFriends));
-		}
-	}
-
-	// PHONE NUMBER
 	LinphoneProxyConfig *proxy = linphone_core_get_default_proxy_config(this->getCore()->getCCore());
-	bctbx_list_t *begin, *phoneNumbers = linphone_friend_get_phone_numbers(lFriend);
-	begin = phoneNumbers;
-	while (phoneNumbers && phoneNumbers->data) {
-		string number = static_cast<const char*>(phoneNumbers->data);
-		const LinphonePresenceModel *presence = linphone_friend_get_presence_model_for_uri_or_tel(lFriend, number.c_str());
-		phoneNumber = number;
-		if (proxy) {
-			char * buff = linphone_proxy_config_normalize_phone_number(proxy, phoneNumber.c_str());
-			if (buff) {
-				phoneNumber = buff;
-				bctbx_free(buff);
-			}
-		}
-		unsigned int weightNumber = getWeight(phoneNumber.c_str(), filter);
-		if (presence) {
-			char *contact = linphone_presence_model_get_contact(presence);
-			if (contact) {
-				LinphoneAddress *tmpAdd = linphone_core_create_address(this->getCore()->getCCore(), contact);
-				if (tmpAdd) {
-					if (withDomain.empty() || withDomain == "*" || compareStringItems(linphone_address_get_domain(tmpAdd), withDomain.c_str()) == 0) {
-						weightNumber += getWeight(contact, filter) * 2;
-						if ((weightNumber + weight) > getMinWeight()) {
-							friendResult.push_back(SearchResult::create(weight + weightNumber, tmpAdd, phoneNumber, lFriend, LinphoneMagicSearchSourceFriends));
-						}
-						linphone_address_unref(tmpAdd);
-						bctbx_free(contact);
-					}
-				}
-			}
-		} else {
-			if ((weightNumber + weight) > getMinWeight() && withDomain.empty()) {
-				friendResult.push_back(SearchResult::create(weight + weightNumber, nullptr, phoneNumber, lFriend, LinphoneMagicSearchSourceFriends));
-			}
-		}
-		phoneNumbers = phoneNumbers->next;
+	const string filterLC = Utils::stringToLower(filter);
+	if (lFriend->friend_list) {
+		MagicSearchIndex *index = linphone_friend_list_get_search_index(lFriend->friend_list);
+		index->update(proxy);
+		std::shared_ptr<const MagicSearchFriendRecord> record = index->getRecord(lFriend);
+		if (record)
+			return searchInFriend(lFriend, *record, filterLC, withDomain);
 	}
-	if (begin) bctbx_list_free(begin);
+	// The friend is no longer in a list (e.g. it comes from the cache of a previous search).
+	MagicSearchFriendRecord record(lFriend, proxy);
+	return searchInFriend(lFriend, record, filterLC, withDomain);
+}
 
+list<std::shared_ptr<SearchResult>> MagicSearch::searchInFriend (const LinphoneFriend *lFriend, const MagicSearchFriendRecord &record, const string &filterLC, const string &withDomain) const{
+	list<std::shared_ptr<SearchResult>> friendResult;
+	vector<MagicSearchFriendRecord::Match> matches;
+	record.match(filterLC, withDomain, getWeights(), matches);
+	for (const auto &match : matches) {
+		friendResult.push_back(SearchResult::create(match.weight, match.address, match.phoneNumber ? *match.phoneNumber : "", lFriend, LinphoneMagicSearchSourceFriends));
+	}
 	return friendResult;
 }
 
@@ -722,44 +754,21 @@ unsigned int MagicSearch::searchInAddress (const LinphoneAddress *lAddress, cons
 }
 
 unsigned int MagicSearch::getWeight (const string &stringWords, const string &filter) const {
-	locale loc;
-	string filterLC = filter;
-	string stringWordsLC = stringWords;
-	size_t weight = string::npos;
-
-	transform(stringWordsLC.begin(), stringWordsLC.end(), stringWordsLC.begin(), [](unsigned char c){ return tolower(c); });
-	transform(filterLC.begin(), filterLC.end(), filterLC.begin(), [](unsigned char c){ return tolower(c); });
-
-	// Finding all occurrences of "filterLC" in "stringWordsLC"
-	for (size_t w = stringWordsLC.find(filterLC);
-		w != string::npos;
-		w = stringWordsLC.find(filterLC, w + filterLC.length())
-	) {
-		// weight max if occurence find at beginning
-		if (w == 0) {
-			weight = getMaxWeight();
-		} else {
-			bool isDelimiter = false;
-			if (getUseDelimiter()) {
-				// get the char before the matched filterLC
-				const char l = stringWordsLC.at(w - 1);
-				// Check if it's a delimiter
-				for (const char d : getDelimiter()) {
-					if (l == d) {
-						isDelimiter = true;
-						break;
-					}
-				}
-			}
-			unsigned int newWeight = getMaxWeight() - (unsigned int)((isDelimiter) ? 1 : w + 1);
-			weight = (weight != string::npos) ? weight + newWeight : newWeight;
-		}
-		// Only one search on the stringWordsLC for the moment
-		// due to weight calcul which dos not take into the case of multiple occurence
-		break;
-	}
+	return getWeightLowerCase(Utils::stringToLower(stringWords), Utils::stringToLower(filter));
+}
 
-	return (weight != string::npos) ? (unsigned int)(weight) : getMinWeight();
+unsigned int MagicSearch::getWeightLowerCase (const string &stringWordsLC, const string &filterLC) const {
+	return getWeights().getWeight(stringWordsLC, filterLC);
+}
+
+MagicSearchWeights MagicSearch::getWeights () const {
+	L_D();
+	MagicSearchWeights weights;
+	weights.minWeight = d->mMinWeight;
+	weights.maxWeight = d->mMaxWeight;
+	weights.useDelimiter = d->mUseDelimiter;
+	weights.delimiter = d->mDelimiter;
+	return weights;
 }
 
 bool MagicSearch::checkDomain (const LinphoneFriend *lFriend, const LinphoneAddress *lAddress, const string &withDomain) const{
@@ -795,24 +804,6 @@ void MagicSearch::addResultsToResultsList (std::list<std::shared_ptr<SearchResul
 	}
 }
 
-void MagicSearch::addResultsToResultsList (std::list<std::shared_ptr<SearchResult>> &results, std::list<std::shared_ptr<SearchResult>> &srL, const std::string filter, const std::string& withDomain) const {
-	auto itResult = results.begin();
-	while(itResult != results.end()){// Merge addresses that are already in srL
-		const LinphoneAddress * addr = (*itResult)->getAddress();
-		auto srLAddress = std::find_if(srL.begin(), srL.end(), [addr](const std::shared_ptr<SearchResult>& r){
-									return r->getAddress() && linphone_address_weak_equal(r->getAddress(), addr);
-							});
-		if( srLAddress != srL.end()){
-			(*srLAddress)->merge(*itResult);
-			itResult = results.erase(itResult);
-		}else
-			++itResult;
-	}
-	if (!results.empty()) {
-		srL.splice(srL.end(), results);
-	}
-}
-
 void MagicSearch::uniqueItemsList (std::shared_ptr<list<std::shared_ptr<SearchResult>>> list) const {
 	lDebug() << "[Magic Search] List size before unique = " << list->size();
 	list->unique([](const std::shared_ptr<SearchResult>& lsr, const std::shared_ptr<SearchResult>& rsr){
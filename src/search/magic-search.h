@@ -32,8 +32,12 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
+class LocalSearchCbData;
+class MagicSearchFriendRecord;
 class MagicSearchPrivate;
+struct MagicSearchWeights;
 class SearchAsyncData;
+class SearchResultsMerger;
 
 class LINPHONE_PUBLIC MagicSearch : public CoreAccessor, public Object{
 public:
@@ -177,28 +181,28 @@ private:
 	 * Get all addresses from call log
 	 * @param[in] filter word we search
 	 * @param[in] withDomain domain which we want to search only
-	 * @param[in] currentList current list where we will check if address already exist
+	 * @param[in] currentResults current results where we will check if address already exist
 	 * @return all addresses from call log which match in a SearchResult list
 	 * @private
 	 **/
 	std::list<std::shared_ptr<SearchResult>> getAddressFromCallLog (
 		const std::string &filter,
 		const std::string &withDomain,
-		const std::list<std::shared_ptr<SearchResult>> &currentList
+		const SearchResultsMerger &currentResults
 	) const;
 
 	/**
 	 * Get all addresses from chat rooms participants
 	 * @param[in] filter word we search
 	 * @param[in] withDomain domain which we want to search only
-	 * @param[in] currentList current list where we will check if address already exist
+	 * @param[in] currentResults current results where we will check if address already exist
 	 * @return all address from chat rooms participants which match in a SearchResult list
 	 * @private
 	 **/
 	std::list<std::shared_ptr<SearchResult>> getAddressFromGroupChatRoomParticipants (
 		const std::string &filter,
 		const std::string &withDomain,
-		const std::list<std::shared_ptr<SearchResult>> &currentList
+		const SearchResultsMerger &currentResults
 	) const;
 
 #ifdef LDAP_ENABLED
@@ -223,6 +227,15 @@ private:
 	 **/
 	std::list<std::shared_ptr<SearchResult>> getFriends (const std::string &withDomain) const;
 
+	/**
+	 * Get all friends which match with the filter, using the search index of each friend list
+	 * @param[in] filter word we search
+	 * @param[in] withDomain domain which we want to search only
+	 * @return all friends addresses and phone numbers which match in a SearchResult list
+	 * @private
+	 **/
+	std::list<std::shared_ptr<SearchResult>> getAddressFromFriends (const std::string &filter, const std::string &withDomain) const;
+
 	/**
 	 * Begin the search from friend list
 	 * @param[in] filter word we search
@@ -250,6 +263,17 @@ private:
 	 **/
 	std::list<std::shared_ptr<SearchResult>> searchInFriend (const LinphoneFriend* lFriend, const std::string &filter, const std::string &withDomain) const;
 
+	/**
+	 * Search informations in the precomputed search keys of the friend given
+	 * @param[in] lFriend friend whose informations will be check
+	 * @param[in] record search keys of the friend
+	 * @param[in] filterLC lowercased word we search
+	 * @param[in] withDomain domain which we want to search only
+	 * @return list of result from friend
+	 * @private
+	 **/
+	std::list<std::shared_ptr<SearchResult>> searchInFriend (const LinphoneFriend* lFriend, const MagicSearchFriendRecord &record, const std::string &filterLC, const std::string &withDomain) const;
+
 	/**
 	 * Search informations in address given
 	 * @param[in] lAddress address whose informations will be check
@@ -268,6 +292,21 @@ private:
 	 **/
 	unsigned int getWeight (const std::string &stringWords, const std::string &filter) const;
 
+	/**
+	 * Same as getWeight() for already lowercased strings, without any allocation
+	 * @param[in] stringWordsLC lowercased string where we are searching
+	 * @param[in] filterLC lowercased filter
+	 * @return calculate weight
+	 * @private
+	 **/
+	unsigned int getWeightLowerCase (const std::string &stringWordsLC, const std::string &filterLC) const;
+
+	/**
+	 * @return a copy of the weighting settings, usable by a search running on another thread
+	 * @private
+	 **/
+	MagicSearchWeights getWeights () const;
+
 	/**
 	 * Return if the given address match domain policy
 	 * @param[in] lFriend friend whose domain will be check
@@ -307,6 +346,36 @@ private:
 	void getAddressFromLDAPServerStartAsync (const std::string &filter,const std::string &withDomain, SearchAsyncData * asyncData)const;
 #endif
 
+	/**
+	 * @brief createLocalSearchCbData Create a provider searching in a local source on a worker thread, and add it to SearchAsyncData.
+	 * @param sourceFlags The searched source (#LinphoneMagicSearchSource).
+	 * @param request : #SearchRequest that define filter and domain which we want to search only.
+	 * @param asyncData Instance to use for all data storage.
+	 * @return The provider, to be filled with the source snapshot before being started.
+	 */
+	std::shared_ptr<LocalSearchCbData> createLocalSearchCbData (int sourceFlags, const SearchRequest& request, SearchAsyncData * asyncData) const;
+
+	/**
+	 * @brief getAddressFromFriendsStartAsync Initialize SearchAsyncData with a provider weighting the friends on a worker thread.
+	 * @param request : #SearchRequest that define filter and domain which we want to search only.
+	 * @param asyncData Instance to use for all data storage.
+	 */
+	void getAddressFromFriendsStartAsync (const SearchRequest& request, SearchAsyncData * asyncData) const;
+
+	/**
+	 * @brief getAddressFromCallLogStartAsync Initialize SearchAsyncData with a provider weighting the call logs on a worker thread.
+	 * @param request : #SearchRequest that define filter and domain which we want to search only.
+	 * @param asyncData Instance to use for all data storage.
+	 */
+	void getAddressFromCallLogStartAsync (const SearchRequest& request, SearchAsyncData * asyncData) const;
+
+	/**
+	 * @brief getAddressFromGroupChatRoomParticipantsStartAsync Initialize SearchAsyncData with a provider weighting the chat rooms participants on a worker thread.
+	 * @param request : #SearchRequest that define filter and domain which we want to search only.
+	 * @param asyncData Instance to use for all data storage.
+	 */
+	void getAddressFromGroupChatRoomParticipantsStartAsync (const SearchRequest& request, SearchAsyncData * asyncData) const;
+
 	/**
 	 * @brief getAddressIsEndAsync Check if all Async processes are done.
 	 * Test if getting addresses is over. It will cancel all providers that reach their timeout (this mecanism is an addition to the provider cancellation to make sure to stop all processes).
@@ -336,15 +405,6 @@ private:
 	 */
 	void beginNewSearchAsync (const SearchRequest& request, SearchAsyncData * asyncData) const;
 
-	/**
-	 * @brief addResultsToResultsList Same as addResultsToResultsList but apply an unicity filtering before splicing. It is usefull to prioritize results based to the order of providers.
-	 * @param results List of #SearchResult to add.
-	 * @param srL List of #SearchResult to modify.
-	 * @param filter word we search.
-	 * @param withDomain domain which we want to search only.
-	 */
-	void addResultsToResultsList (std::list<std::shared_ptr<SearchResult>> &results, std::list<std::shared_ptr<SearchResult>> &srL, const std::string filter, const std::string& withDomain) const;
-
 	int mState;
 	/**
 	 * @brief iterate Iteration that is executed in the main loop.
@@ -53,11 +53,12 @@ void SearchAsyncData::CbData::resultsCb( LinphoneContactSearch* id, bctbx_list_t
 	cbData->mEnd = TRUE;
 }
 
-SearchAsyncData::SearchAsyncData(){
+SearchAsyncData::SearchAsyncData() : mRequestCount(0){
 	ms_mutex_init(&mLockQueue, NULL);
 	mSearchResults = nullptr;
 }
 SearchAsyncData::~SearchAsyncData(){
+	clear();// Stop the providers while the request count still exists.
 	ms_mutex_destroy(&mLockQueue);
 }
 
@@ -81,6 +82,10 @@ const std::list<SearchRequest>& SearchAsyncData::getRequestHistory() const{
 	return mRequestHistory;
 }
 
+unsigned int SearchAsyncData::getRequestCount() const{
+	return mRequestCount;
+}
+
 bool SearchAsyncData::keepOneRequest(){
 	bool haveRequest;
 	ms_mutex_lock(&mLockQueue);
@@ -97,6 +102,7 @@ int SearchAsyncData::pushRequest(const SearchRequest& request){
 	ms_mutex_lock(&mLockQueue);
 	mRequests.push(request);
 	ms_mutex_unlock(&mLockQueue);
+	++mRequestCount;
 	return currentSize;
 }
 
@@ -20,6 +20,7 @@
 #ifndef _L_MAGIC_SEARCH_ASYNC_DATA_H_
 #define _L_MAGIC_SEARCH_ASYNC_DATA_H_
 
+#include <atomic>
 #include <string>
 #include <list>
 #include <queue>
@@ -135,6 +136,13 @@ public:
 	
 	const std::list<SearchRequest>& getRequestHistory() const;
 
+	/**
+	 * @brief getRequestCount Get the number of requests pushed so far: Thread-safe.
+	 * A search started when the count was lower has been superseded by a newer request.
+	 * @return The number of pushed requests.
+	 */
+	unsigned int getRequestCount() const;
+
 	/**
 	 * @brief keepOneRequest Remove all request in queue and keep only the last entered.
 	 * @return true the queue is empty.
@@ -204,6 +212,11 @@ private:
 	std::queue<SearchRequest > mRequests;	
 	std::list<SearchRequest > mRequestHistory;
 
+	/**
+	 * @brief mRequestCount Incremented on each pushed request, read by the searches running on worker threads.
+	 */
+	std::atomic<unsigned int> mRequestCount;
+
 	/**
 	 * @brief mLockQueue Protect the queue for read/write : we can add requests on any threads. All requests are removed from the main iteration.
 	 */
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "search-results-merger.h"
+
+#include "linphone/api/c-address.h"
+#include "linphone/utils/utils.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+void SearchResultsMerger::append (list<shared_ptr<SearchResult>> &results) {
+	size_t from = mResults.size();
+	mResults.insert(mResults.end(), results.begin(), results.end());
+	results.clear();
+	indexResults(from);
+}
+
+void SearchResultsMerger::merge (list<shared_ptr<SearchResult>> &results) {
+	size_t from = mResults.size();
+	for (auto &result : results) {
+		const LinphoneAddress *address = result->getAddress();
+		if (address) {
+			auto it = mAddressIndexes.find(getAddressKey(address));
+			if (it != mAddressIndexes.end()) {
+				mResults[it->second]->merge(result);
+				continue;
+			}
+		}
+		mResults.push_back(result);
+	}
+	results.clear();
+	indexResults(from);
+}
+
+bool SearchResultsMerger::contains (const LinphoneAddress *address) const {
+	return address && mAddressIndexes.find(getAddressKey(address)) != mAddressIndexes.end();
+}
+
+size_t SearchResultsMerger::size () const {
+	return mResults.size();
+}
+
+shared_ptr<list<shared_ptr<SearchResult>>> SearchResultsMerger::toList () const {
+	return make_shared<list<shared_ptr<SearchResult>>>(mResults.begin(), mResults.end());
+}
+
+string SearchResultsMerger::getAddressKey (const LinphoneAddress *address) {
+	const char *username = linphone_address_get_username(address);
+	const char *domain = linphone_address_get_domain(address);
+	string key = username ? username : "";
+	key += '\0';
+	key += domain ? domain : "";
+	key += '\0';
+	key += Utils::toString(linphone_address_get_port(address));
+	return key;
+}
+
+void SearchResultsMerger::indexResults (size_t from) {
+	for (size_t i = from; i < mResults.size(); ++i) {
+		const LinphoneAddress *address = mResults[i]->getAddress();
+		if (address)
+			mAddressIndexes.emplace(getAddressKey(address), i);
+	}
+}
+
+LINPHONE_END_NAMESPACE
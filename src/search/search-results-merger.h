@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_SEARCH_RESULTS_MERGER_H_
+#define _L_SEARCH_RESULTS_MERGER_H_
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "search-result.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+/**
+ * Aggregates the results of several search sources in a vector, indexed by a canonical key of their address.
+ * Two addresses have the same key when they are weakly equal (same username, domain and port).
+ */
+class SearchResultsMerger {
+public:
+	/**
+	 * @brief append Add results without merging them with the stored ones.
+	 * @param results List of #SearchResult to add, emptied.
+	 */
+	void append (std::list<std::shared_ptr<SearchResult>> &results);
+
+	/**
+	 * @brief merge Merge results into the first stored result having a weakly equal address and append the others.
+	 * Results of a same call are not merged together. It is usefull to prioritize results based to the order of providers.
+	 * @param results List of #SearchResult to add, emptied.
+	 */
+	void merge (std::list<std::shared_ptr<SearchResult>> &results);
+
+	/**
+	 * @return true if a stored result has an address weakly equal to the given one.
+	 */
+	bool contains (const LinphoneAddress *address) const;
+
+	/**
+	 * @return the number of stored results.
+	 */
+	size_t size () const;
+
+	/**
+	 * @return all the stored results, in insertion order.
+	 */
+	std::shared_ptr<std::list<std::shared_ptr<SearchResult>>> toList () const;
+
+	/**
+	 * @return the canonical key of an address, equal for weakly equal addresses.
+	 */
+	static std::string getAddressKey (const LinphoneAddress *address);
+
+private:
+	void indexResults (size_t from);
+
+	std::vector<std::shared_ptr<SearchResult>> mResults;
+	// Position in mResults of the first result of each address.
+	std::unordered_map<std::string, size_t> mAddressIndexes;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif //_L_SEARCH_RESULTS_MERGER_H_
@@ -31,6 +31,11 @@
 #include <iptypes.h>
 #include <iphlpapi.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#define IF_ADDRS_NETLINK_MONITOR
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
 
 #include "if-addrs.h"
 
@@ -250,6 +255,112 @@ list<string> IfAddrs::fetchLocalAddresses(){
 	return ret;
 }
 
+// -----------------------------------------------------------------------------
+
+IfAddrsCache::~IfAddrsCache(){
+	stopMonitoring();
+}
+
+void IfAddrsCache::startMonitoring(belle_sip_main_loop_t *mainLoop){
+	stopMonitoring();
+	invalidate();
+#ifdef IF_ADDRS_NETLINK_MONITOR
+	mNetlinkSocket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (mNetlinkSocket < 0){
+		lWarning() << "Cannot create netlink socket, the local addresses cache relies on the network reachability: " << strerror(errno);
+		mNetlinkSocket = -1;
+		return;
+	}
+	struct sockaddr_nl addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+	if (::bind(mNetlinkSocket, (struct sockaddr *)&addr, sizeof(addr)) < 0){
+		lWarning() << "Cannot bind netlink socket, the local addresses cache relies on the network reachability: " << strerror(errno);
+		close_socket(mNetlinkSocket);
+		mNetlinkSocket = -1;
+		return;
+	}
+	set_non_blocking_socket(mNetlinkSocket);
+
+	mMainLoop = (belle_sip_main_loop_t *)belle_sip_object_ref(mainLoop);
+	mNetlinkSource = belle_sip_socket_source_new(onNetlinkReadable, this, mNetlinkSocket, BELLE_SIP_EVENT_READ, (unsigned int)-1);
+	belle_sip_main_loop_add_source(mMainLoop, mNetlinkSource);
+	lInfo() << "Monitoring the network interfaces changes with netlink.";
+#endif
+}
+
+void IfAddrsCache::stopMonitoring(){
+	if (mNetlinkSource){
+		belle_sip_main_loop_remove_source(mMainLoop, mNetlinkSource);
+		belle_sip_object_unref(mNetlinkSource);
+		mNetlinkSource = nullptr;
+	}
+	if (mMainLoop){
+		belle_sip_object_unref(mMainLoop);
+		mMainLoop = nullptr;
+	}
+	if (mNetlinkSocket != -1){
+		close_socket(mNetlinkSocket);
+		mNetlinkSocket = -1;
+	}
+}
+
+const list<string> &IfAddrsCache::getLocalAddresses(){
+	if (!mLocalAddressesValid){
+		mLocalAddresses = IfAddrs::fetchLocalAddresses();
+		mLocalAddressesValid = true;
+		mFetchCount++;
+	}
+	return mLocalAddresses;
+}
+
+int IfAddrsCache::getDefaultLocalIp(int af, char *result){
+	DefaultLocalIp &localIp = mDefaultLocalIps[af == AF_INET6 ? 1 : 0];
+	if (!localIp.valid){
+		char addr[LINPHONE_IPADDR_SIZE] = { 0 };
+		localIp.status = linphone_core_get_local_ip_for(af, nullptr, addr);
+		localIp.address = addr;
+		localIp.valid = true;
+	}
+	strncpy(result, localIp.address.c_str(), LINPHONE_IPADDR_SIZE);
+	return localIp.status;
+}
+
+void IfAddrsCache::invalidate(){
+	mLocalAddressesValid = false;
+	for (auto &localIp : mDefaultLocalIps)
+		localIp.valid = false;
+}
+
+unsigned int IfAddrsCache::getFetchCount() const{
+	return mFetchCount;
+}
+
+int IfAddrsCache::onNetlinkReadable(void *data, unsigned int events){
+#ifdef IF_ADDRS_NETLINK_MONITOR
+	IfAddrsCache *cache = static_cast<IfAddrsCache *>(data);
+	// Any link, address or route change may change the local addresses, the content of the messages doesn't matter.
+	char buf[4096];
+	bool changed = false;
+	ssize_t len;
+	while ((len = recv(cache->mNetlinkSocket, buf, sizeof(buf), 0)) != 0){
+		if (len < 0){
+			// ENOBUFS: some messages were lost.
+			if (errno == ENOBUFS)
+				changed = true;
+			break;
+		}
+		changed = true;
+	}
+	if (changed){
+		lInfo() << "Network interfaces changed, the local addresses will be fetched again.";
+		cache->invalidate();
+	}
+#endif
+	return BELLE_SIP_CONTINUE;
+}
+
 LINPHONE_END_NAMESPACE
 
 bctbx_list_t *linphone_fetch_local_addresses(void){
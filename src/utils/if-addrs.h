@@ -23,6 +23,9 @@
 #include <list>
 #include <string>
 
+#include <belle-sip/belle-sip.h>
+#include <ortp/port.h>
+
 LINPHONE_BEGIN_NAMESPACE
 
 class IfAddrs{
@@ -33,6 +36,49 @@ private:
 	static std::list<std::string> fetchWithGetAdaptersAddresses();
 };
 
+/*
+ * Local addresses of a core, fetched again only after a change of the network interfaces.
+ * On Linux the changes are reported by a netlink socket. The cache is also invalidated
+ * when the network reachability or the default local address changes.
+ */
+class LINPHONE_PUBLIC IfAddrsCache{
+public:
+	IfAddrsCache() = default;
+	IfAddrsCache(const IfAddrsCache &other) = delete;
+	~IfAddrsCache();
+
+	void startMonitoring(belle_sip_main_loop_t *mainLoop);
+	void stopMonitoring();
+
+	// Same as IfAddrs::fetchLocalAddresses().
+	const std::list<std::string> &getLocalAddresses();
+	// Same as linphone_core_get_local_ip_for() without destination.
+	int getDefaultLocalIp(int af, char *result);
+
+	void invalidate();
+
+	// Number of times the local addresses have been fetched.
+	unsigned int getFetchCount() const;
+
+private:
+	struct DefaultLocalIp{
+		bool valid = false;
+		int status = -1;
+		std::string address;
+	};
+
+	static int onNetlinkReadable(void *data, unsigned int events);
+
+	std::list<std::string> mLocalAddresses;
+	bool mLocalAddressesValid = false;
+	DefaultLocalIp mDefaultLocalIps[2]; // IPv4 then IPv6.
+	unsigned int mFetchCount = 0;
+
+	belle_sip_main_loop_t *mMainLoop = nullptr;
+	ortp_socket_t mNetlinkSocket = -1;
+	belle_sip_source_t *mNetlinkSource = nullptr;
+};
+
 LINPHONE_END_NAMESPACE
 
 #endif
@@ -19,7 +19,10 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <atomic>
+#include <thread>
 #include "c-wrapper/c-wrapper.h"
+#include "core/core-p.h"
 #include "linphone/core.h"
 #include "linphone/lpconfig.h"
 #include "liblinphone_tester.h"
@@ -30,6 +33,7 @@
 #include "sal/sal_media_description.h"
 #include "sal/sal_stream_description.h"
 #include "shared_tester_functions.h"
+#include "utils/if-addrs.h"
 
 static void call_with_ice_in_ipv4_with_v6_enabled(void) {
 	LinphoneCoreManager* marie;
@@ -824,6 +828,184 @@ end:
 	linphone_core_manager_destroy(marie);
 }
 
+/*
+ * Local STUN server answering binding requests with the source address of the request.
+ * The requests received during the first dropTimeMs milliseconds are ignored, as by a lossy server.
+ */
+class StunStandIn {
+public:
+	StunStandIn (int dropTimeMs) : mDropTimeMs(dropTimeMs) {
+		mSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		struct sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t addrlen = sizeof(addr);
+		if (::bind(mSocket, (struct sockaddr *)&addr, addrlen) < 0 || getsockname(mSocket, (struct sockaddr *)&addr, &addrlen) < 0) {
+			ms_error("Cannot bind the STUN stand-in");
+			return;
+		}
+		mPort = ntohs(addr.sin_port);
+		set_non_blocking_socket(mSocket);
+		mRunning = true;
+		mThread = std::thread(&StunStandIn::run, this);
+	}
+
+	~StunStandIn () {
+		mRunning = false;
+		if (mThread.joinable())
+			mThread.join();
+		close_socket(mSocket);
+	}
+
+	int getPort () const {
+		return mPort;
+	}
+
+	int getRequestCount () const {
+		return mRequestCount;
+	}
+
+private:
+	void run () {
+		MSTimeSpec firstRequest;
+		bool gotRequest = false;
+		while (mRunning) {
+			char buf[MS_STUN_MAX_MESSAGE_SIZE];
+			struct sockaddr_storage from;
+			socklen_t fromlen = sizeof(from);
+			int len = (int)recvfrom(mSocket, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fromlen);
+			if (len <= 0) {
+				ms_usleep(5000);
+				continue;
+			}
+			MSStunMessage *request = ms_stun_message_create_from_buffer_parsing((uint8_t *)buf, (ssize_t)len);
+			if (!request)
+				continue;
+			mRequestCount++;
+			if (!gotRequest) {
+				liblinphone_tester_clock_start(&firstRequest);
+				gotRequest = true;
+			}
+			if (liblinphone_tester_clock_elapsed(&firstRequest, mDropTimeMs)) {
+				MSStunMessage *response = ms_stun_binding_success_response_create();
+				ms_stun_message_set_tr_id(response, ms_stun_message_get_tr_id(request));
+				MSStunAddress address;
+				ms_sockaddr_to_stun_address((struct sockaddr *)&from, &address);
+				ms_stun_message_set_xor_mapped_address(response, address);
+				char *out = nullptr;
+				size_t outlen = ms_stun_message_encode(response, &out);
+				if (outlen > 0)
+					bctbx_sendto(mSocket, out, outlen, 0, (struct sockaddr *)&from, fromlen);
+				if (out)
+					ms_free(out);
+				ms_stun_message_destroy(response);
+			}
+			ms_stun_message_destroy(request);
+		}
+	}
+
+	int mDropTimeMs;
+	ortp_socket_t mSocket = -1;
+	int mPort = 0;
+	std::atomic<int> mRequestCount{0};
+	std::atomic<bool> mRunning{false};
+	std::thread mThread;
+};
+
+/*
+ * Two outgoing calls doing the basic STUN discovery against a slow STUN server:
+ * the INVITEs are deferred until the end of the tests, but the core is not blocked meanwhile.
+ */
+static void calls_with_stun_discovery(void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LinphoneCoreManager *laure = linphone_core_manager_new("laure_rc_udp");
+	bctbx_list_t *lcs = NULL;
+	lcs = bctbx_list_append(lcs, marie->lc);
+	lcs = bctbx_list_append(lcs, pauline->lc);
+	lcs = bctbx_list_append(lcs, laure->lc);
+
+	StunStandIn stunServer(500);
+	BC_ASSERT_NOT_EQUAL(stunServer.getPort(), 0, int, "%d");
+
+	// The basic STUN discovery is IPv4 only, and each call needs its own RTP ports.
+	linphone_core_enable_ipv6(marie->lc, FALSE);
+	linphone_core_set_audio_port(marie->lc, -1);
+	linphone_core_set_video_port(marie->lc, -1);
+	linphone_core_set_text_port(marie->lc, -1);
+
+	LinphoneNatPolicy *natPolicy = linphone_core_create_nat_policy(marie->lc);
+	char stunServerAddress[64];
+	snprintf(stunServerAddress, sizeof(stunServerAddress), "127.0.0.1:%d", stunServer.getPort());
+	linphone_nat_policy_set_stun_server(natPolicy, stunServerAddress);
+	linphone_nat_policy_enable_stun(natPolicy, TRUE);
+	linphone_core_set_nat_policy(marie->lc, natPolicy);
+	linphone_nat_policy_unref(natPolicy);
+	BC_ASSERT_TRUE(wait_for_stun_resolution(marie));
+
+	MSTimeSpec start;
+	liblinphone_tester_clock_start(&start);
+	LinphoneCall *paulineCall = linphone_core_invite_address(marie->lc, pauline->identity);
+	LinphoneCall *laureCall = linphone_core_invite_address(marie->lc, laure->identity);
+	BC_ASSERT_PTR_NOT_NULL(paulineCall);
+	BC_ASSERT_PTR_NOT_NULL(laureCall);
+	// The STUN server doesn't answer yet.
+	BC_ASSERT_FALSE(liblinphone_tester_clock_elapsed(&start, 400));
+	BC_ASSERT_EQUAL(pauline->stat.number_of_LinphoneCallIncomingReceived, 0, int, "%d");
+
+	// The calls don't wait for one another.
+	BC_ASSERT_TRUE(wait_for_list(lcs, &pauline->stat.number_of_LinphoneCallIncomingReceived, 1, 5000));
+	BC_ASSERT_TRUE(wait_for_list(lcs, &laure->stat.number_of_LinphoneCallIncomingReceived, 1, 5000));
+	BC_ASSERT_FALSE(liblinphone_tester_clock_elapsed(&start, 2000));
+	// The requests were retransmitted until the server answered.
+	BC_ASSERT_GREATER(stunServer.getRequestCount(), 4, int, "%d");
+
+	linphone_core_terminate_all_calls(marie->lc);
+	BC_ASSERT_TRUE(wait_for_list(lcs, &pauline->stat.number_of_LinphoneCallReleased, 1, 5000));
+	BC_ASSERT_TRUE(wait_for_list(lcs, &laure->stat.number_of_LinphoneCallReleased, 1, 5000));
+	BC_ASSERT_TRUE(wait_for_list(lcs, &marie->stat.number_of_LinphoneCallReleased, 2, 5000));
+
+	bctbx_list_free(lcs);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	linphone_core_manager_destroy(laure);
+}
+
+static void local_addresses_cache(void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LinphonePrivate::IfAddrsCache &cache = L_GET_PRIVATE_FROM_C_OBJECT(marie->lc)->getIfAddrsCache();
+
+	// The local addresses are fetched once, until the network changes.
+	cache.invalidate();
+	unsigned int fetchCount = cache.getFetchCount();
+	std::list<std::string> addresses = cache.getLocalAddresses();
+	BC_ASSERT_TRUE(addresses == LinphonePrivate::IfAddrs::fetchLocalAddresses());
+	cache.getLocalAddresses();
+	BC_ASSERT_EQUAL(cache.getFetchCount(), fetchCount + 1, unsigned int, "%u");
+
+	char localIp[LINPHONE_IPADDR_SIZE] = { 0 };
+	char cachedLocalIp[LINPHONE_IPADDR_SIZE] = { 0 };
+	linphone_core_get_local_ip_for(AF_INET, NULL, localIp);
+	linphone_core_get_local_ip(marie->lc, AF_INET, NULL, cachedLocalIp);
+	BC_ASSERT_STRING_EQUAL(cachedLocalIp, localIp);
+
+	linphone_core_set_network_reachable(marie->lc, FALSE);
+	linphone_core_set_network_reachable(marie->lc, TRUE);
+	cache.getLocalAddresses();
+	BC_ASSERT_EQUAL(cache.getFetchCount(), fetchCount + 2, unsigned int, "%u");
+
+	// The calls with ICE gather their candidates from the cached addresses.
+	fetchCount = cache.getFetchCount();
+	_call_with_ice_base(pauline, marie, TRUE, TRUE, TRUE, FALSE, FALSE);
+	_call_with_ice_base(pauline, marie, TRUE, TRUE, TRUE, FALSE, FALSE);
+	BC_ASSERT_EQUAL(cache.getFetchCount(), fetchCount, unsigned int, "%u");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
 static test_t call_with_ice_tests[] = {
 	TEST_ONE_TAG("Call with ICE in IPv4 with IPv6 enabled", call_with_ice_in_ipv4_with_v6_enabled, "ICE"),
 	TEST_ONE_TAG("Call with ICE IPv4 to IPv6", call_with_ice_ipv4_to_ipv6, "ICE"),
@@ -868,7 +1050,9 @@ static test_t call_with_ice_tests[] = {
 	TEST_TWO_TAGS("DTLS SRTP Call with ICE pause and resume with both ice and rtcp mux", dtls_srtp_call_paused_resumed_with_both_ice_and_rtcp_mux, "ICE", "DTLS"),
 	TEST_ONE_TAG("Call terminated during ICE re-INVITE", call_terminated_during_ice_reinvite, "ICE"),
 	TEST_ONE_TAG("Call with ICE using dual-stack stun server", call_with_ice_and_dual_stack_stun_server, "ICE"),
-	TEST_ONE_TAG("SRTP ice call to no encryption", srtp_ice_call_to_no_encryption, "ICE")
+	TEST_ONE_TAG("SRTP ice call to no encryption", srtp_ice_call_to_no_encryption, "ICE"),
+	TEST_NO_TAG("Calls with STUN discovery", calls_with_stun_discovery),
+	TEST_ONE_TAG("Local addresses cache", local_addresses_cache, "ICE")
 };
 
 test_suite_t call_with_ice_test_suite = {"Call with ICE", NULL, NULL, liblinphone_tester_before_each, liblinphone_tester_after_each,
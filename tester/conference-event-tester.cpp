@@ -26,6 +26,7 @@
 #include "call/call.h"
 #include "conference_private.h"
 #include "conference/conference-listener.h"
+#include "conference/handlers/conference-notify-payload.h"
 #include "conference/handlers/local-conference-event-handler.h"
 #include "conference/handlers/remote-conference-event-handler.h"
 #include "conference/local-conference.h"
@@ -2042,6 +2043,52 @@ void one_to_one_keyword () {
 	linphone_core_manager_destroy(pauline);
 }
 
+void shared_notify_payload () {
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	char *identityStr = linphone_address_as_string(pauline->identity);
+	Address addr(identityStr);
+	bctbx_free(identityStr);
+	shared_ptr<LocalConference> localConf = make_shared<LocalConference>(pauline->lc->cppPtr, addr, nullptr, ConferenceParams::create(pauline->lc));
+	LinphoneAddress *cBobAddr = linphone_core_interpret_url(pauline->lc, bobUri);
+	char *bobAddrStr = linphone_address_as_string(cBobAddr);
+	Address bobAddr(bobAddrStr);
+	bctbx_free(bobAddrStr);
+	linphone_address_unref(cBobAddr);
+
+	localConf->addParticipant(bobAddr);
+	LocalConferenceEventHandler *localHandler = (L_ATTR_GET(localConf.get(), eventHandler)).get();
+	localConf->setConferenceAddress(ConferenceAddress(addr));
+	string notify = localHandler->createNotifyFullState(NULL);
+
+	ConferenceNotifyPayload plainPayload(notify, false);
+	BC_ASSERT_TRUE(plainPayload.getContentType() == ContentType::ConferenceInfo);
+	BC_ASSERT_TRUE(plainPayload.getContentEncoding().empty());
+	BC_ASSERT_EQUAL(plainPayload.getEncodedSize(), notify.size(), size_t, "%zu");
+
+	ConferenceNotifyPayload payload(notify, true);
+	BC_ASSERT_EQUAL(payload.getBodySize(), notify.size(), size_t, "%zu");
+	if (!payload.getContentEncoding().empty()) {
+		BC_ASSERT_STRING_EQUAL(payload.getContentEncoding().c_str(), "deflate");
+		BC_ASSERT_LOWER(payload.getEncodedSize(), payload.getBodySize(), size_t, "%zu");
+	}
+
+	// Each handler reads the same encoded bytes, no encoding is left to do when sending.
+	SalBodyHandler *bodyHandler = payload.createBodyHandler();
+	BC_ASSERT_EQUAL(sal_body_handler_get_size(bodyHandler), payload.getEncodedSize(), size_t, "%zu");
+	BC_ASSERT_STRING_EQUAL(sal_body_handler_get_type(bodyHandler), "application");
+	BC_ASSERT_STRING_EQUAL(sal_body_handler_get_subtype(bodyHandler), "conference-info+xml");
+	sal_body_handler_unref(bodyHandler);
+
+	// One encoding per event, whatever the number of devices.
+	localHandler->notifyAll(notify);
+	localHandler->notifyAll(notify);
+	BC_ASSERT_EQUAL(localHandler->getNotifyStats().encodedBodies, 2, unsigned int, "%u");
+	BC_ASSERT_EQUAL(localHandler->getNotifyStats().bodyBytes, 2 * notify.size(), size_t, "%zu");
+
+	localConf = nullptr;
+	linphone_core_manager_destroy(pauline);
+}
+
 test_t conference_event_tests[] = {
 	TEST_NO_TAG("First notify parsing", first_notify_parsing),
 	TEST_NO_TAG("First notify with extensions parsing", first_notify_with_extensions_parsing),
@@ -2061,7 +2108,8 @@ test_t conference_event_tests[] = {
 	TEST_NO_TAG("Send subject changed notify", send_subject_changed_notify),
 	TEST_NO_TAG("Send device added notify", send_device_added_notify),
 	TEST_NO_TAG("Send device removed notify", send_device_removed_notify),
-	TEST_NO_TAG("one-to-one keyword", one_to_one_keyword)
+	TEST_NO_TAG("one-to-one keyword", one_to_one_keyword),
+	TEST_NO_TAG("Shared notify payload", shared_notify_payload)
 };
 
 test_suite_t conference_event_test_suite = {
@@ -556,11 +556,54 @@ static void content_header_parsing(void) {
 	BC_ASSERT_TRUE(header.getValueWithParams() == value);
 }
 
+static void content_body_sharing(void) {
+	vector<char> buffer(1024, 'x');
+	const char *data = buffer.data();
+
+#ifdef DEBUG
+	unsigned long copyCount = Content::getBodyCopyCount();
+#endif
+
+	// The body is adopted, then shared by the copies of the content.
+	Content content;
+	content.setContentType(ContentType::PlainText);
+	content.setBody(move(buffer));
+	BC_ASSERT_PTR_EQUAL(content.getBodyData(), data);
+	Content copy(content);
+	BC_ASSERT_PTR_EQUAL(copy.getBodyData(), data);
+	Content other;
+	other.setBody(copy.getSharedBody());
+	BC_ASSERT_PTR_EQUAL(other.getBodyData(), data);
+	BC_ASSERT_TRUE(other.getBody() == content.getBody());
+	BC_ASSERT_TRUE(copy == content);
+
+#ifdef DEBUG
+	BC_ASSERT_EQUAL((int)(Content::getBodyCopyCount() - copyCount), 0, int, "%d");
+#endif
+
+	// Setting another body doesn't change the copies.
+	copy.setBodyFromUtf8("modified");
+	BC_ASSERT_STRING_EQUAL(copy.getBodyAsUtf8String().c_str(), "modified");
+	BC_ASSERT_PTR_EQUAL(content.getBodyData(), data);
+	BC_ASSERT_EQUAL((int)content.getSize(), 1024, int, "%d");
+	BC_ASSERT_FALSE(copy == content);
+
+#ifdef DEBUG
+	BC_ASSERT_EQUAL((int)(Content::getBodyCopyCount() - copyCount), 2, int, "%d");
+#endif
+
+	copy.setBody(nullptr, 0);
+	BC_ASSERT_TRUE(copy.isEmpty());
+	BC_ASSERT_PTR_NULL(copy.getBodyData());
+	BC_ASSERT_EQUAL((int)copy.getBody().size(), 0, int, "%d");
+}
+
 test_t contents_tests[] = {
 	TEST_NO_TAG("Multipart to list", multipart_to_list),
 	TEST_NO_TAG("List to multipart", list_to_multipart),
 	TEST_NO_TAG("Content type parsing", content_type_parsing),
-	TEST_NO_TAG("Content header parsing", content_header_parsing)
+	TEST_NO_TAG("Content header parsing", content_header_parsing),
+	TEST_NO_TAG("Content body sharing", content_body_sharing)
 };
 
 test_suite_t contents_test_suite = {
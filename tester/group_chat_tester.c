@@ -4601,6 +4601,132 @@ static void aggregated_imdn_for_group_chat_room_read_while_offline (void) {
 	aggregated_imdn_for_group_chat_room_base(TRUE);
 }
 
+static void imdn_states_batch_participant_state_changed (LinphoneChatRoom *cr, LinphoneChatMessage *msg, const LinphoneParticipantImdnState *state) {
+	LinphoneChatRoomCbs *cbs = linphone_chat_room_get_current_callbacks(cr);
+	LinphoneCoreManager *chloe = (LinphoneCoreManager *)linphone_chat_room_cbs_get_user_data(cbs);
+	chloe->stat.number_of_participant_state_changed += 1;
+	// Keep the texts of the displayed messages in the order of their notification
+	if (linphone_participant_imdn_state_get_state(state) == LinphoneChatMessageStateDisplayed)
+		chloe->user_info = bctbx_list_append((bctbx_list_t *)chloe->user_info, bctbx_strdup(linphone_chat_message_get_text(msg)));
+}
+
+static void imdn_states_batch_base (bool_t batch) {
+	LinphoneCoreManager *marie = linphone_core_manager_create("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_create("pauline_rc");
+	LinphoneCoreManager *chloe = linphone_core_manager_create("chloe_rc");
+	LinphoneChatRoom *marieCr = NULL, *paulineCr = NULL, *chloeCr = NULL;
+	const LinphoneAddress *confAddr = NULL;
+	bctbx_list_t *coresManagerList = NULL;
+	bctbx_list_t *participantsAddresses = NULL;
+	LinphoneChatMessage *chloeMessages[3] = { NULL };
+	const char *chloeTextMessages[3] = { "Hello", "Long time no talk", "How are you?" };
+	LinphoneCoreImdnStateQueueStats queueStats;
+	coresManagerList = bctbx_list_append(coresManagerList, marie);
+	coresManagerList = bctbx_list_append(coresManagerList, pauline);
+	coresManagerList = bctbx_list_append(coresManagerList, chloe);
+	bctbx_list_t *coresList = init_core_for_conference(coresManagerList);
+	linphone_config_set_bool(linphone_core_get_config(chloe->lc), "misc", "batch_imdn_processing", batch);
+	start_core_for_conference(coresManagerList);
+	participantsAddresses = bctbx_list_append(participantsAddresses, linphone_address_new(linphone_core_get_identity(pauline->lc)));
+	participantsAddresses = bctbx_list_append(participantsAddresses, linphone_address_new(linphone_core_get_identity(chloe->lc)));
+	stats initialMarieStats = marie->stat;
+	stats initialPaulineStats = pauline->stat;
+	stats initialChloeStats = chloe->stat;
+
+	// Enable IMDN
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(marie->lc));
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(pauline->lc));
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(chloe->lc));
+
+	// Marie creates a new group chat room
+	const char *initialSubject = "Colleagues";
+	marieCr = create_chat_room_client_side(coresList, marie, &initialMarieStats, participantsAddresses, initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+	if (!BC_ASSERT_PTR_NOT_NULL(marieCr)) goto end;
+	confAddr = linphone_chat_room_get_conference_address(marieCr);
+	if (!BC_ASSERT_PTR_NOT_NULL(confAddr)) goto end;
+
+	// Check that the chat room is correctly created on Pauline's and Chloe's sides
+	paulineCr = check_creation_chat_room_client_side(coresList, pauline, &initialPaulineStats, confAddr, initialSubject, 2, FALSE);
+	if (!BC_ASSERT_PTR_NOT_NULL(paulineCr)) goto end;
+	chloeCr = check_creation_chat_room_client_side(coresList, chloe, &initialChloeStats, confAddr, initialSubject, 2, FALSE);
+	if (!BC_ASSERT_PTR_NOT_NULL(chloeCr)) goto end;
+
+	LinphoneChatRoomCbs *cbs = linphone_factory_create_chat_room_cbs(linphone_factory_get());
+	linphone_chat_room_cbs_set_chat_message_participant_imdn_state_changed(cbs, imdn_states_batch_participant_state_changed);
+	linphone_chat_room_cbs_set_user_data(cbs, chloe);
+	linphone_chat_room_add_callbacks(chloeCr, cbs);
+	linphone_chat_room_cbs_unref(cbs);
+
+	// Chloe sends several messages, they are delivered to Marie and Pauline
+	for (int i = 0; i < 3; i++)
+		chloeMessages[i] = _send_message(chloeCr, chloeTextMessages[i]);
+	BC_ASSERT_TRUE(wait_for_list(coresList, &marie->stat.number_of_LinphoneMessageReceived, initialMarieStats.number_of_LinphoneMessageReceived + 3, 5000));
+	BC_ASSERT_TRUE(wait_for_list(coresList, &pauline->stat.number_of_LinphoneMessageReceived, initialPaulineStats.number_of_LinphoneMessageReceived + 3, 5000));
+	BC_ASSERT_TRUE(wait_for_list(coresList, &chloe->stat.number_of_LinphoneMessageDeliveredToUser, initialChloeStats.number_of_LinphoneMessageDeliveredToUser + 3, 5000));
+
+	// Marie reads the messages: her aggregated IMDN brings a burst of states to Chloe
+	int participantStateChanges = chloe->stat.number_of_participant_state_changed;
+	linphone_chat_room_mark_as_read(marieCr);
+	BC_ASSERT_TRUE(wait_for_list(coresList, &chloe->stat.number_of_participant_state_changed, participantStateChanges + 3, 5000));
+
+	// The participant states are notified in their reception order, whether they are batched or not
+	const bctbx_list_t *displayedTexts = (const bctbx_list_t *)chloe->user_info;
+	BC_ASSERT_EQUAL((int)bctbx_list_size(displayedTexts), 3, int, "%d");
+	int index = 0;
+	for (const bctbx_list_t *item = displayedTexts; item && index < 3; item = bctbx_list_next(item), index++)
+		BC_ASSERT_STRING_EQUAL((const char *)bctbx_list_get_data(item), chloeTextMessages[index]);
+	BC_ASSERT_EQUAL(chloe->stat.number_of_LinphoneMessageDisplayed, initialChloeStats.number_of_LinphoneMessageDisplayed, int, "%d");
+
+	// Pauline also reads the messages, they are now displayed on Chloe's side
+	linphone_chat_room_mark_as_read(paulineCr);
+	BC_ASSERT_TRUE(wait_for_list(coresList, &chloe->stat.number_of_LinphoneMessageDisplayed, initialChloeStats.number_of_LinphoneMessageDisplayed + 3, 5000));
+	BC_ASSERT_EQUAL((int)bctbx_list_size((const bctbx_list_t *)chloe->user_info), 6, int, "%d");
+	for (int i = 0; i < 3; i++) {
+		BC_ASSERT_EQUAL(linphone_chat_message_get_state(chloeMessages[i]), LinphoneChatMessageStateDisplayed, int, "%d");
+		bctbx_list_t *participantsThatDisplayedChloeMessage = linphone_chat_message_get_participants_by_imdn_state(chloeMessages[i], LinphoneChatMessageStateDisplayed);
+		BC_ASSERT_EQUAL((int)bctbx_list_size(participantsThatDisplayedChloeMessage), 2, int, "%d");
+		bctbx_list_free_with_data(participantsThatDisplayedChloeMessage, (bctbx_list_free_func)linphone_participant_imdn_state_unref);
+	}
+
+	// Each burst is stored in one transaction when batching is enabled, state by state otherwise
+	linphone_core_get_imdn_state_queue_stats(chloe->lc, &queueStats);
+	BC_ASSERT_GREATER(queueStats.number_of_received_states, 12, int, "%d"); // Delivered and displayed states of Marie and Pauline
+	if (batch) {
+		BC_ASSERT_GREATER(queueStats.largest_batch, 3, int, "%d");
+		BC_ASSERT_LOWER(queueStats.number_of_batches, queueStats.number_of_received_states / 3, int, "%d");
+		BC_ASSERT_EQUAL(queueStats.number_of_applied_states, queueStats.number_of_received_states, int, "%d");
+	} else {
+		BC_ASSERT_EQUAL(queueStats.largest_batch, 0, int, "%d");
+		BC_ASSERT_EQUAL(queueStats.number_of_batches, queueStats.number_of_received_states, int, "%d");
+	}
+
+end:
+	for (int i = 0; i < 3; i++) {
+		if (chloeMessages[i]) linphone_chat_message_unref(chloeMessages[i]);
+	}
+	bctbx_list_free_with_data((bctbx_list_t *)chloe->user_info, (bctbx_list_free_func)bctbx_free);
+	chloe->user_info = NULL;
+
+	// Clean db from chat room
+	if (marieCr) linphone_core_manager_delete_chat_room(marie, marieCr, coresList);
+	if (chloeCr) linphone_core_manager_delete_chat_room(chloe, chloeCr, coresList);
+	if (paulineCr) linphone_core_manager_delete_chat_room(pauline, paulineCr, coresList);
+
+	bctbx_list_free(coresList);
+	bctbx_list_free(coresManagerList);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	linphone_core_manager_destroy(chloe);
+}
+
+static void imdn_states_stored_in_batch (void) {
+	imdn_states_batch_base(TRUE);
+}
+
+static void imdn_states_stored_one_by_one (void) {
+	imdn_states_batch_base(FALSE);
+}
+
 static void imdn_sent_from_db_state (void) {
 	LinphoneCoreManager *marie = linphone_core_manager_create("marie_rc");
 	LinphoneCoreManager *pauline = linphone_core_manager_create("pauline_rc");
@@ -7416,6 +7542,8 @@ test_t group_chat2_tests[] = {
 	TEST_NO_TAG("IMDN for group chat room", imdn_for_group_chat_room),
 	TEST_NO_TAG("Aggregated IMDN for group chat room", aggregated_imdn_for_group_chat_room),
 	TEST_NO_TAG("Aggregated IMDN for group chat room read while offline", aggregated_imdn_for_group_chat_room_read_while_offline),
+	TEST_NO_TAG("IMDN states stored in batch", imdn_states_stored_in_batch),
+	TEST_NO_TAG("IMDN states stored one by one", imdn_states_stored_one_by_one),
 	TEST_ONE_TAG("IMDN sent from DB state", imdn_sent_from_db_state, "LeaksMemory"),
 	TEST_NO_TAG("IMDN updated for group chat room with one participant offline", imdn_updated_for_group_chat_room_with_one_participant_offline),
 	TEST_NO_TAG("Find one-to-one chat room", find_one_to_one_chat_room),
@@ -496,6 +496,7 @@ void linphone_core_manager_setup_dns(LinphoneCoreManager *mgr);
 void linphone_core_manager_uninit(LinphoneCoreManager *mgr);
 void linphone_core_manager_uninit2(LinphoneCoreManager *mgr, bool_t unlinkDb);
 void linphone_core_manager_wait_for_stun_resolution(LinphoneCoreManager *mgr);
+bool_t wait_for_stun_resolution(LinphoneCoreManager *m);
 void linphone_core_manager_destroy(LinphoneCoreManager* mgr);
 void linphone_core_manager_destroy_after_stop_async(LinphoneCoreManager* mgr);
 void linphone_core_manager_delete_chat_room (LinphoneCoreManager *mgr, LinphoneChatRoom *cr, bctbx_list_t *coresList);
@@ -17,8 +17,17 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 #include "address/address.h"
+#include "chat/chat-message/chat-message-p.h"
+#include "chat/chat-room/client-group-chat-room-p.h"
+#include "conference/participant-device.h"
+#include "conference/participant.h"
 #include "core/core-p.h"
+#include "db/main-db-p.h"
 #include "db/main-db.h"
 #include "event-log/events.h"
 
@@ -40,12 +49,15 @@ class MainDbProvider {
 public:
 	MainDbProvider () : MainDbProvider("db/linphone.db") { }
 
-	MainDbProvider (const char *db_file) {
+	MainDbProvider (const char *db_file, const char *journalMode = nullptr) {
 		mCoreManager = linphone_core_manager_create("empty_rc");
 		char *roDbPath = bc_tester_res(db_file);
 		char *rwDbPath = bc_tester_file("linphone.db");
 		BC_ASSERT_FALSE(liblinphone_tester_copy_file(roDbPath, rwDbPath));
 		linphone_config_set_string(linphone_core_get_config(mCoreManager->lc), "storage", "uri", rwDbPath);
+		if (journalMode)
+			linphone_config_set_string(linphone_core_get_config(mCoreManager->lc), "storage", "journal_mode", journalMode);
+		mDbPath = rwDbPath;
 		bc_free(roDbPath);
 		bc_free(rwDbPath);
 		linphone_core_manager_start(mCoreManager, false);
@@ -59,8 +71,17 @@ public:
 		return *L_GET_PRIVATE(mCoreManager->lc->cppPtr)->mainDb;
 	}
 
+	Core &getCore () {
+		return *mCoreManager->lc->cppPtr;
+	}
+
+	const string &getDbPath () const {
+		return mDbPath;
+	}
+
 private:
 	LinphoneCoreManager *mCoreManager;
+	string mDbPath;
 };
 
 // -----------------------------------------------------------------------------
@@ -140,6 +161,95 @@ static void get_history (void) {
 	);
 }
 
+static void get_history_before (void) {
+	MainDbProvider provider;
+	const MainDb &mainDb = provider.getMainDb();
+	const ConferenceId conferenceId(IdentityAddress("sip:test-1@sip.linphone.org"), IdentityAddress("sip:test-1@sip.linphone.org"));
+
+	// Walk the whole history page by page, as a UI does while scrolling.
+	const int pageSize = 100;
+	int nbEvents = 0;
+	shared_ptr<EventLog> lastEventLog;
+	for (;;) {
+		list<shared_ptr<EventLog>> page = mainDb.getHistoryBefore(conferenceId, lastEventLog, pageSize, MainDb::Filter::ConferenceChatMessageFilter);
+		list<shared_ptr<EventLog>> range = mainDb.getHistoryRange(conferenceId, nbEvents, nbEvents + pageSize, MainDb::Filter::ConferenceChatMessageFilter);
+		BC_ASSERT_EQUAL((int)page.size(), (int)range.size(), int, "%d");
+		if (page.empty() || page.size() != range.size())
+			break;
+		BC_ASSERT_TRUE(page.front()->getCreationTime() == range.front()->getCreationTime());
+		BC_ASSERT_TRUE(page.back()->getCreationTime() == range.back()->getCreationTime());
+		nbEvents += (int)page.size();
+		lastEventLog = page.front();
+	}
+	BC_ASSERT_EQUAL(nbEvents, 804, int, "%d");
+
+	BC_ASSERT_EQUAL((int)
+		mainDb.getHistoryBefore(conferenceId, nullptr, 0, MainDb::Filter::ConferenceChatMessageFilter).size(),
+		804,
+		int,
+		"%d"
+	);
+}
+
+static void cached_history_statements (void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	DbSession &dbSession = L_GET_PRIVATE(&mainDb)->dbSession;
+	const ConferenceId conferenceId(IdentityAddress("sip:test-1@sip.linphone.org"), IdentityAddress("sip:test-1@sip.linphone.org"));
+
+	const DbSession::CachedStatementsStats initialStats = dbSession.getCachedStatementsStats();
+	const int nbPages = 20;
+	for (int i = 0; i < nbPages; i++) {
+		BC_ASSERT_EQUAL((int)
+			mainDb.getHistoryRange(conferenceId, i * 10, i * 10 + 10, MainDb::Filter::ConferenceChatMessageFilter).size(),
+			10,
+			int,
+			"%d"
+		);
+		BC_ASSERT_EQUAL(mainDb.getHistorySize(conferenceId, MainDb::Filter::ConferenceChatMessageFilter), 804, int, "%d");
+	}
+
+	// Each query is prepared once whatever the requested range.
+	const DbSession::CachedStatementsStats stats = dbSession.getCachedStatementsStats();
+	BC_ASSERT_EQUAL((int)(stats.executionCount - initialStats.executionCount), 2 * nbPages, int, "%d");
+	BC_ASSERT_LOWER((int)(stats.prepareCount - initialStats.prepareCount), 2, int, "%d");
+	ms_message("Cached statements: %d prepared for %d executions",
+		(int)stats.prepareCount, (int)stats.executionCount);
+}
+
+static void load_history_page_contents (void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	const ConferenceId conferenceId(IdentityAddress("sip:test-1@sip.linphone.org"), IdentityAddress("sip:test-1@sip.linphone.org"));
+	const int pageSize = 50;
+
+	// The contents of a page are loaded with the page.
+	list<string> pageBodies;
+	{
+		list<shared_ptr<EventLog>> page = mainDb.getHistoryRange(conferenceId, 0, pageSize, MainDb::Filter::ConferenceChatMessageFilter);
+		BC_ASSERT_EQUAL((int)page.size(), pageSize, int, "%d");
+		for (const auto &event : page) {
+			shared_ptr<ChatMessage> chatMessage = static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage();
+			BC_ASSERT_TRUE(L_GET_PRIVATE(chatMessage)->areContentsLoaded());
+			for (const auto &content : chatMessage->getContents())
+				pageBodies.push_back(content->getContentType().getMediaType() + content->getBodyAsUtf8String());
+		}
+	}
+	BC_ASSERT_FALSE(pageBodies.empty());
+
+	// The same contents are loaded one message at a time when they are not prefetched.
+	list<string> bodies;
+	list<shared_ptr<EventLog>> history = mainDb.getHistoryRange(conferenceId, 0, -1, MainDb::Filter::ConferenceChatMessageFilter);
+	history.erase(history.begin(), next(history.begin(), (long)history.size() - pageSize));
+	for (const auto &event : history) {
+		shared_ptr<ChatMessage> chatMessage = static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage();
+		BC_ASSERT_FALSE(L_GET_PRIVATE(chatMessage)->areContentsLoaded());
+		for (const auto &content : chatMessage->getContents())
+			bodies.push_back(content->getContentType().getMediaType() + content->getBodyAsUtf8String());
+	}
+	BC_ASSERT_TRUE(bodies == pageBodies);
+}
+
 static void get_conference_notified_events (void) {
 	MainDbProvider provider;
 	const MainDb &mainDb = provider.getMainDb();
@@ -269,6 +379,72 @@ static void get_chat_rooms() {
 		}
 	}
 }
+static void participant_state_counts_in_large_group (void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	list<shared_ptr<EventLog>> events = mainDb.getHistoryRange(
+		ConferenceId(IdentityAddress("sip:test-4@sip.linphone.org"), IdentityAddress("sip:test-1@sip.linphone.org")),
+		0, 1, MainDb::Filter::ConferenceChatMessageFilter
+	);
+	if (!BC_ASSERT_EQUAL((int)events.size(), 1, int, "%d"))
+		return;
+	shared_ptr<EventLog> eventLog = events.front();
+	const long long eventId = static_pointer_cast<ConferenceChatMessageEvent>(eventLog)->getChatMessage()->getStorageId();
+	const MainDb::ParticipantStateCounts initialCounts = mainDb.getChatMessageParticipantStateCounts(eventLog);
+
+	// Simulate a large group: add recipients to the message, as done when it is sent.
+	const int nbParticipants = 500;
+	list<IdentityAddress> participants;
+	{
+		soci::session *session = L_GET_PRIVATE(&mainDb)->dbSession.getBackendSession();
+		soci::transaction tr(*session);
+		const int delivered = int(ChatMessage::State::Delivered);
+		for (int i = 0; i < nbParticipants; i++) {
+			participants.emplace_back("sip:large-group-" + Utils::toString(i) + "@sip.linphone.org");
+			const string address = participants.back().asString();
+			*session << "INSERT INTO sip_address (value) VALUES (:address)", soci::use(address);
+			const long long sipAddressId = L_GET_PRIVATE(&mainDb)->dbSession.getLastInsertId();
+			*session << "INSERT INTO chat_message_participant (event_id, participant_sip_address_id, state)"
+				" VALUES (:eventId, :sipAddressId, :state)", soci::use(eventId), soci::use(sipAddressId), soci::use(delivered);
+		}
+		*session << "UPDATE conference_chat_message_event SET participant_count = participant_count + :count WHERE event_id = :eventId",
+			soci::use(nbParticipants), soci::use(eventId);
+		tr.commit();
+	}
+
+	// Each recipient sends a delivery then a display notification.
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for (const auto &participant : participants)
+		mainDb.setChatMessageParticipantState(eventLog, participant, ChatMessage::State::DeliveredToUser, time(nullptr));
+	MainDb::ParticipantStateCounts counts = mainDb.getChatMessageParticipantStateCounts(eventLog);
+	BC_ASSERT_EQUAL(counts.total, initialCounts.total + nbParticipants, int, "%d");
+	BC_ASSERT_EQUAL(counts.deliveredToUser, initialCounts.deliveredToUser + nbParticipants, int, "%d");
+
+	for (const auto &participant : participants) {
+		mainDb.setChatMessageParticipantState(eventLog, participant, ChatMessage::State::Displayed, time(nullptr));
+		counts = mainDb.getChatMessageParticipantStateCounts(eventLog);
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+	BC_ASSERT_EQUAL(counts.total, initialCounts.total + nbParticipants, int, "%d");
+	BC_ASSERT_EQUAL(counts.deliveredToUser, initialCounts.deliveredToUser, int, "%d");
+	BC_ASSERT_EQUAL(counts.displayed, initialCounts.displayed + nbParticipants, int, "%d");
+	BC_ASSERT_EQUAL(counts.notDelivered, initialCounts.notDelivered, int, "%d");
+
+	// A display notification can't be followed by a delivery notification.
+	mainDb.setChatMessageParticipantState(eventLog, participants.front(), ChatMessage::State::DeliveredToUser, time(nullptr));
+	BC_ASSERT_EQUAL(mainDb.getChatMessageParticipantStateCounts(eventLog).displayed, counts.displayed, int, "%d");
+
+	// The counters match the states stored for each participant.
+	int nbDisplayed = 0;
+	for (const auto &state : mainDb.getChatMessageParticipantStates(eventLog))
+		if (state == ChatMessage::State::Displayed)
+			nbDisplayed++;
+	BC_ASSERT_EQUAL(nbDisplayed, counts.displayed, int, "%d");
+
+	long ms = (long) chrono::duration_cast<chrono::milliseconds>(end - start).count();
+	ms_message("%d participant state changes done in %li ms", 2 * nbParticipants, ms);
+}
+
 static void load_a_lot_of_chatrooms(void) {
 	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
 	MainDbProvider provider("db/chatrooms.db");
@@ -281,14 +457,293 @@ static void load_a_lot_of_chatrooms(void) {
 #endif
 }
 
+static void find_chat_rooms_from_indexes (void) {
+	MainDbProvider provider("db/chatrooms.db");
+	const Core &core = provider.getCore();
+	list<shared_ptr<AbstractChatRoom>> chatRooms = core.getChatRooms();
+	BC_ASSERT_FALSE(chatRooms.empty());
+
+	int nbOneToOneChatRooms = 0;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for (const auto &chatRoom : chatRooms) {
+		list<shared_ptr<AbstractChatRoom>> found = core.findChatRooms(chatRoom->getPeerAddress());
+		BC_ASSERT_TRUE(find(found.cbegin(), found.cend(), chatRoom) != found.cend());
+
+		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
+		if (!(capabilities & ChatRoom::Capabilities::OneToOne))
+			continue;
+
+		IdentityAddress participantAddress = chatRoom->getPeerAddress();
+		if (capabilities & ChatRoom::Capabilities::Conference) {
+			if (chatRoom->getParticipants().empty() || chatRoom->getParticipants().front()->getAddress().hasGruu())
+				continue;
+			participantAddress = chatRoom->getParticipants().front()->getAddress();
+		}
+		++nbOneToOneChatRooms;
+
+		shared_ptr<AbstractChatRoom> oneToOneChatRoom = core.findOneToOneChatRoom(
+			chatRoom->getLocalAddress(),
+			participantAddress,
+			false,
+			false,
+			bool(capabilities & ChatRoom::Capabilities::Encrypted)
+		);
+		BC_ASSERT_PTR_NOT_NULL(oneToOneChatRoom);
+		if (oneToOneChatRoom) {
+			BC_ASSERT_TRUE(oneToOneChatRoom->getCapabilities() & ChatRoom::Capabilities::OneToOne);
+			BC_ASSERT_TRUE(oneToOneChatRoom->getLocalAddress().getAddressWithoutGruu() == chatRoom->getLocalAddress().getAddressWithoutGruu());
+		}
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+	long ms = (long) chrono::duration_cast<chrono::milliseconds>(end - start).count();
+	ms_message("%d chat rooms (%d one-to-one) found in %li ms", (int)chatRooms.size(), nbOneToOneChatRooms, ms);
+
+	BC_ASSERT_PTR_NULL(core.findOneToOneChatRoom(
+		IdentityAddress("sip:nobody@sip.example.org"),
+		IdentityAddress("sip:unknown@sip.example.org"),
+		false,
+		false,
+		false
+	));
+}
+
+static void find_chat_rooms_by_id (void) {
+	MainDbProvider provider("db/chatrooms.db");
+	const Core &core = provider.getCore();
+	list<shared_ptr<AbstractChatRoom>> chatRooms = core.getChatRooms();
+	if (!BC_ASSERT_FALSE(chatRooms.empty()))
+		return;
+
+	// Copies, as the lookups in the core are done with ConferenceIds built from the received messages.
+	vector<ConferenceId> conferenceIds;
+	for (const auto &chatRoom : chatRooms)
+		conferenceIds.emplace_back(
+			ConferenceAddress(chatRoom->getConferenceId().getPeerAddress().asString()),
+			ConferenceAddress(chatRoom->getConferenceId().getLocalAddress().asString())
+		);
+
+	const int nbLookups = 100000;
+	int nbFound = 0;
+	int nbMismatches = 0;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < nbLookups; i++) {
+		const ConferenceId &conferenceId = conferenceIds[size_t(i) % conferenceIds.size()];
+		shared_ptr<AbstractChatRoom> chatRoom = core.findChatRoom(conferenceId, false);
+		if (!chatRoom)
+			continue;
+		nbFound++;
+		if (chatRoom->getConferenceId() != conferenceId)
+			nbMismatches++;
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+	BC_ASSERT_EQUAL(nbFound, nbLookups, int, "%d");
+	BC_ASSERT_EQUAL(nbMismatches, 0, int, "%d");
+
+	// An unknown conference id is not found.
+	BC_ASSERT_PTR_NULL(core.findChatRoom(ConferenceId(
+		ConferenceAddress("sip:unknown-conference@sip.example.org"),
+		conferenceIds.front().getLocalAddress()
+	), false));
+	long ms = (long) chrono::duration_cast<chrono::milliseconds>(end - start).count();
+	ms_message("%d chat room lookups among %d chat rooms done in %li ms", nbLookups, (int)chatRooms.size(), ms);
+}
+
+static void index_chat_rooms_becoming_one_to_one (void) {
+	MainDbProvider provider("db/chatrooms.db");
+	const Core &core = provider.getCore();
+	vector<shared_ptr<ClientGroupChatRoom>> chatRooms;
+	for (const auto &chatRoom : core.getChatRooms()) {
+		if (chatRoom->getCapabilities().isSet(ChatRoom::Capabilities::OneToOne) || chatRoom->getParticipants().empty())
+			continue;
+		auto clientGroupChatRoom = dynamic_pointer_cast<ClientGroupChatRoom>(chatRoom);
+		if (clientGroupChatRoom)
+			chatRooms.push_back(clientGroupChatRoom);
+		if (chatRooms.size() == 2)
+			break;
+	}
+	if (!BC_ASSERT_EQUAL((int)chatRooms.size(), 2, int, "%d"))
+		return;
+
+	auto findOneToOneChatRoom = [&core](const shared_ptr<ClientGroupChatRoom> &chatRoom) {
+		return core.findOneToOneChatRoom(
+			chatRoom->getLocalAddress(),
+			chatRoom->getParticipants().front()->getAddress(),
+			false,
+			true,
+			chatRoom->getCapabilities().isSet(ChatRoom::Capabilities::Encrypted)
+		);
+	};
+	BC_ASSERT_PTR_NULL(findOneToOneChatRoom(chatRooms[0]));
+	BC_ASSERT_PTR_NULL(findOneToOneChatRoom(chatRooms[1]));
+
+	// The OneToOne capability received in the conference keywords, or in the INVITE, indexes the chat room again.
+	static_cast<ConferenceListener *>(chatRooms[0].get())->onConferenceKeywordsChanged({ "one-to-one" });
+	BC_ASSERT_TRUE(findOneToOneChatRoom(chatRooms[0]) == chatRooms[0]);
+	L_GET_PRIVATE(chatRooms[1])->addOneToOneCapability();
+	BC_ASSERT_TRUE(findOneToOneChatRoom(chatRooms[1]) == chatRooms[1]);
+}
+
+// Describes the participants and devices of a chat room, sorted to be compared whatever the loading order.
+static vector<string> describe_chat_room_participants (const shared_ptr<AbstractChatRoom> &chatRoom) {
+	vector<string> descriptions;
+	list<shared_ptr<Participant>> participants = chatRoom->getParticipants();
+	if (chatRoom->getMe())
+		participants.push_back(chatRoom->getMe());
+	for (const auto &participant : participants) {
+		descriptions.push_back(participant->getAddress().asString() + (participant->isAdmin() ? " admin" : ""));
+		for (const auto &device : participant->getDevices())
+			descriptions.push_back(participant->getAddress().asString() + " device " + device->getAddress().asString()
+				+ " " + to_string(int(device->getState())) + " " + device->getName());
+	}
+	sort(descriptions.begin(), descriptions.end());
+	return descriptions;
+}
+
+static void load_chat_rooms_participants (void) {
+	MainDbProvider provider("db/chatrooms.db");
+	MainDb &mainDb = provider.getMainDb();
+	const Core &core = provider.getCore();
+	soci::session *session = L_GET_PRIVATE(&mainDb)->dbSession.getBackendSession();
+	list<shared_ptr<AbstractChatRoom>> chatRooms = core.getChatRooms();
+	BC_ASSERT_FALSE(chatRooms.empty());
+
+	// The participants and devices loaded for all the chat rooms at once must match the ones of the per chat room queries.
+	vector<pair<long long, ConferenceId>> chatRoomIds;
+	soci::rowset<soci::row> chatRoomRows = (session->prepare << "SELECT chat_room.id, peer_sip_address.value, local_sip_address.value"
+		" FROM chat_room, sip_address AS peer_sip_address, sip_address AS local_sip_address"
+		" WHERE chat_room.peer_sip_address_id = peer_sip_address.id AND chat_room.local_sip_address_id = local_sip_address.id");
+	for (const auto &chatRoomRow : chatRoomRows)
+		chatRoomIds.emplace_back(
+			L_GET_PRIVATE(&mainDb)->dbSession.resolveId(chatRoomRow, 0),
+			ConferenceId(ConferenceAddress(chatRoomRow.get<string>(1)), ConferenceAddress(chatRoomRow.get<string>(2)))
+		);
+	BC_ASSERT_EQUAL((int)chatRoomIds.size(), (int)chatRooms.size(), int, "%d");
+
+	int nbCheckedChatRooms = 0;
+	for (const auto &chatRoomId : chatRoomIds) {
+		shared_ptr<AbstractChatRoom> chatRoom = core.findChatRoom(chatRoomId.second, false);
+		if (!BC_ASSERT_PTR_NOT_NULL(chatRoom) || chatRoom->getCapabilities().isSet(ChatRoom::Capabilities::Basic))
+			continue;
+
+		vector<string> expectedDescriptions;
+		soci::rowset<soci::row> participantRows = (session->prepare << "SELECT chat_room_participant.id, sip_address.value, is_admin"
+			" FROM chat_room_participant, sip_address"
+			" WHERE chat_room_id = :chatRoomId AND sip_address.id = participant_sip_address_id", soci::use(chatRoomId.first));
+		for (const auto &participantRow : participantRows) {
+			const long long participantId = L_GET_PRIVATE(&mainDb)->dbSession.resolveId(participantRow, 0);
+			const string address = IdentityAddress(participantRow.get<string>(1)).asString();
+			expectedDescriptions.push_back(address + (participantRow.get<int>(2) ? " admin" : ""));
+
+			soci::rowset<soci::row> deviceRows = (session->prepare << "SELECT sip_address.value, state, name"
+				" FROM chat_room_participant_device, sip_address"
+				" WHERE chat_room_participant_id = :participantId AND participant_device_sip_address_id = sip_address.id",
+				soci::use(participantId));
+			for (const auto &deviceRow : deviceRows)
+				expectedDescriptions.push_back(address + " device " + IdentityAddress(deviceRow.get<string>(0)).asString()
+					+ " " + to_string(deviceRow.get<int>(1, 0)) + " " + deviceRow.get<string>(2, ""));
+		}
+		sort(expectedDescriptions.begin(), expectedDescriptions.end());
+
+		BC_ASSERT_TRUE(describe_chat_room_participants(chatRoom) == expectedDescriptions);
+		nbCheckedChatRooms++;
+	}
+	BC_ASSERT_GREATER(nbCheckedChatRooms, 1, int, "%d");
+	ms_message("Participants of %d chat rooms checked against the per chat room queries", nbCheckedChatRooms);
+}
+
+// Stores messages in a chat room while another connection reads its history, returns the storage time.
+static long insert_messages_while_reading_history (const char *journalMode, bool withReader) {
+	MainDbProvider provider("db/linphone.db", journalMode);
+	MainDb &mainDb = provider.getMainDb();
+	const ConferenceId conferenceId(IdentityAddress("sip:test-1@sip.linphone.org"), IdentityAddress("sip:test-1@sip.linphone.org"));
+	shared_ptr<AbstractChatRoom> chatRoom = provider.getCore().findChatRoom(conferenceId);
+	if (!BC_ASSERT_PTR_NOT_NULL(chatRoom))
+		return 0;
+	long long chatRoomId = 0;
+	const string peerAddress = conferenceId.getPeerAddress().asString();
+	const string localAddress = conferenceId.getLocalAddress().asString();
+	*L_GET_PRIVATE(&mainDb)->dbSession.getBackendSession() << "SELECT chat_room.id"
+		" FROM chat_room, sip_address AS peer_sip_address, sip_address AS local_sip_address"
+		" WHERE chat_room.peer_sip_address_id = peer_sip_address.id AND peer_sip_address.value = :peerAddress"
+		" AND chat_room.local_sip_address_id = local_sip_address.id AND local_sip_address.value = :localAddress",
+		soci::use(peerAddress), soci::use(localAddress), soci::into(chatRoomId);
+	BC_ASSERT_NOT_EQUAL((int)chatRoomId, 0, int, "%d");
+	const int initialHistorySize = mainDb.getHistorySize(conferenceId);
+
+	atomic<bool> stopped(false);
+	atomic<int> nbReads(0);
+	atomic<int> nbReadErrors(0);
+	thread reader;
+	if (withReader)
+		reader = thread([&] {
+			DbSession readerSession("sqlite3://" + Utils::quoteStringIfNotAlready(provider.getDbPath()));
+			soci::session *session = readerSession.getBackendSession();
+			while (!stopped) {
+				try {
+					int nbEvents = 0;
+					soci::rowset<soci::row> rows = (session->prepare <<
+						"SELECT event_id FROM conference_event WHERE chat_room_id = :chatRoomId ORDER BY event_id DESC LIMIT 100",
+						soci::use(chatRoomId)
+					);
+					for (auto it = rows.begin(); it != rows.end(); ++it)
+						nbEvents++;
+					if (nbEvents == 100)
+						nbReads++;
+					else
+						nbReadErrors++;
+				} catch (const soci::soci_error &) {
+					nbReadErrors++;
+				}
+			}
+		});
+
+	const int nbMessages = 500;
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	for (int i = 0; i < nbMessages; i++) {
+		shared_ptr<ChatMessage> message = chatRoom->createChatMessage("Message " + Utils::toString(i));
+		L_GET_PRIVATE(message)->storeInDb();
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+
+	stopped = true;
+	if (reader.joinable())
+		reader.join();
+
+	BC_ASSERT_EQUAL(mainDb.getHistorySize(conferenceId), initialHistorySize + nbMessages, int, "%d");
+	BC_ASSERT_EQUAL(nbReadErrors.load(), 0, int, "%d");
+	if (withReader)
+		BC_ASSERT_GREATER(nbReads.load(), 0, int, "%d");
+
+	long ms = (long) chrono::duration_cast<chrono::milliseconds>(end - start).count();
+	ms_message("%d messages stored in %li ms with journal mode %s, %d history reads done meanwhile",
+		nbMessages, ms, journalMode ? journalMode : "default", nbReads.load());
+	return ms;
+}
+
+static void insert_messages_while_reading_history_wal (void) {
+	// The default rollback journal doesn't allow another connection to read while writing.
+	long defaultMs = insert_messages_while_reading_history(nullptr, false);
+	long walMs = insert_messages_while_reading_history("wal", true);
+	ms_message("Storage time: %li ms with the default journal, %li ms in WAL mode with a concurrent reader", defaultMs, walMs);
+}
+
 test_t main_db_tests[] = {
 	TEST_NO_TAG("Get events count", get_events_count),
 	TEST_NO_TAG("Get messages count", get_messages_count),
 	TEST_NO_TAG("Get unread messages count", get_unread_messages_count),
 	TEST_NO_TAG("Get history", get_history),
+	TEST_NO_TAG("Get history before an event", get_history_before),
+	TEST_NO_TAG("Cached history statements", cached_history_statements),
+	TEST_NO_TAG("Load the contents of a history page", load_history_page_contents),
 	TEST_NO_TAG("Get conference events", get_conference_notified_events),
 	TEST_NO_TAG("Get chat rooms", get_chat_rooms),
-	TEST_NO_TAG("Load a lot of chatrooms", load_a_lot_of_chatrooms)
+	TEST_NO_TAG("Load a lot of chatrooms", load_a_lot_of_chatrooms),
+	TEST_NO_TAG("Participant state counts in a large group", participant_state_counts_in_large_group),
+	TEST_NO_TAG("Find chat rooms from indexes", find_chat_rooms_from_indexes),
+	TEST_NO_TAG("Find chat rooms by id", find_chat_rooms_by_id),
+	TEST_NO_TAG("Index chat rooms becoming one-to-one", index_chat_rooms_becoming_one_to_one),
+	TEST_NO_TAG("Load the participants of the chat rooms", load_chat_rooms_participants),
+	TEST_NO_TAG("Insert messages while reading history", insert_messages_while_reading_history_wal)
 };
 
 test_suite_t main_db_test_suite = {
@@ -22,7 +22,10 @@
 #include "chat/chat-room/basic-chat-room.h"
 #include "content/content-type.h"
 #include "content/content.h"
+#include "content/content-manager.h"
 #include "content/file-content.h"
+#include "content/header/header-param.h"
+#include "content/multipart-slices.h"
 #include "core/core.h"
 
 // TODO: Remove me later.
@@ -233,6 +236,148 @@ static void multipart_two_file_content_and_one_text_with_cpim(void) {
 	chat_message_multipart_modifier_base(true, true, true, true);
 }
 
+// Content-Id of the key of a device, as the LIME server engine looks it up from the recipient address.
+static string get_device_id(int device) {
+	return Address("sip:device" + to_string(device) + "@sip.example.org").asString();
+}
+
+static Content create_cipher_message(int nbDevices, const string &leadingText = "") {
+	list<Content> contents;
+	if (!leadingText.empty()) {
+		Content text;
+		text.setContentType(ContentType::PlainText);
+		text.setBodyFromUtf8(leadingText);
+		contents.push_back(text);
+	}
+	for (int i = 0; i < nbDevices; i++) {
+		Content key;
+		key.setContentType(ContentType::LimeKey);
+		key.addHeader("Content-Id", get_device_id(i));
+		key.setBodyFromUtf8(string(150, char('A' + i % 26)));
+		contents.push_back(key);
+	}
+	Content cipher;
+	cipher.setContentType(ContentType::OctetStream);
+	cipher.setBodyFromUtf8(string(4096, 'c'));
+	contents.push_back(cipher);
+
+	list<Content *> contentPointers;
+	for (auto &content : contents)
+		contentPointers.push_back(&content);
+	return ContentManager::contentListToMultipart(contentPointers, MultipartBoundary, true);
+}
+
+static void check_device_message(const Content &message, const string &deviceId, const string &leadingText = "") {
+	list<Content> parts = ContentManager::multipartToContentList(message);
+	const size_t nbParts = leadingText.empty() ? 2 : 3;
+	BC_ASSERT_EQUAL((int)parts.size(), (int)nbParts, int, "%d");
+	if (parts.size() != nbParts)
+		return;
+	if (!leadingText.empty()) {
+		BC_ASSERT_TRUE(parts.front().getContentType() == ContentType::PlainText);
+		BC_ASSERT_STRING_EQUAL(parts.front().getBodyAsUtf8String().c_str(), leadingText.c_str());
+		parts.pop_front();
+	}
+	BC_ASSERT_TRUE(parts.front().getContentType() == ContentType::LimeKey);
+	BC_ASSERT_STRING_EQUAL(parts.front().getHeader("Content-Id").getValueWithParams().c_str(), deviceId.c_str());
+	BC_ASSERT_TRUE(parts.back().getContentType() == ContentType::OctetStream);
+	BC_ASSERT_EQUAL((int)parts.back().getSize(), 4096, int, "%d");
+}
+
+// Body sent to a device by the LIME server engine.
+static MultipartSlicesCache::Result assemble_device_message(
+	MultipartSlicesCache &cache,
+	const Content &cipherMessage,
+	const string &deviceId,
+	Content &deviceMessage
+) {
+	string body;
+	MultipartSlicesCache::Result result = cache.assembleForRecipient(cipherMessage, deviceId, body);
+	deviceMessage.setContentType(cipherMessage.getContentType());
+	deviceMessage.setBodyFromUtf8(body);
+	return result;
+}
+
+// Messages for each device of a cipher message, as done by the LIME server engine.
+static void multipart_slices_per_device(void) {
+	for (int nbDevices : {10, 50, 200}) {
+		Content cipherMessage = create_cipher_message(nbDevices);
+
+		uint64_t start = bctbx_get_cur_time_ms();
+		for (int i = 0; i < nbDevices; i++) {
+			const string deviceId = get_device_id(i);
+			list<Content> contentsList = ContentManager::multipartToContentList(cipherMessage);
+			list<Content *> contents;
+			for (auto &content : contentsList) {
+				if (content.getContentType() != ContentType::LimeKey || content.getHeader("Content-Id").getValueWithParams() == deviceId)
+					contents.push_back(&content);
+			}
+			Content finalContent = ContentManager::contentListToMultipart(contents, MultipartBoundary, true);
+			if (i == 0)
+				check_device_message(finalContent, deviceId);
+		}
+		uint64_t parseEach = bctbx_get_cur_time_ms() - start;
+
+		start = bctbx_get_cur_time_ms();
+		MultipartSlicesCache cache(ContentType::LimeKey, 8);
+		for (int i = 0; i < nbDevices; i++) {
+			// Each device gets its own copy of the message.
+			Content messageCopy(cipherMessage);
+			Content finalContent;
+			BC_ASSERT_TRUE(assemble_device_message(cache, messageCopy, get_device_id(i), finalContent) == MultipartSlicesCache::Result::Done);
+			if (i == 0 || i == nbDevices - 1)
+				check_device_message(finalContent, get_device_id(i));
+		}
+		BC_ASSERT_EQUAL((int)cache.getSplitCount(), 1, int, "%d");
+		uint64_t sliced = bctbx_get_cur_time_ms() - start;
+
+		ms_message("%d devices: %llu ms when parsing the message for each device, %llu ms when slicing it once",
+			nbDevices, (unsigned long long)parseEach, (unsigned long long)sliced);
+	}
+}
+
+static void multipart_slices_cache(void) {
+	MultipartSlicesCache cache(ContentType::LimeKey, 2);
+	const int nbDevices = 3;
+	Content messages[] = {
+		create_cipher_message(nbDevices, "Message 0"),
+		create_cipher_message(nbDevices, "Message 1"),
+		create_cipher_message(nbDevices, "Message 2")
+	};
+	Content deviceMessage;
+
+	// The key of the device takes the place of all the keys among the common parts.
+	BC_ASSERT_TRUE(assemble_device_message(cache, messages[0], get_device_id(1), deviceMessage) == MultipartSlicesCache::Result::Done);
+	check_device_message(deviceMessage, get_device_id(1), "Message 0");
+	BC_ASSERT_TRUE(assemble_device_message(cache, messages[1], get_device_id(0), deviceMessage) == MultipartSlicesCache::Result::Done);
+	check_device_message(deviceMessage, get_device_id(0), "Message 1");
+	BC_ASSERT_EQUAL((int)cache.getSplitCount(), 2, int, "%d");
+
+	// A message is matched by its body, even when it is not a copy of the split one.
+	Content sameMessage = create_cipher_message(nbDevices, "Message 0");
+	BC_ASSERT_TRUE(assemble_device_message(cache, sameMessage, get_device_id(2), deviceMessage) == MultipartSlicesCache::Result::Done);
+	check_device_message(deviceMessage, get_device_id(2), "Message 0");
+	BC_ASSERT_EQUAL((int)cache.getSplitCount(), 2, int, "%d");
+
+	// The least recently used message is dropped.
+	BC_ASSERT_TRUE(assemble_device_message(cache, messages[2], get_device_id(0), deviceMessage) == MultipartSlicesCache::Result::Done);
+	check_device_message(deviceMessage, get_device_id(0), "Message 2");
+	BC_ASSERT_EQUAL((int)cache.getSplitCount(), 3, int, "%d");
+	BC_ASSERT_TRUE(assemble_device_message(cache, messages[0], get_device_id(0), deviceMessage) == MultipartSlicesCache::Result::Done);
+	BC_ASSERT_EQUAL((int)cache.getSplitCount(), 3, int, "%d");
+	BC_ASSERT_TRUE(assemble_device_message(cache, messages[1], get_device_id(1), deviceMessage) == MultipartSlicesCache::Result::Done);
+	check_device_message(deviceMessage, get_device_id(1), "Message 1");
+	BC_ASSERT_EQUAL((int)cache.getSplitCount(), 4, int, "%d");
+
+	// Unknown device, and content that is not a multipart.
+	string body;
+	BC_ASSERT_TRUE(cache.assembleForRecipient(messages[1], get_device_id(nbDevices), body) == MultipartSlicesCache::Result::MissingRecipient);
+	Content text;
+	text.setContentType(ContentType::PlainText);
+	text.setBodyFromUtf8("Hello");
+	BC_ASSERT_TRUE(cache.assembleForRecipient(text, get_device_id(0), body) == MultipartSlicesCache::Result::NotSplit);
+}
+
 test_t multipart_tests[] = {
 	TEST_NO_TAG("Chat message multipart 2 text content", multipart_two_text_content),
 	TEST_NO_TAG("Chat message multipart 2 text content with CPIM", multipart_two_text_content_with_cpim),
@@ -242,6 +387,8 @@ test_t multipart_tests[] = {
 	TEST_NO_TAG("Chat message multipart 2 file content with CPIM", multipart_two_file_content_with_cpim),
 	TEST_NO_TAG("Chat message multipart 2 file content and 1 text", multipart_two_file_content_and_one_text),
 	TEST_NO_TAG("Chat message multipart 2 file content and 1 text with CPIM", multipart_two_file_content_and_one_text_with_cpim),
+	TEST_NO_TAG("Multipart slices for each device", multipart_slices_per_device),
+	TEST_NO_TAG("Multipart slices cache", multipart_slices_cache),
 };
 
 test_suite_t multipart_test_suite = {
@@ -125,6 +125,34 @@ static void simple_subscribe(void) {
 
 	linphone_core_manager_destroy(pauline);
 }
+static void presence_notified_to_several_watchers(void) {
+	LinphoneCoreManager* marie = presence_linphone_core_manager_new("marie");
+	LinphoneCoreManager* laure = presence_linphone_core_manager_new("laure");
+	LinphoneCoreManager* pauline = presence_linphone_core_manager_new("pauline");
+	LinphonePresenceModel *presence;
+	bctbx_list_t *lcs = NULL;
+
+	lcs = bctbx_list_append(lcs, marie->lc);
+	lcs = bctbx_list_append(lcs, laure->lc);
+	lcs = bctbx_list_append(lcs, pauline->lc);
+
+	BC_ASSERT_TRUE(subscribe_to_callee_presence(marie,pauline));
+	BC_ASSERT_TRUE(subscribe_to_callee_presence(laure,pauline));
+
+	/*the presence is serialized once, and sent to both watchers*/
+	presence = linphone_presence_model_new_with_activity(LinphonePresenceActivityBusy, NULL);
+	linphone_core_set_presence_model(pauline->lc, presence);
+	linphone_presence_model_unref(presence);
+	BC_ASSERT_TRUE(wait_for_list(lcs,&marie->stat.number_of_LinphonePresenceActivityBusy,1, 5000));
+	BC_ASSERT_TRUE(wait_for_list(lcs,&laure->stat.number_of_LinphonePresenceActivityBusy,1, 5000));
+	BC_ASSERT_EQUAL(linphone_friend_list_get_presence_notify_count(linphone_core_get_default_friend_list(pauline->lc)), 2, int, "%d");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(laure);
+	linphone_core_manager_destroy(pauline);
+	bctbx_list_free(lcs);
+}
+
 static void simple_subscribe_with_early_notify(void) {
 
 	LinphoneCoreManager* marie = presence_linphone_core_manager_new("marie");
@@ -412,6 +440,7 @@ static void simple_subscribe_with_friend_from_rc(void) {
 test_t presence_tests[] = {
 	TEST_ONE_TAG("Simple Subscribe", simple_subscribe,"presence"),
 	TEST_ONE_TAG("Simple Subscribe with early NOTIFY", simple_subscribe_with_early_notify,"presence"),
+	TEST_ONE_TAG("Presence notified to several watchers", presence_notified_to_several_watchers,"presence"),
 	TEST_NO_TAG("Simple Subscribe with friend from rc", simple_subscribe_with_friend_from_rc),
 	/*TEST_ONE_TAG("Call with presence", call_with_presence, "LeaksMemory"),*/
 	TEST_NO_TAG("Unsubscribe while subscribing", unsubscribe_while_subscribing),
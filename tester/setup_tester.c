@@ -127,6 +127,70 @@ static void linphone_version_test(void){
 	linphone_logging_service_set_log_level_mask(linphone_logging_service_get(), old);
 }
 
+static void async_log_output(void) {
+	LinphoneLoggingService *log_service = linphone_logging_service_get();
+	char *log_path = bc_tester_file("async_log.txt");
+	char message[64];
+	char *content;
+	FILE *f;
+	long size;
+	uint64_t written;
+	const int count = 1000;
+	unsigned int old_mask = linphone_logging_service_get_log_level_mask(log_service);
+	char *old_domain = linphone_logging_service_get_domain(log_service) ? bctbx_strdup(linphone_logging_service_get_domain(log_service)) : NULL;
+
+	remove(log_path);
+	linphone_logging_service_set_domain(log_service, "test");
+	linphone_logging_service_set_log_level_mask(log_service, LinphoneLogLevelMessage | LinphoneLogLevelWarning | LinphoneLogLevelError | LinphoneLogLevelFatal);
+	BC_ASSERT_EQUAL(linphone_logging_service_enable_async_output(log_service, log_path, 64, LinphoneLogOverflowPolicyBlock), 0, int, "%d");
+	BC_ASSERT_TRUE(linphone_logging_service_async_output_enabled(log_service));
+	for (int i = 0; i < count; i++) {
+		snprintf(message, sizeof(message), "async log %d", i);
+		linphone_logging_service_message(log_service, message);
+	}
+	linphone_logging_service_flush(log_service);
+	written = linphone_logging_service_get_async_written_count(log_service);
+	BC_ASSERT_GREATER((int)written, count, int, "%d");
+	BC_ASSERT_EQUAL((int)linphone_logging_service_get_async_dropped_count(log_service), 0, int, "%d");
+
+	/* Everything logged before the flush is in the file. */
+	f = fopen(log_path, "rb");
+	if (BC_ASSERT_PTR_NOT_NULL(f)) {
+		fseek(f, 0, SEEK_END);
+		size = ftell(f);
+		fseek(f, 0, SEEK_SET);
+		content = bctbx_malloc0((size_t)size + 1);
+		BC_ASSERT_EQUAL((int)fread(content, 1, (size_t)size, f), (int)size, int, "%d");
+		fclose(f);
+		BC_ASSERT_PTR_NOT_NULL(strstr(content, "[test] MESSAGE async log 0\n"));
+		snprintf(message, sizeof(message), "[test] MESSAGE async log %d\n", count - 1);
+		BC_ASSERT_PTR_NOT_NULL(strstr(content, message));
+		bctbx_free(content);
+	}
+
+	/* With a tiny buffer, the logging thread never waits: messages the output can't keep up with are dropped. */
+	BC_ASSERT_EQUAL(linphone_logging_service_enable_async_output(log_service, log_path, 2, LinphoneLogOverflowPolicyDrop), 0, int, "%d");
+	for (int i = 0; i < count; i++) {
+		snprintf(message, sizeof(message), "dropped log %d", i);
+		linphone_logging_service_message(log_service, message);
+	}
+	linphone_logging_service_flush(log_service);
+	BC_ASSERT_GREATER((int)(linphone_logging_service_get_async_written_count(log_service) + linphone_logging_service_get_async_dropped_count(log_service)), count, int, "%d");
+	ms_message("Async log output: %d written, %d dropped", (int)linphone_logging_service_get_async_written_count(log_service), (int)linphone_logging_service_get_async_dropped_count(log_service));
+
+	linphone_logging_service_disable_async_output(log_service);
+	BC_ASSERT_FALSE(linphone_logging_service_async_output_enabled(log_service));
+	BC_ASSERT_EQUAL((int)linphone_logging_service_get_async_written_count(log_service), 0, int, "%d");
+	BC_ASSERT_EQUAL(linphone_logging_service_enable_async_output(log_service, "/nonexistent/directory/async_log.txt", 64, LinphoneLogOverflowPolicyDrop), -1, int, "%d");
+	BC_ASSERT_FALSE(linphone_logging_service_async_output_enabled(log_service));
+
+	linphone_logging_service_set_log_level_mask(log_service, old_mask);
+	linphone_logging_service_set_domain(log_service, old_domain);
+	if (old_domain) bctbx_free(old_domain);
+	remove(log_path);
+	bctbx_free(log_path);
+}
+
 void version_update_check_cb(LinphoneCore *core, LinphoneVersionUpdateCheckResult result, const char *version, const char *url) {
 	BC_ASSERT_STRING_EQUAL(version, "5.1.0-beta-12+af6t1i8");
 	BC_ASSERT_STRING_EQUAL(url, "https://example.org/update.html");
@@ -489,6 +553,116 @@ static void linphone_lpconfig_from_file_zerolen_value(void){
 	linphone_config_destroy(conf);
 }
 
+static void linphone_lpconfig_lookups(void) {
+	LinphoneCoreManager* mgr = linphone_core_manager_new_with_proxies_check("marie_rc", FALSE);
+	LpConfig *conf = linphone_core_get_config(mgr->lc);
+	uint64_t startupLookups = linphone_config_get_lookup_count(conf);
+	bctbx_list_t *sections = linphone_config_get_sections_names_list(conf);
+	const int rounds = 1000;
+	int entries = 0;
+	MSTimeSpec start, current;
+	long long time;
+
+	BC_ASSERT_GREATER_STRICT((int)startupLookups, 0, int, "%d");
+	liblinphone_tester_clock_start(&start);
+	for (int i = 0; i < rounds; i++) {
+		for (bctbx_list_t *section = sections; section != NULL; section = bctbx_list_next(section)) {
+			bctbx_list_t *keys = linphone_config_get_keys_names_list(conf, (const char *)bctbx_list_get_data(section));
+			for (bctbx_list_t *key = keys; key != NULL; key = bctbx_list_next(key)) {
+				const char *value = linphone_config_get_string(conf, (const char *)bctbx_list_get_data(section), (const char *)bctbx_list_get_data(key), NULL);
+				if (i == 0) {
+					BC_ASSERT_PTR_NOT_NULL(value);
+					entries++;
+				}
+			}
+			bctbx_list_free(keys);
+		}
+	}
+	ms_get_cur_time(&current);
+	time = ((current.tv_sec - start.tv_sec) * 1000000000LL) + (current.tv_nsec - start.tv_nsec);
+	if (entries > 0) {
+		long long lookupTime = time / ((long long)rounds * entries);
+		ms_message("%llu config lookups during core startup, %d entries in config, %lld ns per lookup, about %lld us spent in lookups at startup",
+			(unsigned long long)startupLookups, entries, lookupTime, (long long)startupLookups * lookupTime / 1000LL);
+	}
+	bctbx_list_free(sections);
+
+	/* Indexes must follow removals and additions. */
+	linphone_config_set_string(conf, "lookups", "key", "first");
+	linphone_config_clean_entry(conf, "lookups", "key");
+	BC_ASSERT_STRING_EQUAL(linphone_config_get_string(conf, "lookups", "key", "none"), "none");
+	linphone_config_set_string(conf, "lookups", "key", "second");
+	BC_ASSERT_STRING_EQUAL(linphone_config_get_string(conf, "lookups", "key", "none"), "second");
+	linphone_config_clean_section(conf, "lookups");
+	BC_ASSERT_FALSE(linphone_config_has_section(conf, "lookups"));
+	linphone_config_set_string(conf, "lookups", "key", "third");
+	BC_ASSERT_STRING_EQUAL(linphone_config_get_string(conf, "lookups", "key", "none"), "third");
+	linphone_config_clean_section(conf, "lookups");
+
+	linphone_core_manager_destroy(mgr);
+}
+
+static void linphone_lpconfig_write_behind(void) {
+	char *rc_path = bc_tester_file("write_behind_rc");
+	char key[32];
+	LpConfig *conf;
+	LinphoneCore *lc;
+	uint64_t bytes;
+
+	remove(rc_path);
+	conf = linphone_config_new(rc_path);
+	for (int i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), "key_%d", i);
+		linphone_config_set_int(conf, "write_behind", key, i);
+	}
+	BC_ASSERT_TRUE(linphone_config_needs_commit(conf));
+	BC_ASSERT_EQUAL(linphone_config_sync(conf), 0, int, "%d");
+	BC_ASSERT_EQUAL((int)linphone_config_get_sync_count(conf), 1, int, "%d");
+	bytes = linphone_config_get_bytes_written(conf);
+	BC_ASSERT_GREATER_STRICT((int)bytes, 0, int, "%d");
+
+	/* Setting the same value, or removing something that does not exist, is not a change. */
+	linphone_config_set_int(conf, "write_behind", "key_0", 0);
+	linphone_config_set_string(conf, "write_behind", "missing", NULL);
+	linphone_config_clean_section(conf, "missing_section");
+	BC_ASSERT_FALSE(linphone_config_needs_commit(conf));
+
+	/* Changes cancelling each other are not written. */
+	linphone_config_set_int(conf, "write_behind", "key_0", 42);
+	linphone_config_set_int(conf, "write_behind", "key_0", 0);
+	BC_ASSERT_TRUE(linphone_config_needs_commit(conf));
+	BC_ASSERT_EQUAL(linphone_config_sync(conf), 0, int, "%d");
+	BC_ASSERT_FALSE(linphone_config_needs_commit(conf));
+	BC_ASSERT_EQUAL((int)linphone_config_get_sync_count(conf), 1, int, "%d");
+
+	linphone_config_set_int(conf, "misc", "config_sync_delay", 200);
+	linphone_config_sync(conf);
+	BC_ASSERT_EQUAL((int)linphone_config_get_sync_count(conf), 2, int, "%d");
+	linphone_config_unref(conf);
+
+	/* A burst of changes made by the core is written once. */
+	lc = linphone_factory_create_core_3(linphone_factory_get(), rc_path, NULL, system_context);
+	if (BC_ASSERT_PTR_NOT_NULL(lc)) {
+		linphone_core_start(lc);
+		conf = linphone_core_get_config(lc);
+		wait_for_until(lc, NULL, NULL, 0, 500);
+		uint64_t syncCount = linphone_config_get_sync_count(conf);
+		for (int i = 0; i < 100; i++) {
+			snprintf(key, sizeof(key), "key_%d", i);
+			linphone_config_set_int(conf, "write_behind", key, i + 1);
+			if (i % 10 == 0) wait_for_until(lc, NULL, NULL, 0, 10);
+		}
+		wait_for_until(lc, NULL, NULL, 0, 1000);
+		BC_ASSERT_FALSE(linphone_config_needs_commit(conf));
+		BC_ASSERT_EQUAL((int)(linphone_config_get_sync_count(conf) - syncCount), 1, int, "%d");
+		ms_message("Config written %d times, %d bytes", (int)linphone_config_get_sync_count(conf), (int)linphone_config_get_bytes_written(conf));
+		linphone_core_unref(lc);
+	}
+
+	remove(rc_path);
+	bctbx_free(rc_path);
+}
+
 void linphone_lpconfig_invalid_friend(void) {
 	LinphoneCoreManager* mgr = linphone_core_manager_new_with_proxies_check("invalid_friends_rc",FALSE);
 	LinphoneFriendList *friendList = linphone_core_get_default_friend_list(mgr->lc);
@@ -1985,6 +2159,69 @@ static void search_friend_large_database(void) {
 	bc_free(dbPath);
 }
 
+static void search_friend_index_latency_and_updates(void) {
+	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	LinphoneMagicSearch *magicSearch = linphone_magic_search_new(manager->lc);
+	const int friendCounts[] = {100, 1000, 5000};
+	const char *searchedFriend = "user0042";
+	bctbx_list_t *friends = NULL;
+	bctbx_list_t *resultList = NULL;
+	int count = 0;
+
+	for (size_t c = 0; c < sizeof(friendCounts) / sizeof(friendCounts[0]); c++) {
+		for (; count < friendCounts[c]; count++) {
+			char uri[64];
+			char name[64];
+			snprintf(uri, sizeof(uri), "sip:user%04d@sip.example.org", count);
+			snprintf(name, sizeof(name), "Contact %04d", count);
+			LinphoneFriend *lf = linphone_core_create_friend_with_address(manager->lc, uri);
+			linphone_friend_enable_subscribes(lf, FALSE);
+			linphone_friend_set_name(lf, name);
+			linphone_friend_list_add_local_friend(lfl, lf);
+			friends = bctbx_list_append(friends, lf);
+		}
+
+		for (size_t i = 1; i <= strlen(searchedFriend); i++) {
+			MSTimeSpec start, current;
+			char subBuff[16];
+			long long time;
+			memcpy(subBuff, searchedFriend, i);
+			subBuff[i] = '\0';
+			liblinphone_tester_clock_start(&start);
+			resultList = linphone_magic_search_get_contacts_list(magicSearch, subBuff, "", LinphoneMagicSearchSourceFriends, LinphoneMagicSearchAggregationNone);
+			ms_get_cur_time(&current);
+			time = ((current.tv_sec - start.tv_sec) * 1000000LL) + ((current.tv_nsec - start.tv_nsec) / 1000LL);
+			ms_message("%d friends, searching [%s]: %lld us, %zu results", count, subBuff, time, bctbx_list_size(resultList));
+			if (i == strlen(searchedFriend)) {
+				BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d");
+			}
+			bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+		}
+	}
+
+	// The index must follow friend updates and removals.
+	LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_nth_data(friends, 42);
+	linphone_friend_set_name(lf, "Renamed Somebody");
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "somebody", "", LinphoneMagicSearchSourceFriends, LinphoneMagicSearchAggregationNone);
+	if (BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d")) {
+		_check_friend_result_list(manager->lc, resultList, 0, "sip:user0042@sip.example.org", NULL);
+	}
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	linphone_friend_list_remove_friend(lfl, lf);
+	resultList = linphone_magic_search_get_contacts_list(magicSearch, "somebody", "", LinphoneMagicSearchSourceFriends, LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 0, int, "%d");
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	for (bctbx_list_t *it = friends; it != NULL; it = bctbx_list_next(it)) {
+		linphone_friend_list_remove_friend(lfl, (LinphoneFriend *)bctbx_list_get_data(it));
+	}
+	bctbx_list_free_with_data(friends, (bctbx_list_free_func)linphone_friend_unref);
+	linphone_magic_search_unref(magicSearch);
+	linphone_core_manager_destroy(manager);
+}
+
 static void search_friend_get_capabilities(void) {
 	LinphoneMagicSearch *magicSearch = NULL;
 	bctbx_list_t *resultList = NULL;
@@ -2487,6 +2724,59 @@ static void async_search_friend_in_sources(void){
 	linphone_core_manager_destroy(manager);
 }
 
+static void async_search_friend_while_typing(void) {
+	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	LinphoneMagicSearchCbs *searchHandler = linphone_factory_create_magic_search_cbs(linphone_factory_get());
+	LinphoneMagicSearch *magicSearch = linphone_magic_search_new(manager->lc);
+	stats *stat = get_stats(manager->lc);
+	const char *searchedFriend = "user0042";
+	bctbx_list_t *resultList = NULL;
+	MSTimeSpec start, current;
+	char subBuff[16];
+
+	for (int i = 0; i < 5000; i++) {
+		char uri[64];
+		char name[64];
+		snprintf(uri, sizeof(uri), "sip:user%04d@sip.example.org", i);
+		snprintf(name, sizeof(name), "Contact %04d", i);
+		LinphoneFriend *lf = linphone_core_create_friend_with_address(manager->lc, uri);
+		linphone_friend_enable_subscribes(lf, FALSE);
+		linphone_friend_set_name(lf, name);
+		linphone_friend_list_add_local_friend(lfl, lf);
+		linphone_friend_unref(lf);
+	}
+
+	linphone_magic_search_cbs_set_search_results_received(searchHandler, _onMagicSearchResultsReceived);
+	linphone_magic_search_cbs_set_user_data(searchHandler, stat);
+	linphone_magic_search_add_callbacks(magicSearch, searchHandler);
+
+	// Each keystroke supersedes the search of the previous one: only the last one is notified.
+	for (size_t i = 1; i <= strlen(searchedFriend); i++) {
+		memcpy(subBuff, searchedFriend, i);
+		subBuff[i] = '\0';
+		liblinphone_tester_clock_start(&start);
+		linphone_magic_search_get_contacts_list_async(magicSearch, subBuff, "", LinphoneMagicSearchSourceAll, LinphoneMagicSearchAggregationNone);
+		wait_for_until(manager->lc, NULL, NULL, 0, 20);
+	}
+	BC_ASSERT_TRUE(wait_for(manager->lc, NULL, &stat->number_of_LinphoneMagicSearchResultReceived, 1));
+	ms_get_cur_time(&current);
+	ms_message("Async search of [%s] in 5000 friends notified after %lld ms", searchedFriend,
+		((current.tv_sec - start.tv_sec) * 1000LL) + ((current.tv_nsec - start.tv_nsec) / 1000000LL));
+	wait_for_until(manager->lc, NULL, NULL, 0, 500);
+	BC_ASSERT_EQUAL(stat->number_of_LinphoneMagicSearchResultReceived, 1, int, "%d");
+
+	resultList = linphone_magic_search_get_last_search(magicSearch);
+	if (BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), 1, int, "%d")) {
+		_check_friend_result_list(manager->lc, resultList, 0, "sip:user0042@sip.example.org", NULL);
+	}
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	linphone_magic_search_cbs_unref(searchHandler);
+	linphone_magic_search_unref(magicSearch);
+	linphone_core_manager_destroy(manager);
+}
+
 static void ldap_search(void){
 // Prepare datas : Friends, Call logs, Chat rooms, ldap
 	LinphoneCoreManager* manager = linphone_core_manager_new("marie_rc");
@@ -3184,6 +3474,7 @@ static void migration_from_call_history_db (void) {
 test_t setup_tests[] = {
 	TEST_NO_TAG("Version check", linphone_version_test),
 	TEST_NO_TAG("Version update check", linphone_version_update_test),
+	TEST_NO_TAG("Asynchronous log output", async_log_output),
 	TEST_NO_TAG("Linphone Address", linphone_address_test),
 	TEST_NO_TAG("Linphone proxy config address equal (internal api)", linphone_proxy_config_address_equal_test),
 	TEST_NO_TAG("Linphone proxy config server address change (internal api)", linphone_proxy_config_is_server_config_changed_test),
@@ -3201,6 +3492,8 @@ test_t setup_tests[] = {
 	TEST_NO_TAG("LPConfig zero_len value from buffer", linphone_lpconfig_from_buffer_zerolen_value),
 	TEST_NO_TAG("LPConfig zero_len value from file", linphone_lpconfig_from_file_zerolen_value),
 	TEST_NO_TAG("LPConfig zero_len value from XML", linphone_lpconfig_from_xml_zerolen_value),
+	TEST_NO_TAG("LPConfig lookups", linphone_lpconfig_lookups),
+	TEST_NO_TAG("LPConfig write-behind", linphone_lpconfig_write_behind),
 	TEST_NO_TAG("LPConfig invalid friend", linphone_lpconfig_invalid_friend),
 	TEST_NO_TAG("LPConfig invalid friend remote provisoning", linphone_lpconfig_invalid_friend_remote_provisioning),
 	TEST_NO_TAG("Chat room", chat_room_test),
@@ -3230,10 +3523,12 @@ test_t setup_tests[] = {
 	TEST_ONE_TAG("Search friend with multiple sip address", search_friend_with_multiple_sip_address, "MagicSearch"),
 	TEST_ONE_TAG("Search friend with same address", search_friend_with_same_address, "MagicSearch"),
 	TEST_ONE_TAG("Search friend in large friends database", search_friend_large_database, "MagicSearch"),
+	TEST_ONE_TAG("Search friend index latency and updates", search_friend_index_latency_and_updates, "MagicSearch"),
 	TEST_ONE_TAG("Search friend result has capabilities", search_friend_get_capabilities, "MagicSearch"),
 	TEST_ONE_TAG("Search friend result chat room remote", search_friend_chat_room_remote, "MagicSearch"),
 	TEST_ONE_TAG("Search friend in non default friend list", search_friend_non_default_list, "MagicSearch"),
 	TEST_ONE_TAG("Async search friend in sources", async_search_friend_in_sources, "MagicSearch"),
+	TEST_ONE_TAG("Async search friend while typing", async_search_friend_while_typing, "MagicSearch"),
 	TEST_ONE_TAG("Ldap search", ldap_search, "MagicSearch"),
 	TEST_ONE_TAG("Ldap features delay", ldap_features_delay, "MagicSearch"),
 	TEST_ONE_TAG("Ldap features min characters", ldap_features_min_characters, "MagicSearch"),
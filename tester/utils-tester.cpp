@@ -21,6 +21,10 @@
 
 #include "bctoolbox/utils.hh"
 
+#include "address/identity-address-parser.h"
+#include "conference/conference-id.h"
+#include "logger/logger.h"
+
 #include "liblinphone_tester.h"
 #include "tester_utils.h"
 
@@ -103,11 +107,146 @@ static void parse_capabilities(void){
 	BC_ASSERT_TRUE(caps["ephemeral"] == Version(1, 0));
 }
 
+static int loggedValueCount = 0;
+
+static const string &loggedValue () {
+	static const string value("a value which is expensive to format");
+	loggedValueCount++;
+	return value;
+}
+
+static void disabled_logs () {
+	const int count = 1000000;
+	loggedValueCount = 0;
+	unsigned int logmask = linphone_core_get_log_level_mask();
+
+	linphone_core_set_log_level_mask((OrtpLogLevel)(ORTP_ERROR | ORTP_FATAL));
+	BC_ASSERT_FALSE(Logger::isEnabled(Logger::Debug));
+	BC_ASSERT_FALSE(Logger::isEnabled(Logger::Info));
+	BC_ASSERT_TRUE(Logger::isEnabled(Logger::Error));
+	uint64_t start = ms_get_cur_time_ms();
+	for (int i = 0; i < count; i++) {
+		lDebug() << "Disabled debug log " << i << " " << loggedValue();
+		lInfo() << "Disabled info log " << i << " " << loggedValue();
+	}
+	uint64_t disabledDuration = ms_get_cur_time_ms() - start;
+	// The stream operands of a disabled log are not evaluated.
+	BC_ASSERT_EQUAL(loggedValueCount, 0, int, "%d");
+
+	// They are once the level is enabled.
+	linphone_core_set_log_level_mask((OrtpLogLevel)(ORTP_MESSAGE | ORTP_ERROR | ORTP_FATAL));
+	BC_ASSERT_TRUE(Logger::isEnabled(Logger::Info));
+	lInfo() << "Enabled info log " << loggedValue();
+	BC_ASSERT_EQUAL(loggedValueCount, 1, int, "%d");
+	linphone_core_set_log_level_mask((OrtpLogLevel)logmask);
+
+	ms_message("%d disabled logs took %llu ms", 2 * count, (unsigned long long)disabledDuration);
+
+	// Loggers alive at the same time each get their own stream.
+	Logger outer(Logger::Info);
+	Logger inner(Logger::Info);
+	BC_ASSERT_PTR_NOT_EQUAL(&outer.getOutput(), &inner.getOutput());
+	outer.getOutput() << "Outer log";
+	inner.getOutput() << "Inner log";
+}
+
+static void identity_address_parser_cache () {
+	IdentityAddressParser *parser = IdentityAddressParser::getInstance();
+	parser->clearCache();
+	parser->setCacheCapacity(100);
+
+	// Usual addresses are parsed the same way as with the grammar.
+	IdentityAddress address("sip:laure@sip.example.org;gr=urn:uuid:5b8dc7b4-4ac3-4f04-a0a6-0a8b3b5a2ef1");
+	BC_ASSERT_STRING_EQUAL(address.getScheme().c_str(), "sip");
+	BC_ASSERT_STRING_EQUAL(address.getUsername().c_str(), "laure");
+	BC_ASSERT_STRING_EQUAL(address.getDomain().c_str(), "sip.example.org");
+	BC_ASSERT_STRING_EQUAL(address.getGruu().c_str(), "urn:uuid:5b8dc7b4-4ac3-4f04-a0a6-0a8b3b5a2ef1");
+	IdentityAddress secureAddress("sips:conference-factory@sip.example.org");
+	BC_ASSERT_STRING_EQUAL(secureAddress.getScheme().c_str(), "sips");
+	BC_ASSERT_STRING_EQUAL(secureAddress.getUsername().c_str(), "conference-factory");
+	BC_ASSERT_FALSE(secureAddress.hasGruu());
+	IdentityAddressParser::CacheStats stats = parser->getCacheStats();
+	BC_ASSERT_EQUAL((int)stats.fastParses, 2, int, "%d");
+
+	// Unusual ones are left to the grammar.
+	IdentityAddress escapedAddress("sip:laure%20d@sip.example.org");
+	BC_ASSERT_STRING_EQUAL(escapedAddress.getUsername().c_str(), "laure d");
+	IdentityAddress addressWithPort("sip:laure@sip.example.org:5060");
+	BC_ASSERT_STRING_EQUAL(addressWithPort.getDomain().c_str(), "sip.example.org");
+	stats = parser->getCacheStats();
+	BC_ASSERT_EQUAL((int)stats.fastParses, 2, int, "%d");
+
+	IdentityAddress sameAddress("sip:laure@sip.example.org;gr=urn:uuid:5b8dc7b4-4ac3-4f04-a0a6-0a8b3b5a2ef1");
+	BC_ASSERT_TRUE(address == sameAddress);
+	stats = parser->getCacheStats();
+	BC_ASSERT_EQUAL((int)stats.hits, 1, int, "%d");
+
+	// The cache never holds more addresses than its capacity, the most recently used ones are kept.
+	for (int i = 0; i < 1000; i++) {
+		IdentityAddress participant("sip:participant-" + to_string(i) + "@sip.example.org");
+		IdentityAddress recent("sip:laure@sip.example.org;gr=urn:uuid:5b8dc7b4-4ac3-4f04-a0a6-0a8b3b5a2ef1");
+	}
+	stats = parser->getCacheStats();
+	BC_ASSERT_EQUAL(stats.size, 100, int, "%d");
+	BC_ASSERT_EQUAL(stats.capacity, 100, int, "%d");
+	BC_ASSERT_EQUAL((int)stats.hits, 1001, int, "%d");
+	ms_message("Identity address cache: %d hits, %d misses, %d parsed without grammar",
+		(int)stats.hits, (int)stats.misses, (int)stats.fastParses);
+
+	parser->setCacheCapacity(IdentityAddressParser::DefaultCacheCapacity);
+	parser->clearCache();
+}
+
+static void address_hashes () {
+	IdentityAddress address("sip:laure@sip.example.org");
+	IdentityAddress secureAddress("sips:laure@sip.example.org");
+	BC_ASSERT_TRUE(address == secureAddress);
+	BC_ASSERT_EQUAL(address.getHash(), secureAddress.getHash(), size_t, "%zu");
+
+	// The cached hash follows the modifications of the address.
+	IdentityAddress deviceAddress(address);
+	BC_ASSERT_EQUAL(deviceAddress.getHash(), address.getHash(), size_t, "%zu");
+	deviceAddress.setGruu("urn:uuid:5b8dc7b4-4ac3-4f04-a0a6-0a8b3b5a2ef1");
+	BC_ASSERT_FALSE(deviceAddress == address);
+	BC_ASSERT_NOT_EQUAL(deviceAddress.getHash(), address.getHash(), size_t, "%zu");
+	deviceAddress.setGruu("");
+	BC_ASSERT_TRUE(deviceAddress == address);
+	BC_ASSERT_EQUAL(deviceAddress.getHash(), address.getHash(), size_t, "%zu");
+	deviceAddress.setUsername("pauline");
+	BC_ASSERT_FALSE(deviceAddress == address);
+	BC_ASSERT_EQUAL(deviceAddress.getHash(), IdentityAddress("sip:pauline@sip.example.org").getHash(), size_t, "%zu");
+
+	ConferenceAddress conferenceAddress("sip:conference@sip.example.org;conf-id=abcd");
+	ConferenceAddress sameConferenceAddress(conferenceAddress);
+	BC_ASSERT_TRUE(conferenceAddress == sameConferenceAddress);
+	BC_ASSERT_STRING_EQUAL(sameConferenceAddress.getConfId().c_str(), "abcd");
+
+	unordered_map<ConferenceId, int> conferences;
+	for (int i = 0; i < 100; i++)
+		conferences[ConferenceId(
+			ConferenceAddress("sip:conference-" + to_string(i) + "@sip.example.org"),
+			ConferenceAddress(address)
+		)] = i;
+	ConferenceId conferenceId(ConferenceAddress("sip:conference-42@sip.example.org"), ConferenceAddress(address));
+	BC_ASSERT_EQUAL(hash<ConferenceId>()(conferenceId), ConferenceId(conferenceId).getHash(), size_t, "%zu");
+	auto it = conferences.find(conferenceId);
+	BC_ASSERT_TRUE(it != conferences.end());
+	if (it != conferences.end())
+		BC_ASSERT_EQUAL(it->second, 42, int, "%d");
+
+	// Unlike identity addresses, conference addresses compare the scheme: a sips local address is another conference.
+	ConferenceId secureConferenceId(ConferenceAddress("sip:conference-42@sip.example.org"), ConferenceAddress(secureAddress));
+	BC_ASSERT_TRUE(conferences.find(secureConferenceId) == conferences.end());
+}
+
 test_t utils_tests[] = {
 	TEST_NO_TAG("split", split),
 	TEST_NO_TAG("trim", trim),
 	TEST_NO_TAG("Version comparisons", version_comparisons),
-	TEST_NO_TAG("Parse capabilities", parse_capabilities)
+	TEST_NO_TAG("Parse capabilities", parse_capabilities),
+	TEST_NO_TAG("Disabled logs", disabled_logs),
+	TEST_NO_TAG("Identity address parser cache", identity_address_parser_cache),
+	TEST_NO_TAG("Address hashes", address_hashes)
 };
 
 test_suite_t utils_test_suite = {
@@ -938,6 +938,64 @@ static void carddav_server_to_client_and_client_to_sever_sync(void) {
 	linphone_core_manager_destroy(manager);
 }
 
+static int count_friends_in_search_results(const bctbx_list_t *results, const char *username) {
+	int count = 0;
+	for (const bctbx_list_t *it = results; it != NULL; it = bctbx_list_next(it)) {
+		const LinphoneFriend *lf = linphone_search_result_get_friend((LinphoneSearchResult *)bctbx_list_get_data(it));
+		const LinphoneAddress *addr = lf ? linphone_friend_get_address(lf) : NULL;
+		if (addr && strcmp(linphone_address_get_username(addr), username) == 0)
+			count++;
+	}
+	return count;
+}
+
+static void carddav_update_in_magic_search(void) {
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("carddav_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_create_friend_list(manager->lc);
+	LinphoneFriendListCbs *cbs = linphone_friend_list_get_callbacks(lfl);
+	LinphoneCardDAVStats *stats = (LinphoneCardDAVStats *)ms_new0(LinphoneCardDAVStats, 1);
+	LinphoneMagicSearch *magicSearch = linphone_magic_search_new(manager->lc);
+	LinphoneVcard *lvc = linphone_vcard_context_get_vcard_from_buffer(linphone_core_get_vcard_context(manager->lc), "BEGIN:VCARD\r\nVERSION:4.0\r\nFN:Sylvain Berfini\r\nIMPP:sip:sberfini@sip.linphone.org\r\nUID:1f08dd48-29ac-4097-8e48-8596d7776283\r\nEND:VCARD\r\n");
+	LinphoneFriend *lf = NULL;
+	bctbx_list_t *resultList = NULL;
+
+	linphone_vcard_set_url(lvc, "/card.php/addressbooks/tester/default/me.vcf");
+	lf = linphone_friend_new_from_vcard(lvc);
+	linphone_vcard_unref(lvc);
+	linphone_friend_list_cbs_set_user_data(cbs, stats);
+	linphone_friend_list_cbs_set_contact_created(cbs, carddav_contact_created);
+	linphone_friend_list_cbs_set_contact_deleted(cbs, carddav_contact_deleted);
+	linphone_friend_list_cbs_set_contact_updated(cbs, carddav_contact_updated);
+	linphone_friend_list_cbs_set_sync_status_changed(cbs, carddav_sync_status_changed);
+	linphone_core_add_friend_list(manager->lc, lfl);
+	linphone_friend_list_set_uri(lfl, CARDDAV_SERVER);
+	BC_ASSERT_EQUAL(linphone_friend_list_add_local_friend(lfl, lf), LinphoneFriendListOK, int, "%d");
+	linphone_friend_unref(lf);
+
+	// The search index of the list is built with the local version of the friend
+	resultList = linphone_magic_search_get_contact_list_from_filter(magicSearch, "berfini", "");
+	BC_ASSERT_EQUAL(count_friends_in_search_results(resultList, "sberfini"), 1, int, "%d");
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	// The server version of the friend (see carddav_clean) replaces it in the list and in the index
+	linphone_friend_list_synchronize_friends_from_server(lfl);
+	wait_for_until(manager->lc, NULL, &stats->updated_contact_count, 1, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(stats->updated_contact_count, 1, int, "%i");
+	wait_for_until(manager->lc, NULL, &stats->sync_done_count, 1, CARDDAV_SYNC_TIMEOUT);
+	BC_ASSERT_EQUAL(stats->sync_done_count, 1, int, "%i");
+
+	linphone_magic_search_reset_search_cache(magicSearch);
+	resultList = linphone_magic_search_get_contact_list_from_filter(magicSearch, "berfini", "");
+	BC_ASSERT_EQUAL(count_friends_in_search_results(resultList, "sberfini"), 0, int, "%d");
+	BC_ASSERT_EQUAL(count_friends_in_search_results(resultList, "sylvain"), 1, int, "%d");
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	linphone_magic_search_unref(magicSearch);
+	ms_free(stats);
+	linphone_friend_list_unref(lfl);
+	linphone_core_manager_destroy(manager);
+}
+
 static void find_friend_by_ref_key_test(void) {
 	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
 	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
@@ -1035,6 +1093,7 @@ test_t vcard_tests[] = {
 	TEST_NO_TAG("CardDAV integration", carddav_integration),
 	TEST_NO_TAG("CardDAV multiple synchronizations", carddav_multiple_sync),
 	TEST_NO_TAG("CardDAV client to server and server to client sync", carddav_server_to_client_and_client_to_sever_sync),
+	TEST_NO_TAG("CardDAV update in magic search", carddav_update_in_magic_search),
 	TEST_NO_TAG("Find friend by ref key", find_friend_by_ref_key_test),
 	TEST_NO_TAG("create a map and insert 20000 objects", insert_lot_of_friends_map_test),
 	TEST_NO_TAG("Find ref key in 20000 objects map", find_friend_by_ref_key_in_lot_of_friends_test),